@@ -0,0 +1,242 @@
+/** @file alloctracker.cpp
+ * Implementation of AllocTracker class and replacement of global operators new and delete
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <new>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include "alloctracker.h"
+/**********************************************************************************************/
+#ifndef NO_ALLOC_TRACKER
+/**
+ * @brief allocate is common part of all operators new
+ * @param size is size of block
+ * @return block, NULL if there isn't memory
+ */
+static void *allocate( size_t size ){
+    void *block = malloc( size == 0 ? 1 : size );
+    if ( block != NULL && AllocTracker::isOn() ){
+        AllocTracker::allocated( malloc_usable_size( block ) );
+    }
+    return block;
+}
+/*********************************************************/
+/**
+ * @brief release is common part of all operators delete
+ * @param block is block to free
+ */
+static void release( void *block ){
+    if ( block != NULL && AllocTracker::isOn() ){
+        AllocTracker::freed( malloc_usable_size( block ) );
+    }
+    free( block );
+}
+/*********************************************************/
+void *operator new( size_t size ){
+    void *block = allocate( size );
+    if ( block == NULL ){
+        throw bad_alloc();
+    }
+    return block;
+}
+/*********************************************************/
+void *operator new[]( size_t size ){
+    void *block = allocate( size );
+    if ( block == NULL ){
+        throw bad_alloc();
+    }
+    return block;
+}
+/*********************************************************/
+void *operator new( size_t size, const nothrow_t & ) noexcept{
+    return allocate( size );
+}
+/*********************************************************/
+void *operator new[]( size_t size, const nothrow_t & ) noexcept{
+    return allocate( size );
+}
+/*********************************************************/
+void operator delete( void *block ) noexcept{
+    release( block );
+}
+/*********************************************************/
+void operator delete[]( void *block ) noexcept{
+    release( block );
+}
+/*********************************************************/
+void operator delete( void *block, const nothrow_t & ) noexcept{
+    release( block );
+}
+/*********************************************************/
+void operator delete[]( void *block, const nothrow_t & ) noexcept{
+    release( block );
+}
+#endif // NO_ALLOC_TRACKER
+/**********************************************************************************************/
+atomic<bool> AllocTracker::on ( false );
+string AllocTracker::fileName;
+AllocTracker::ThreadStats *AllocTracker::threads[C_ALLOC_THREADS];
+atomic<int> AllocTracker::countThreads ( 0 );
+thread_local AllocTracker::ThreadStats *AllocTracker::own = NULL;
+/*********************************************************/
+void AllocTracker::start( const string &fileName ){
+    AllocTracker::fileName = fileName;
+    on.store( true, memory_order_relaxed );
+    atexit( write );
+}
+/*********************************************************/
+AllocTracker::ThreadStats *AllocTracker::stats(){
+    if ( own == NULL ){
+        int index = countThreads.fetch_add( 1 );
+        if ( index >= C_ALLOC_THREADS ){
+            return NULL;
+        }
+        // calloc, not new, otherwise tracker would count itself forever
+        own = (ThreadStats *)calloc( 1, sizeof(ThreadStats) );
+        threads[index] = own;
+    }
+    return own;
+}
+/*********************************************************/
+int AllocTracker::findTag( TagStats *tags, const char *name ){
+    if ( name == NULL ){
+        name = "(no scope)";
+    }
+    for ( int i = 0; i < C_ALLOC_TAGS - 1; ++i ){
+        if ( tags[i].name == NULL || tags[i].name == name || strcmp( tags[i].name, name ) == 0 ){
+            tags[i].name = name;
+            return i;
+        }
+    }
+    tags[C_ALLOC_TAGS - 1].name = "(more scopes)";
+    return C_ALLOC_TAGS - 1;
+}
+/*********************************************************/
+void AllocTracker::allocated( size_t bytes ){
+    ThreadStats *stats = AllocTracker::stats();
+    if ( stats == NULL ){
+        return;
+    }
+    stats->count++;
+    stats->bytes += bytes;
+    stats->live += bytes;
+    if ( !stats->inFrame ){
+        return;
+    }
+    TagStats &tag = stats->frame[ findTag( stats->frame, stats->tag ) ];
+    tag.count++;
+    tag.bytes += bytes;
+    stats->framePeak = max( stats->framePeak, stats->live - stats->frameStart );
+}
+/*********************************************************/
+void AllocTracker::freed( size_t bytes ){
+    ThreadStats *stats = AllocTracker::stats();
+    if ( stats != NULL ){
+        stats->live -= bytes;
+    }
+}
+/*********************************************************/
+const char *AllocTracker::setTag( const char *tag ){
+    ThreadStats *stats = AllocTracker::stats();
+    if ( stats == NULL ){
+        return NULL;
+    }
+    const char *previous = stats->tag;
+    stats->tag = tag;
+    return previous;
+}
+/*********************************************************/
+void AllocTracker::beginFrame(){
+    ThreadStats *stats = AllocTracker::stats();
+    if ( !isOn() || stats == NULL ){
+        return;
+    }
+    stats->inFrame = true;
+    stats->frameStart = stats->live;
+    stats->framePeak = 0;
+    memset( stats->frame, 0, sizeof(stats->frame) );
+}
+/*********************************************************/
+void AllocTracker::endFrame( int screen ){
+    ThreadStats *stats = AllocTracker::stats();
+    if ( !isOn() || stats == NULL || !stats->inFrame ){
+        return;
+    }
+    stats->inFrame = false;
+    ScreenStats &total = stats->screens[ screen >= 0 && screen < C_ALLOC_SCREENS ? screen : C_ALLOC_SCREENS - 1 ];
+    long long count = 0, bytes = 0;
+    for ( int i = 0; i < C_ALLOC_TAGS && stats->frame[i].name != NULL; ++i ){
+        const TagStats &tag = stats->frame[i];
+        TagStats &sum = total.tags[ findTag( total.tags, tag.name ) ];
+        sum.count += tag.count;
+        sum.bytes += tag.bytes;
+        count += tag.count;
+        bytes += tag.bytes;
+    }
+    total.frames++;
+    total.framesWithout += count == 0;
+    total.count += count;
+    total.bytes += bytes;
+    total.maxCount = max( total.maxCount, count );
+    total.maxPeak = max( total.maxPeak, stats->framePeak );
+}
+/*********************************************************/
+void AllocTracker::write(){
+    if ( !on.exchange( false ) ){
+        return;
+    }
+    FILE *file = fopen( fileName.c_str(), "w" );
+    if ( file == NULL ){
+        fprintf( stderr, "Allocations can't be written to %s.\n", fileName.c_str() );
+        return;
+    }
+    // order of ScreenDataType
+    static const char *screens[C_ALLOC_SCREENS] = { "menu", "message", "map", "create hero", "dialog", "", "", "other" };
+    int count = min( countThreads.load(), C_ALLOC_THREADS );
+    long long allCount = 0, allBytes = 0;
+    ScreenStats merged[C_ALLOC_SCREENS];
+    memset( merged, 0, sizeof(merged) );
+    for ( int t = 0; t < count; ++t ){
+        if ( threads[t] == NULL ){
+            continue;                           // thread is just creating its statistics
+        }
+        const ThreadStats &stats = *threads[t];
+        allCount += stats.count;
+        allBytes += stats.bytes;
+        for ( int s = 0; s < C_ALLOC_SCREENS; ++s ){
+            const ScreenStats &from = stats.screens[s];
+            ScreenStats &to = merged[s];
+            to.frames += from.frames;
+            to.framesWithout += from.framesWithout;
+            to.count += from.count;
+            to.bytes += from.bytes;
+            to.maxCount = max( to.maxCount, from.maxCount );
+            to.maxPeak = max( to.maxPeak, from.maxPeak );
+            for ( int i = 0; i < C_ALLOC_TAGS && from.tags[i].name != NULL; ++i ){
+                TagStats &tag = to.tags[ findTag( to.tags, from.tags[i].name ) ];
+                tag.count += from.tags[i].count;
+                tag.bytes += from.tags[i].bytes;
+            }
+        }
+    }
+    fprintf( file, "Allocations: %lld blocks, %lld bytes in %d threads.\n\n", allCount, allBytes, count );
+    fprintf( file, "%-12s %8s %8s %12s %12s %11s %11s\n", "screen", "frames", "zero", "allocs/frame", "bytes/frame", "max allocs", "max peak" );
+    for ( int s = 0; s < C_ALLOC_SCREENS; ++s ){
+        const ScreenStats &stats = merged[s];
+        if ( stats.frames == 0 ){
+            continue;
+        }
+        fprintf( file, "%-12s %8lld %8lld %12.1f %12.1f %11lld %11lld\n", screens[s], stats.frames, stats.framesWithout,
+                 (double)stats.count / stats.frames, (double)stats.bytes / stats.frames, stats.maxCount, stats.maxPeak );
+        for ( int i = 0; i < C_ALLOC_TAGS && stats.tags[i].name != NULL; ++i ){
+            fprintf( file, "    %-34s %12.1f %12.1f\n", stats.tags[i].name,
+                     (double)stats.tags[i].count / stats.frames, (double)stats.tags[i].bytes / stats.frames );
+        }
+    }
+    fclose( file );
+    fprintf( stderr, "Allocations: %lld blocks written to %s.\n", allCount, fileName.c_str() );
+}
@@ -0,0 +1,162 @@
+/** @file alloctracker.h
+ * Header file of AllocTracker class and AllocScope class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+#include <atomic>
+#include <string>
+#include <cstddef>
+using namespace std;
+#define C_ALLOC_TAGS        32              // max count of different scopes, the last one takes the rest
+#define C_ALLOC_SCREENS     8               // max count of screen types
+#define C_ALLOC_THREADS     64              // max count of threads with statistics
+/**
+ * ALLOC_SCOPE( "name" ) marks allocations until end of block by name (string literal), the
+ * innermost scope wins. With -DNO_ALLOC_TRACKER operators new and delete aren't replaced and
+ * scopes aren't compiled, otherwise tracker costs one test per allocation when it is off.
+ */
+#ifdef NO_ALLOC_TRACKER
+    #define ALLOC_SCOPE( name )
+#else
+    #define ALLOC_JOIN( a, b ) a##b
+    #define ALLOC_NAME( line ) ALLOC_JOIN( allocScope, line )
+    #define ALLOC_SCOPE( name ) AllocScope ALLOC_NAME( __LINE__ ) ( name )
+#endif
+/**********************************************************************************************/
+/**
+ * @brief The AllocTracker class
+ * @detailed    Counts allocations of global operator new. Frame is handling of one key with
+ *              drawing of screen, every frame adds its count, bytes and peak of live bytes to
+ *              statistics of its screen type, split by scopes. Every thread has its own
+ *              statistics (allocated by malloc, so tracker doesn't call itself), they are
+ *              merged into report at exit. Goal is zero allocations in frame of steady game.
+ */
+class AllocTracker{
+    public:
+        /**
+         * @brief start turns tracker on, report is written at exit of program
+         * @param fileName is name of text file for report
+         */
+        static void start( const string &fileName );
+        /**
+         * @brief isOn says if tracker counts allocations
+         * @return true if it is on
+         */
+        static bool isOn(){
+            return on.load( memory_order_relaxed );
+        }
+        /**
+         * @brief allocated counts allocation of currient thread
+         * @param bytes is size of block
+         */
+        static void allocated( size_t bytes );
+        /**
+         * @brief freed counts freeing of block
+         * @param bytes is size of block
+         */
+        static void freed( size_t bytes );
+        /**
+         * @brief beginFrame starts frame of currient thread
+         */
+        static void beginFrame();
+        /**
+         * @brief endFrame ends frame and adds it to statistics
+         * @param screen is type of screen shown by frame (ScreenDataType)
+         */
+        static void endFrame( int screen );
+        /**
+         * @brief setTag sets scope of next allocations of currient thread
+         * @param tag is name of scope, NULL for no scope
+         * @return previous scope
+         */
+        static const char *setTag( const char *tag );
+        /**
+         * @brief write writes report, it is called at exit
+         */
+        static void write();
+    private:
+        /**
+         * @brief The TagStats struct counts allocations of one scope
+         */
+        struct TagStats{
+            const char *name;
+            long long count;
+            long long bytes;
+        };
+        /**
+         * @brief The ScreenStats struct counts frames of one screen type
+         */
+        struct ScreenStats{
+            long long frames;
+            long long framesWithout;            // frames without any allocation
+            long long count;
+            long long bytes;
+            long long maxCount;
+            long long maxPeak;
+            TagStats tags[C_ALLOC_TAGS];
+        };
+        /**
+         * @brief The ThreadStats struct is everything of one thread
+         */
+        struct ThreadStats{
+            const char *tag;
+            bool inFrame;
+            long long count, bytes;             // whole run
+            long long live;                     // can be negative, block can be freed by other thread
+            long long frameStart;               // live bytes at begin of frame
+            long long framePeak;
+            TagStats frame[C_ALLOC_TAGS];
+            ScreenStats screens[C_ALLOC_SCREENS];
+        };
+        static atomic<bool> on;
+        static string fileName;
+        static ThreadStats *threads[C_ALLOC_THREADS];
+        static atomic<int> countThreads;
+        static thread_local ThreadStats *own;
+        /**
+         * @brief stats gives statistics of currient thread, creates them at first call
+         * @return statistics, NULL if there are too many threads
+         */
+        static ThreadStats *stats();
+        /**
+         * @brief findTag finds place of scope in table
+         * @param tags is table
+         * @param name is name of scope
+         * @return index
+         */
+        static int findTag( TagStats *tags, const char *name );
+};
+/**********************************************************************************************/
+/**
+ * @brief The AllocScope class
+ * @detailed    Marks allocations from its construction to its destruction, use ALLOC_SCOPE.
+ */
+class AllocScope{
+    public:
+        /**
+         * @brief AllocScope is constructor with parameters
+         * @param name is name of scope, string literal
+         */
+        AllocScope( const char *name ) : active( AllocTracker::isOn() ), previous(NULL){
+            if ( active ){
+                previous = AllocTracker::setTag( name );
+            }
+        }
+        /**
+         * @brief ~AllocScope is destruktor, previous scope is back
+         */
+        ~AllocScope(){
+            if ( active ){
+                AllocTracker::setTag( previous );
+            }
+        }
+    private:
+        bool active;
+        const char *previous;
+        AllocScope( const AllocScope & );
+        AllocScope &operator=( const AllocScope & );
+};
+/**********************************************************************************************/
+#endif // ALLOCTRACKER_H
@@ -0,0 +1,115 @@
+/** @file autosave.cpp
+ * Implementation of AutoSave class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "autosave.h"
+#include "profiler.h"
+/**********************************************************************************************/
+AutoSave::AutoSave( const string &fileName, long long rate ) : fileName(fileName), rate(rate), child(-1), pipeFd(-1), moves(0),
+                                                              stall(0), size(0), writeTime(0),
+                                                              countSaves(0), countSkipped(0), countFailed(0), failed(false) {}
+/*********************************************************/
+AutoSave::~AutoSave(){
+    if ( child > 0 ){
+        int status = 0;
+        while ( waitpid( child, &status, 0 ) < 0 && errno == EINTR ){}
+        finish( status );
+    }
+}
+/*********************************************************/
+void AutoSave::moved( Map &map ){
+    poll();
+    if ( ++moves >= C_AUTOSAVE_MOVES ){
+        moves = 0;
+        start( map );
+    }
+}
+/*********************************************************/
+bool AutoSave::start( Map &map ){
+    PROFILE_SCOPE( "AutoSave::start" );
+    poll();
+    if ( child > 0 ){
+        countSkipped++;
+        return false;
+    }
+    int fds[2];
+    if ( pipe( fds ) != 0 ){
+        countFailed++;
+        failed = true;
+        return false;
+    }
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if ( pid == 0 ){
+        // child has frozen copy of the game, it must not touch screen or run destructors
+        close( fds[0] );
+        Report report = { 0, 0 };
+        int code = 0;
+        try {
+            report.size = SaveGame::save( fileName, map, rate );
+            report.writeTime = chrono::duration_cast<chrono::microseconds>( chrono::steady_clock::now() - begin ).count();
+        } catch ( ... ){
+            code = 1;
+        }
+        if ( write( fds[1], &report, sizeof(report) ) != (ssize_t)sizeof(report) ){
+            code = 1;
+        }
+        _exit( code );
+    }
+    stall = chrono::duration_cast<chrono::microseconds>( chrono::steady_clock::now() - begin ).count();
+    close( fds[1] );
+    if ( pid < 0 ){
+        close( fds[0] );
+        countFailed++;
+        failed = true;
+        return false;
+    }
+    child = pid;
+    pipeFd = fds[0];
+    return true;
+}
+/*********************************************************/
+void AutoSave::poll(){
+    if ( child <= 0 ){
+        return;
+    }
+    int status = 0;
+    if ( waitpid( child, &status, WNOHANG ) == child ){
+        finish( status );
+    }
+}
+/*********************************************************/
+void AutoSave::finish( int status ){
+    Report report;
+    // child has already written the report and exited, so read doesn't wait
+    bool isOk = WIFEXITED( status ) && WEXITSTATUS( status ) == 0 &&
+                read( pipeFd, &report, sizeof(report) ) == (ssize_t)sizeof(report);
+    if ( isOk ){
+        size = report.size;
+        writeTime = report.writeTime;
+        countSaves++;
+    } else {
+        countFailed++;
+    }
+    failed = !isOk;
+    close( pipeFd );
+    pipeFd = -1;
+    child = -1;
+}
+/*********************************************************/
+void AutoSave::install(){
+    struct sigaction action;
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = onChild;
+    sigaction( SIGCHLD, &action, NULL );
+}
+/*********************************************************/
+void AutoSave::onChild( int sig ){}
@@ -0,0 +1,142 @@
+/** @file autosave.h
+ * Header file of AutoSave class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+#include <string>
+#include <sys/types.h>
+#include "savegame.h"
+using namespace std;
+#define C_AUTOSAVE_MOVES    50              // game is saved after so many moves of hero
+#define C_AUTOSAVE_RATE     (4 << 20)       // max count of bytes per second written by autosave
+/**********************************************************************************************/
+/**
+ * @brief The AutoSave class
+ * @detailed    Saves game in background every C_AUTOSAVE_MOVES moves. Snapshot is made by fork(),
+ *              so child process has its own copy-on-write copy of map and hero, which doesn't change
+ *              anymore. Child writes it by SaveGame with limited rate and sends size of file and time
+ *              of writing back through pipe. Game only pays for fork(), this time is measured as stall.
+ *              Only one snapshot is written at the same time, if the previous one isn't finished,
+ *              the new one is skipped.
+ */
+class AutoSave{
+    public:
+        /**
+         * @brief AutoSave is constructor with parameters
+         * @param fileName is name of file for snapshots
+         * @param rate is max count of bytes per second written by child, 0 means without limit
+         */
+        AutoSave( const string &fileName = C_AUTOSAVE_FILE, long long rate = C_AUTOSAVE_RATE );
+        /**
+         * @brief ~AutoSave is destruktor, it waits for writing snapshot
+         */
+        ~AutoSave();
+        /**
+         * @brief moved counts moves of hero and starts snapshot every C_AUTOSAVE_MOVES moves
+         * @param map is map to save
+         */
+        void moved( Map &map );
+        /**
+         * @brief start makes snapshot of map and starts to write it
+         * @param map is map to save
+         * @return false if previous snapshot is still being written
+         */
+        bool start( Map &map );
+        /**
+         * @brief poll checks if snapshot is written and collects its metrics, it never waits
+         */
+        void poll();
+        /**
+         * @brief isRunning says if snapshot is being written
+         * @return true if child process hasn't finished yet
+         */
+        bool isRunning() const{
+            return child > 0;
+        }
+        /**
+         * @brief isFailed says if the last snapshot couldn't be made or written
+         * @return true after failure
+         */
+        bool isFailed() const{
+            return failed;
+        }
+        /**
+         * @brief getStall is getter of time the game was stopped by last snapshot
+         * @return time in microseconds
+         */
+        long long getStall() const{
+            return stall;
+        }
+        /**
+         * @brief getSize is getter of size of last written snapshot
+         * @return size in bytes
+         */
+        long long getSize() const{
+            return size;
+        }
+        /**
+         * @brief getWriteTime is getter of time of writing last snapshot in background
+         * @return time in microseconds
+         */
+        long long getWriteTime() const{
+            return writeTime;
+        }
+        /**
+         * @brief getCountSaves is getter of count of written snapshots
+         * @return count of snapshots
+         */
+        int getCountSaves() const{
+            return countSaves;
+        }
+        /**
+         * @brief getCountSkipped is getter of count of snapshots skipped because of previous one
+         * @return count of skipped snapshots
+         */
+        int getCountSkipped() const{
+            return countSkipped;
+        }
+        /**
+         * @brief getCountFailed is getter of count of snapshots which couldn't be written
+         * @return count of failed snapshots
+         */
+        int getCountFailed() const{
+            return countFailed;
+        }
+        /**
+         * @brief install makes getch of game return when child finishes (SIGCHLD without restart),
+         *          so finished snapshot is noticed without key
+         */
+        static void install();
+    private:
+        /**
+         * @brief The Report struct is sent by child process when snapshot is written
+         */
+        struct Report{
+            long long size;
+            long long writeTime;
+        };
+        string fileName;
+        long long rate;
+        pid_t child;
+        int pipeFd;                             // read end of pipe from child
+        int moves;
+        long long stall, size, writeTime;
+        int countSaves, countSkipped, countFailed;
+        bool failed;
+        /**
+         * @brief onChild is handler of SIGCHLD, it only interrupts getch
+         * @param sig is number of signal
+         */
+        static void onChild( int sig );
+        /**
+         * @brief finish reads report of finished child and closes pipe
+         * @param status is exit status of child
+         */
+        void finish( int status );
+        AutoSave( const AutoSave & );
+        AutoSave &operator=( const AutoSave & );
+};
+/**********************************************************************************************/
+#endif // AUTOSAVE_H
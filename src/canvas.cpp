@@ -0,0 +1,122 @@
+/** @file canvas.cpp
+ * Implementation of Canvas class and TextCanvas class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <cstdio>
+#include <cstdarg>
+#include "canvas.h"
+/**********************************************************************************************/
+void Canvas::print( const char *format, ... ){
+    char text[C_CANVAS_LINE];
+    va_list args;
+    va_start( args, format );
+    vsnprintf( text, sizeof(text), format, args );
+    va_end( args );
+    write( text );
+}
+/**********************************************************************************************/
+TextCanvas::TextCanvas( int height, int width ) : height(height), width(width){
+    cells.resize( height * width );
+    clean();
+}
+/*********************************************************/
+void TextCanvas::write( const char *text ){
+    for ( ; *text != '\0'; ++text ){
+        if ( cursorY >= height ){
+            return;
+        }
+        if ( *text == '\n' ){
+            cursorY++;
+            cursorX = 0;
+            continue;
+        }
+        // like ncurses, long line continues on the next row
+        if ( cursorX >= width ){
+            cursorY++;
+            cursorX = 0;
+            if ( cursorY >= height ){
+                return;
+            }
+        }
+        Cell &cell = cells[ cursorX + cursorY * width ];
+        cell.ch = *text;
+        cell.pair = pair;
+        cell.bold = bold;
+        cursorX++;
+    }
+}
+/*********************************************************/
+void TextCanvas::moveTo( int y, int x ){
+    if ( y >= 0 && y < height && x >= 0 && x < width ){
+        cursorY = y;
+        cursorX = x;
+    }
+}
+/*********************************************************/
+void TextCanvas::attrOn( int attr ){
+    if ( attr & A_COLOR ){
+        pair = PAIR_NUMBER( attr );
+    }
+    if ( attr & A_BOLD ){
+        bold = 1;
+    }
+}
+/*********************************************************/
+void TextCanvas::attrOff( int attr ){
+    if ( attr & A_COLOR ){
+        pair = 0;
+    }
+    if ( attr & A_BOLD ){
+        bold = 0;
+    }
+}
+/*********************************************************/
+void TextCanvas::clean(){
+    Cell empty = { ' ', 0, 0 };
+    for ( int i = 0; i < (int)cells.size(); ++i ){
+        cells[i] = empty;
+    }
+    cursorY = cursorX = 0;
+    pair = bold = 0;
+}
+/*********************************************************/
+bool TextCanvas::isRowEqual( const TextCanvas &other, int y ) const{
+    for ( int x = y * width; x < ( y + 1 ) * width; ++x ){
+        const Cell &a = cells[x];
+        const Cell &b = other.cells[x];
+        if ( a.ch != b.ch || a.pair != b.pair || a.bold != b.bold ){
+            return false;
+        }
+    }
+    return true;
+}
+/*********************************************************/
+string TextCanvas::getRowText( int y ) const{
+    string text;
+    for ( int x = 0; x < width; ++x ){
+        text += cells[ x + y * width ].ch;
+    }
+    return text.substr( 0, text.find_last_not_of(' ') + 1 );
+}
+/*********************************************************/
+void TextCanvas::appendRowAnsi( int y, string &out ) const{
+    // the same colors as ScreenController sets to ncurses pairs
+    static const char *colors[] = { "", ";36;40", ";30;46", ";37;40", ";31;40", ";33;40" };
+    char buffer[32];
+    snprintf( buffer, sizeof(buffer), "\x1b[%d;1H", y + 1 );
+    out += buffer;
+    int last = -1;
+    for ( int x = 0; x < width; ++x ){
+        const Cell &cell = cells[ x + y * width ];
+        int style = cell.pair * 2 + cell.bold;
+        if ( style != last ){
+            out += "\x1b[0";
+            out += ( cell.pair < sizeof(colors) / sizeof(colors[0]) ) ? colors[ cell.pair ] : "";
+            out += cell.bold ? ";1m" : "m";
+            last = style;
+        }
+        out += cell.ch;
+    }
+    out += "\x1b[0m";
+}
@@ -0,0 +1,172 @@
+/** @file canvas.h
+ * Header file of Canvas class and TextCanvas class.
+ * Header and implementation of CursesCanvas class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef CANVAS_H
+#define CANVAS_H
+#include <string>
+#include <vector>
+#include <ncurses.h>
+using namespace std;
+#define C_CANVAS_LINE 1024                  // max length of one formatted text
+/**********************************************************************************************/
+/**
+ * @brief The Canvas class
+ * @detailed    The Parent abstruct class of surfaces where pages are drawn. It has the same
+ *              operations as ncurses uses (print, move, attributes), so pages don't know
+ *              if they draw on terminal or into memory.
+ */
+class Canvas{
+    public:
+        /**
+         * @brief ~Canvas is virtual destruktor
+         */
+        virtual ~Canvas(){}
+        /**
+         * @brief print writes formatted text at cursor, like printw
+         * @param format is format of text (printf)
+         */
+        void print( const char *format, ... );
+        /**
+         * @brief write writes text at cursor
+         * @param text is text to write
+         */
+        virtual void write( const char *text ) = 0;
+        /**
+         * @brief moveTo moves cursor
+         * @param y is row
+         * @param x is column
+         */
+        virtual void moveTo( int y, int x ) = 0;
+        /**
+         * @brief attrOn turns attribute on, like attron (color pair replaces the old one)
+         * @param attr is attribute (COLOR_PAIR(n), A_BOLD)
+         */
+        virtual void attrOn( int attr ) = 0;
+        /**
+         * @brief attrOff turns attribute off, like attroff
+         * @param attr is attribute (COLOR_PAIR(n), A_BOLD)
+         */
+        virtual void attrOff( int attr ) = 0;
+        /**
+         * @brief clean cleans whole canvas and moves cursor to beginning
+         */
+        virtual void clean() = 0;
+};
+/**********************************************************************************************/
+/**
+ * @brief The CursesCanvas class
+ * @detailed Descendant class of Canvas, draws on terminal by ncurses
+ */
+class CursesCanvas : public Canvas{
+    public:
+        void write( const char *text ){
+            printw( "%s", text );
+        }
+        void moveTo( int y, int x ){
+            move( y, x );
+        }
+        void attrOn( int attr ){
+            attron( attr );
+        }
+        void attrOff( int attr ){
+            attroff( attr );
+        }
+        void clean(){
+            clear();
+        }
+};
+/**********************************************************************************************/
+/**
+ * @brief The TextCanvas class
+ * @detailed    Descendant class of Canvas, draws into memory. Every place keeps its character,
+ *              color pair and boldness, text out of canvas is cut off. Rows can be compared with
+ *              another canvas and sent to terminal as ANSI escape sequences.
+ */
+class TextCanvas : public Canvas{
+    public:
+        /**
+         * @brief TextCanvas is constructor with parameters
+         * @param height is count of rows
+         * @param width is count of columns
+         */
+        TextCanvas( int height, int width );
+        void write( const char *text );
+        void moveTo( int y, int x );
+        void attrOn( int attr );
+        void attrOff( int attr );
+        void clean();
+        /**
+         * @brief getHeight is getter for count of rows
+         * @return count of rows
+         */
+        int getHeight() const{
+            return height;
+        }
+        /**
+         * @brief getWidth is getter for count of columns
+         * @return count of columns
+         */
+        int getWidth() const{
+            return width;
+        }
+        /**
+         * @brief getCell is getter for one place of canvas
+         * @param y is row
+         * @param x is column
+         * @return character in low byte, color pair and boldness (bit 7) in high byte
+         */
+        unsigned getCell( int y, int x ) const{
+            const Cell &cell = cells[ x + y * width ];
+            return (unsigned char)cell.ch | ( ( cell.pair | cell.bold << 7 ) << 8 );
+        }
+        /**
+         * @brief setCell is setter for one place of canvas
+         * @param y is row
+         * @param x is column
+         * @param value is value in format of getCell
+         */
+        void setCell( int y, int x, unsigned value ){
+            Cell &cell = cells[ x + y * width ];
+            cell.ch = (char)( value & 0xff );
+            cell.pair = ( value >> 8 ) & 0x7f;
+            cell.bold = ( value >> 15 ) & 1;
+        }
+        /**
+         * @brief isRowEqual compares one row of two canvases
+         * @param other is canvas of the same size
+         * @param y is row
+         * @return true if row looks the same
+         */
+        bool isRowEqual( const TextCanvas &other, int y ) const;
+        /**
+         * @brief getRowText is getter for characters of row without trailing spaces
+         * @param y is row
+         * @return text of row
+         */
+        string getRowText( int y ) const;
+        /**
+         * @brief appendRowAnsi appends escape sequences, which draw the row on terminal
+         * @param y is row
+         * @param out is output
+         */
+        void appendRowAnsi( int y, string &out ) const;
+    private:
+        /**
+         * @brief The Cell struct is one place of canvas
+         */
+        struct Cell{
+            char ch;
+            unsigned char pair;                 // color pair, 0 is default color of terminal
+            unsigned char bold;
+        };
+        int height, width;
+        vector<Cell> cells;
+        int cursorY, cursorX;
+        unsigned char pair;
+        unsigned char bold;
+};
+/**********************************************************************************************/
+#endif // CANVAS_H
@@ -0,0 +1,475 @@
+/** @file chunkstore.cpp
+ * Implementation of ChunkStore class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include "chunkstore.h"
+#include "map.h"
+#include "profiler.h"
+/**********************************************************************************************/
+/**
+ * @brief mix scrambles bits of value (splitmix64), close coordinates give unrelated seeds
+ * @param value is value
+ * @return scrambled value
+ */
+static uint64_t mix( uint64_t value ){
+    value += 0x9E3779B97F4A7C15ULL;
+    value = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    value = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EBULL;
+    return value ^ ( value >> 31 );
+}
+/**
+ * @brief lessName compares item types by name
+ * @param a is id of item type
+ * @param b is id of item type
+ * @return true if name of a is before name of b
+ */
+static bool lessName( int a, int b ){
+    return ItemRegistry::get().getType( a ).name < ItemRegistry::get().getType( b ).name;
+}
+/*********************************************************/
+/**
+ * @brief sortItems makes ids of item types sorted by their names
+ * @return ids
+ */
+static vector<int> sortItems(){
+    vector<int> items;
+    for ( int i = 0; i < ItemRegistry::get().getCount(); ++i ){
+        items.push_back( i );
+    }
+    sort( items.begin(), items.end(), lessName );
+    return items;
+}
+/*********************************************************/
+/**
+ * @brief itemsByName is getter of ids of item types sorted by their names, they are sorted once
+ * @detailed    Generated item is drawn from this order, so world of seed doesn't change when
+ *              items file is only reordered.
+ * @return ids
+ */
+static const vector<int> &itemsByName(){
+    static const vector<int> items = sortItems();
+    return items;
+}
+/**********************************************************************************************/
+bool Chunk::operator == ( const Chunk &other ) const{
+    if ( cells != other.cells || enemies.size() != other.enemies.size() || items.size() != other.items.size() ){
+        return false;
+    }
+    for ( int i = 0; i < (int)items.size(); ++i ){
+        if ( items[i].index != other.items[i].index || items[i].item != other.items[i].item ){
+            return false;
+        }
+    }
+    for ( int i = 0; i < (int)enemies.size(); ++i ){
+        const ChunkEnemy &a = enemies[i];
+        const ChunkEnemy &b = other.enemies[i];
+        if ( a.index != b.index || a.stats.health != b.stats.health ||
+             a.stats.damage != b.stats.damage || a.stats.defence != b.stats.defence ){
+            return false;
+        }
+    }
+    return true;
+}
+/**********************************************************************************************/
+ChunkStore::ChunkStore( uint64_t seed, const string &directory ) : seed(seed), directory(directory), stopping(false),
+                                                                   countGenerated(0), countWaits(0), countLost(0){
+    ItemRegistry::get();                        // error of items file comes here, not in worker
+    mkdir( directory.c_str(), 0755 );
+    for ( int i = 0; i < C_CHUNK_WORKERS; ++i ){
+        workers.push_back( thread( &ChunkStore::run, this ) );
+    }
+}
+/*********************************************************/
+ChunkStore::~ChunkStore(){
+    {
+        lock_guard<mutex> guard ( lock );
+        stopping = true;
+    }
+    work.notify_all();
+    for ( int i = 0; i < (int)workers.size(); ++i ){
+        workers[i].join();
+    }
+    flush();
+}
+/*********************************************************/
+shared_ptr<const Chunk> ChunkStore::get( int x, int y ){
+    int64_t k = key( x, y );
+    vector<Victim> victims;
+    unique_lock<mutex> guard ( lock );
+    if ( pending.count( k ) > 0 ){
+        countWaits++;
+        // chunk is in queue or worker makes it, queued one is taken away and made here
+        for ( int i = 0; i < (int)queue.size(); ++i ){
+            if ( queue[i] == k ){
+                queue.erase( queue.begin() + i );
+                pending.erase( k );
+                break;
+            }
+        }
+        while ( pending.count( k ) > 0 ){
+            ready.wait( guard );
+        }
+    }
+    unordered_map<int64_t, Entry>::iterator found = cache.find( k );
+    if ( found != cache.end() ){
+        ages.splice( ages.begin(), ages, found->second.age );
+        return found->second.chunk;
+    }
+    shared_ptr<const Chunk> chunk = takeDirty( k, victims );
+    if ( !chunk ){
+        guard.unlock();
+        chunk = make( k );
+        guard.lock();
+        found = cache.find( k );
+        if ( found != cache.end() ){
+            return found->second.chunk;
+        }
+        shared_ptr<const Chunk> evicted = takeDirty( k, victims );
+        if ( evicted ){
+            chunk = evicted;
+        } else {
+            insert( k, chunk, false, victims );
+        }
+    }
+    guard.unlock();
+    store( victims );
+    return chunk;
+}
+/*********************************************************/
+void ChunkStore::put( int x, int y, shared_ptr<const Chunk> chunk ){
+    // chunk of window isn't prefetched, so no worker makes it now
+    int64_t k = key( x, y );
+    vector<Victim> victims;
+    {
+        lock_guard<mutex> guard ( lock );
+        dirty.erase( k );                       // older content isn't written anymore
+        unordered_map<int64_t, Entry>::iterator found = cache.find( k );
+        if ( found != cache.end() ){
+            found->second.chunk = chunk;
+            found->second.modified = true;
+            ages.splice( ages.begin(), ages, found->second.age );
+            return;
+        }
+        insert( k, chunk, true, victims );
+    }
+    store( victims );
+}
+/*********************************************************/
+void ChunkStore::prefetch( int x, int y ){
+    int64_t k = key( x, y );
+    {
+        lock_guard<mutex> guard ( lock );
+        if ( cache.count( k ) > 0 || pending.count( k ) > 0 || dirty.count( k ) > 0 ){
+            return;
+        }
+        if ( (int)queue.size() >= C_CHUNK_CACHE / 2 ){
+            // hero ran away from the oldest wishes
+            pending.erase( queue.front() );
+            queue.pop_front();
+        }
+        queue.push_back( k );
+        pending.insert( k );
+    }
+    work.notify_one();
+}
+/*********************************************************/
+bool ChunkStore::flush(){
+    PROFILE_SCOPE( "ChunkStore::flush" );
+    vector<Victim> victims;
+    {
+        lock_guard<mutex> guard ( lock );
+        for ( unordered_map<int64_t, Entry>::iterator it = cache.begin(); it != cache.end(); ++it ){
+            if ( it->second.modified ){
+                it->second.modified = false;
+                dirty[ it->first ] = it->second.chunk;
+                victims.push_back( Victim( it->first, it->second.chunk ) );
+            }
+        }
+    }
+    store( victims );
+    lock_guard<mutex> guard ( lock );
+    return countLost == 0;
+}
+/*********************************************************/
+int ChunkStore::getCountCached(){
+    lock_guard<mutex> guard ( lock );
+    return cache.size();
+}
+/*********************************************************/
+int ChunkStore::getCountGenerated(){
+    lock_guard<mutex> guard ( lock );
+    return countGenerated;
+}
+/*********************************************************/
+int ChunkStore::getCountWaits(){
+    lock_guard<mutex> guard ( lock );
+    return countWaits;
+}
+/*********************************************************/
+int ChunkStore::getCountLost(){
+    lock_guard<mutex> guard ( lock );
+    return countLost;
+}
+/*********************************************************/
+void ChunkStore::generate( uint64_t seed, int x, int y, Chunk &chunk ){
+    Random random ( mix( seed ^ mix( (uint64_t)(uint32_t)x << 32 | (uint32_t)y ) ) );
+    // terrain of chunk: density of barriers and thorns
+    static const int barriers[] = { 2, 6, 9, 3 };       // from 10 odd places
+    static const int thorns[] = { 1, 1, 0, 6 };         // from 100 other places
+    int terrain = random.next( 4 );
+    chunk.cells.assign( C_CHUNK_SIZE * C_CHUNK_SIZE, EMPTY );
+    chunk.enemies.clear();
+    chunk.items.clear();
+    const vector<int> &types = itemsByName();
+    int countTypes = types.size();
+    for ( int row = 0; row < C_CHUNK_SIZE; ++row ){
+        for ( int col = 0; col < C_CHUNK_SIZE; ++col ){
+            int index = col + row * C_CHUNK_SIZE;
+            if ( x == 0 && y == 0 && index == 0 ){
+                continue;
+            }
+            // chunk begins on even coordinate of world, so odd place of chunk is odd in world
+            if ( row % 2 == 1 && col % 2 == 1 ){
+                if ( random.next( 10 ) < barriers[terrain] ){
+                    chunk.cells[index] = BARRIER;
+                }
+                continue;
+            }
+            int roll = random.next( 100 );
+            if ( roll < thorns[terrain] ){
+                chunk.cells[index] = THORN;
+            } else if ( roll == 99 && countTypes > 0 ){
+                ChunkItem item = { index, types[ random.next( countTypes ) ] };
+                chunk.cells[index] = ITEM;
+                chunk.items.push_back( item );
+            } else if ( roll >= 97 ){
+                ChunkEnemy enemy = { index, { 10 + random.next( 40 ), 10 + random.next( 40 ), 10 + random.next( 40 ) } };
+                chunk.cells[index] = ENEMY;
+                chunk.enemies.push_back( enemy );
+            }
+        }
+    }
+}
+/*********************************************************/
+int64_t ChunkStore::key( int x, int y ){
+    return (int64_t)( (uint64_t)(uint32_t)x << 32 | (uint32_t)y );
+}
+/*********************************************************/
+shared_ptr<const Chunk> ChunkStore::make( int64_t k ){
+    shared_ptr<Chunk> chunk ( new Chunk );
+    if ( !read( k, *chunk ) ){
+        generate( seed, (int32_t)( (uint64_t)k >> 32 ), (int32_t)(uint32_t)k, *chunk );
+        lock_guard<mutex> guard ( lock );
+        countGenerated++;
+    }
+    return chunk;
+}
+/*********************************************************/
+void ChunkStore::insert( int64_t k, shared_ptr<const Chunk> chunk, bool modified, vector<Victim> &victims ){
+    ages.push_front( k );
+    Entry entry = { chunk, modified, ages.begin() };
+    cache[k] = entry;
+    while ( (int)cache.size() > C_CHUNK_CACHE ){
+        int64_t oldest = ages.back();
+        unordered_map<int64_t, Entry>::iterator found = cache.find( oldest );
+        if ( found->second.modified ){
+            // it is written by caller after unlock, until then get finds it in dirty
+            dirty[oldest] = found->second.chunk;
+            victims.push_back( Victim( oldest, found->second.chunk ) );
+        }
+        cache.erase( found );
+        ages.pop_back();
+    }
+}
+/*********************************************************/
+shared_ptr<const Chunk> ChunkStore::takeDirty( int64_t k, vector<Victim> &victims ){
+    unordered_map<int64_t, shared_ptr<const Chunk> >::iterator found = dirty.find( k );
+    if ( found == dirty.end() ){
+        return shared_ptr<const Chunk>();
+    }
+    shared_ptr<const Chunk> chunk = found->second;
+    dirty.erase( found );
+    insert( k, chunk, true, victims );
+    return chunk;
+}
+/*********************************************************/
+void ChunkStore::store( const vector<Victim> &victims ){
+    if ( victims.empty() ){
+        return;
+    }
+    // one writer at a time, so older content of chunk never overwrites newer one
+    lock_guard<mutex> serial ( writeLock );
+    for ( int i = 0; i < (int)victims.size(); ++i ){
+        int64_t k = victims[i].first;
+        {
+            lock_guard<mutex> guard ( lock );
+            unordered_map<int64_t, shared_ptr<const Chunk> >::iterator found = dirty.find( k );
+            if ( found == dirty.end() || found->second != victims[i].second ){
+                continue;                       // it came back into cache or it was replaced
+            }
+        }
+        bool isWritten = write( k, *victims[i].second );
+        lock_guard<mutex> guard ( lock );
+        unordered_map<int64_t, shared_ptr<const Chunk> >::iterator found = dirty.find( k );
+        if ( found != dirty.end() && found->second == victims[i].second ){
+            dirty.erase( found );
+            if ( !isWritten ){
+                countLost++;                    // cache stays bounded, flush reports it
+            }
+        }
+    }
+}
+/*********************************************************/
+string ChunkStore::fileOf( int64_t k ) const{
+    stringstream name;
+    name << directory << "/" << seed << "_" << (int32_t)( (uint64_t)k >> 32 ) << "_" << (int32_t)(uint32_t)k << ".chunk";
+    return name.str();
+}
+/*********************************************************/
+bool ChunkStore::write( int64_t k, const Chunk &chunk ) const{
+    string fileName = fileOf( k );
+    string temporary = fileName + ".tmp";
+    {
+        ofstream out ( temporary.c_str(), ios::binary );
+        int32_t count = chunk.enemies.size();
+        out.write( (const char *)chunk.cells.data(), chunk.cells.size() );
+        out.write( (const char *)&count, sizeof(count) );
+        for ( int i = 0; i < count; ++i ){
+            const ChunkEnemy &enemy = chunk.enemies[i];
+            int32_t record[4] = { enemy.index, enemy.stats.health, enemy.stats.damage, enemy.stats.defence };
+            out.write( (const char *)record, sizeof(record) );
+        }
+        // names of item types, then places of items with numbers of names, ids change with items file
+        vector<int> names;
+        vector<int32_t> records;
+        map<int, int> numbers;
+        for ( int i = 0; i < (int)chunk.items.size(); ++i ){
+            int item = chunk.items[i].item;
+            if ( numbers.insert( make_pair( item, (int)names.size() ) ).second ){
+                names.push_back( item );
+            }
+            records.push_back( chunk.items[i].index );
+            records.push_back( numbers[item] );
+        }
+        count = names.size();
+        out.write( (const char *)&count, sizeof(count) );
+        for ( int i = 0; i < count; ++i ){
+            const string &name = ItemRegistry::get().getType( names[i] ).name;
+            int32_t length = name.size();
+            out.write( (const char *)&length, sizeof(length) );
+            out.write( name.data(), name.size() );
+        }
+        count = chunk.items.size();
+        out.write( (const char *)&count, sizeof(count) );
+        out.write( (const char *)records.data(), records.size() * sizeof(int32_t) );
+        if ( !out ){
+            return false;
+        }
+    }
+    return rename( temporary.c_str(), fileName.c_str() ) == 0;
+}
+/*********************************************************/
+bool ChunkStore::read( int64_t k, Chunk &chunk ) const{
+    ifstream in ( fileOf( k ).c_str(), ios::binary );
+    if ( !in ){
+        return false;
+    }
+    chunk.cells.resize( C_CHUNK_SIZE * C_CHUNK_SIZE );
+    int32_t count = 0;
+    in.read( (char *)chunk.cells.data(), chunk.cells.size() );
+    in.read( (char *)&count, sizeof(count) );
+    if ( !in || count < 0 || count > C_CHUNK_SIZE * C_CHUNK_SIZE ){
+        return false;
+    }
+    int countEnemyCells = 0, countItemCells = 0;
+    for ( int i = 0; i < (int)chunk.cells.size(); ++i ){
+        if ( chunk.cells[i] > EMPTY || chunk.cells[i] == HERO ){
+            return false;
+        }
+        countEnemyCells += ( chunk.cells[i] == ENEMY );
+        countItemCells += ( chunk.cells[i] == ITEM );
+    }
+    if ( count != countEnemyCells ){
+        return false;
+    }
+    chunk.enemies.resize( count );
+    for ( int i = 0; i < count; ++i ){
+        int32_t record[4];
+        in.read( (char *)record, sizeof(record) );
+        if ( !in || record[0] < 0 || record[0] >= (int)chunk.cells.size() || chunk.cells[ record[0] ] != ENEMY ){
+            return false;
+        }
+        ChunkEnemy enemy = { record[0], { record[1], record[2], record[3] } };
+        chunk.enemies[i] = enemy;
+    }
+    in.read( (char *)&count, sizeof(count) );
+    if ( !in || count < 0 || count > countItemCells ){
+        return false;
+    }
+    vector<int> names;
+    for ( int i = 0; i < count; ++i ){
+        int32_t length = 0;
+        in.read( (char *)&length, sizeof(length) );
+        if ( !in || length <= 0 || length > C_CHUNK_NAME ){
+            return false;
+        }
+        string name ( length, ' ' );
+        in.read( &name[0], length );
+        int item = ItemRegistry::get().find( name );
+        if ( !in || item < 0 ){
+            return false;                       // item isn't in items file anymore
+        }
+        names.push_back( item );
+    }
+    in.read( (char *)&count, sizeof(count) );
+    if ( !in || count != countItemCells ){
+        return false;
+    }
+    chunk.items.resize( count );
+    for ( int i = 0; i < count; ++i ){
+        int32_t record[2];
+        in.read( (char *)record, sizeof(record) );
+        if ( !in || record[0] < 0 || record[0] >= (int)chunk.cells.size() || chunk.cells[ record[0] ] != ITEM ||
+             record[1] < 0 || record[1] >= (int)names.size() ){
+            return false;
+        }
+        ChunkItem item = { record[0], names[ record[1] ] };
+        chunk.items[i] = item;
+    }
+    return true;
+}
+/*********************************************************/
+void ChunkStore::run(){
+    unique_lock<mutex> guard ( lock );
+    while ( true ){
+        while ( !stopping && queue.empty() ){
+            work.wait( guard );
+        }
+        if ( stopping ){
+            return;
+        }
+        int64_t k = queue.front();
+        queue.pop_front();
+        guard.unlock();
+        shared_ptr<const Chunk> chunk = make( k );
+        vector<Victim> victims;
+        guard.lock();
+        if ( cache.count( k ) == 0 && dirty.count( k ) == 0 ){
+            insert( k, chunk, false, victims );
+        }
+        pending.erase( k );
+        ready.notify_all();
+        if ( !victims.empty() ){
+            guard.unlock();
+            store( victims );
+            guard.lock();
+        }
+    }
+}
@@ -0,0 +1,224 @@
+/** @file chunkstore.h
+ * Header file of ChunkStore class.
+ * Header of Chunk struct.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef CHUNKSTORE_H
+#define CHUNKSTORE_H
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "world.h"
+using namespace std;
+#define C_CHUNK_SIZE        32              // chunk has C_CHUNK_SIZE x C_CHUNK_SIZE places, it has to be multiple of C_CLUSTER_SIZE
+#define C_CHUNK_CACHE       64              // max count of chunks in memory
+#define C_CHUNK_WORKERS     2               // threads which generate chunks ahead of hero
+#define C_WORLD_DIR         "world"         // directory of modified chunks
+#define C_CHUNK_NAME        256             // max length of name of item type in chunk file
+/**
+ * @brief The ChunkEnemy struct is enemy of chunk
+ */
+struct ChunkEnemy{
+    int32_t index;                          // index of place inside of chunk
+    Stats stats;
+};
+/**
+ * @brief The ChunkItem struct is item of chunk
+ */
+struct ChunkItem{
+    int32_t index;                          // index of place inside of chunk
+    int32_t item;                           // id of item type in ItemRegistry, file keeps its name
+};
+/**
+ * @brief The Chunk struct is square part of procedural world
+ * @detailed    Cells are typeMapObj of places (without hero), every ENEMY cell has one record
+ *              in enemies and every ITEM cell has one record in items.
+ */
+struct Chunk{
+    vector<unsigned char> cells;
+    vector<ChunkEnemy> enemies;
+    vector<ChunkItem> items;
+    /**
+     * @brief operator == compares content of chunks
+     * @param other is compared chunk
+     * @return true if chunks are the same
+     */
+    bool operator == ( const Chunk &other ) const;
+};
+/**********************************************************************************************/
+/**
+ * @brief The ChunkStore class keeps chunks of one procedural world
+ * @detailed    Chunk is generated only from seed and its coordinates, so the same world comes
+ *              out every time and unchanged chunk can be thrown away. At most C_CHUNK_CACHE chunks
+ *              are in memory, the least recently used one goes first. Modified chunk (put) is
+ *              written into C_WORLD_DIR when it goes out of cache (after lock is released, so files
+ *              don't stall other threads), it is read from there instead of generating next time, so
+ *              memory doesn't grow with size of explored world. Chunk which can't be written is lost
+ *              and counted, cache never grows over C_CHUNK_CACHE.
+ *              prefetch queues chunk for worker threads, get takes it from cache, waits for worker
+ *              or makes it itself.
+ */
+class ChunkStore{
+    public:
+        /**
+         * @brief ChunkStore is constructor with parameters, worker threads start
+         * @param seed is seed of world
+         * @param directory is directory of modified chunks, it is created if it doesn't exist
+         */
+        ChunkStore( uint64_t seed, const string &directory = C_WORLD_DIR );
+        /**
+         * @brief ~ChunkStore is destruktor, workers stop and modified chunks are written
+         */
+        ~ChunkStore();
+        /**
+         * @brief get is getter of chunk
+         * @param x is column of chunk (any int)
+         * @param y is row of chunk
+         * @return chunk, it doesn't change anymore
+         */
+        shared_ptr<const Chunk> get( int x, int y );
+        /**
+         * @brief put replaces chunk by modified one, it is written later
+         * @param x is column of chunk
+         * @param y is row of chunk
+         * @param chunk is new content
+         */
+        void put( int x, int y, shared_ptr<const Chunk> chunk );
+        /**
+         * @brief prefetch asks workers to have chunk ready, it doesn't wait
+         * @param x is column of chunk
+         * @param y is row of chunk
+         */
+        void prefetch( int x, int y );
+        /**
+         * @brief flush writes all modified chunks
+         * @return false if some chunk couldn't be written, now or when it went out of cache
+         */
+        bool flush();
+        /**
+         * @brief generate makes chunk from seed and its coordinates
+         * @detailed    Barriers are only on places with both coordinates odd, so all other places
+         *              are connected in the whole world. Enemies have characteristics > 0 as Map
+         *              requires, place (0,0) of world stays free for hero. Items are drawn from
+         *              types sorted by name, so order of items file doesn't change world.
+         * @param seed is seed of world
+         * @param x is column of chunk
+         * @param y is row of chunk
+         * @param chunk is output
+         */
+        static void generate( uint64_t seed, int x, int y, Chunk &chunk );
+        /**
+         * @brief getCountCached is getter of count of chunks in memory
+         * @return count
+         */
+        int getCountCached();
+        /**
+         * @brief getCountGenerated is getter of count of generated chunks
+         * @return count
+         */
+        int getCountGenerated();
+        /**
+         * @brief getCountWaits is getter of count of gets, which had to wait for chunk
+         * @return count
+         */
+        int getCountWaits();
+        /**
+         * @brief getCountLost is getter of count of modified chunks, which couldn't be written
+         * @return count
+         */
+        int getCountLost();
+    private:
+        /**
+         * @brief The Entry struct is chunk in cache
+         */
+        struct Entry{
+            shared_ptr<const Chunk> chunk;
+            bool modified;                      // it isn't written yet
+            list<int64_t>::iterator age;
+        };
+        typedef pair<int64_t, shared_ptr<const Chunk> > Victim;  // modified chunk thrown out of cache
+        uint64_t seed;
+        string directory;
+        mutex lock;
+        condition_variable work;                // key came into queue
+        condition_variable ready;               // chunk came into cache
+        unordered_map<int64_t, Entry> cache;
+        list<int64_t> ages;                     // keys of cache, recently used at front
+        deque<int64_t> queue;                   // keys waiting for worker
+        unordered_set<int64_t> pending;         // keys in queue or just made
+        unordered_map<int64_t, shared_ptr<const Chunk> > dirty;    // thrown out of cache, not written yet
+        mutex writeLock;                        // files are written by one thread at a time, without lock
+        vector<thread> workers;
+        bool stopping;
+        int countGenerated, countWaits, countLost;
+        /**
+         * @brief key packs coordinates of chunk
+         * @param x is column of chunk
+         * @param y is row of chunk
+         * @return key
+         */
+        static int64_t key( int x, int y );
+        /**
+         * @brief make reads chunk of key from directory or generates it, without lock
+         * @param k is key of chunk
+         * @return chunk
+         */
+        shared_ptr<const Chunk> make( int64_t k );
+        /**
+         * @brief insert puts chunk into cache and throws out the oldest ones over C_CHUNK_CACHE, with lock
+         * @param k is key of chunk
+         * @param chunk is chunk
+         * @param modified is true if chunk has to be written
+         * @param victims is output, modified chunks thrown out, caller stores them after unlock
+         */
+        void insert( int64_t k, shared_ptr<const Chunk> chunk, bool modified, vector<Victim> &victims );
+        /**
+         * @brief takeDirty puts chunk, which waits for writing, back into cache, with lock
+         * @param k is key of chunk
+         * @param victims is output of insert
+         * @return chunk or null if it doesn't wait
+         */
+        shared_ptr<const Chunk> takeDirty( int64_t k, vector<Victim> &victims );
+        /**
+         * @brief store writes thrown out chunks, which are still in dirty, without lock
+         * @param victims are chunks from insert
+         */
+        void store( const vector<Victim> &victims );
+        /**
+         * @brief fileOf is getter of name of file of chunk
+         * @param k is key of chunk
+         * @return path
+         */
+        string fileOf( int64_t k ) const;
+        /**
+         * @brief write writes chunk into its file, through temporary file, so reader never sees half of it
+         * @param k is key of chunk
+         * @param chunk is chunk
+         * @return false on error
+         */
+        bool write( int64_t k, const Chunk &chunk ) const;
+        /**
+         * @brief read reads chunk from its file
+         * @param k is key of chunk
+         * @param chunk is output
+         * @return false if file doesn't exist, it is damaged or its item isn't in items file anymore
+         */
+        bool read( int64_t k, Chunk &chunk ) const;
+        /**
+         * @brief run is loop of worker thread
+         */
+        void run();
+        ChunkStore( const ChunkStore & );
+        ChunkStore &operator=( const ChunkStore & );
+};
+/**********************************************************************************************/
+#endif // CHUNKSTORE_H
@@ -0,0 +1,166 @@
+/** @file chunkworld.cpp
+ * Implementation of ChunkWorld class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include "chunkworld.h"
+#include "savegame.h"
+#include "profiler.h"
+/**********************************************************************************************/
+ChunkWorld::ChunkWorld( uint64_t seed, const string &directory ) : chunks(seed, directory), originX(0), originY(0),
+                                                                   lastX(0), lastY(0){
+    window.resize( C_WORLD_CHUNKS * C_WORLD_CHUNKS );
+}
+/*********************************************************/
+shared_ptr<Map> ChunkWorld::create( shared_ptr<Hero> hero ){
+    lastX = lastY = 0;
+    for ( int y = -C_WORLD_RADIUS - 1; y <= C_WORLD_RADIUS + 1; ++y ){
+        for ( int x = -C_WORLD_RADIUS - 1; x <= C_WORLD_RADIUS + 1; ++x ){
+            if ( x < -C_WORLD_RADIUS || x > C_WORLD_RADIUS || y < -C_WORLD_RADIUS || y > C_WORLD_RADIUS ){
+                chunks.prefetch( x, y );        // ring around the first window
+            }
+        }
+    }
+    return build( hero, 0, 0 );
+}
+/*********************************************************/
+bool ChunkWorld::moved( shared_ptr<Map> &map ){
+    int pos = map->getHeroPos();
+    int x = originX * C_CHUNK_SIZE + pos % C_WORLD_SIDE;
+    int y = originY * C_CHUNK_SIZE + pos / C_WORLD_SIDE;
+    int dx = x - lastX;
+    int dy = y - lastY;
+    lastX = x;
+    lastY = y;
+    bool replaced = false;
+    if ( chunkOf( x ) != originX + C_WORLD_RADIUS || chunkOf( y ) != originY + C_WORLD_RADIUS ){
+        PROFILE_SCOPE( "ChunkWorld::moved" );
+        store( *map );
+        shared_ptr<Hero> hero = map->hero;
+        shared_ptr<NavGrid> grid = map->navGrid;                // graph and grid are read after old map is gone
+        shared_ptr<ClusterGraph> graph = map->clusterGraph;
+        int previousX = originX, previousY = originY;
+        map.reset();                            // old map lets hero go before new one takes him
+        map = build( hero, x, y );
+        if ( graph != NULL ){
+            moveGraph( *map, *grid, *graph, previousX, previousY );
+        }
+        replaced = true;
+    }
+    prefetchAhead( dx, dy );
+    return replaced;
+}
+/*********************************************************/
+void ChunkWorld::store( const Map &map ){
+    PROFILE_SCOPE( "ChunkWorld::store" );
+    for ( int i = 0; i < (int)window.size(); ++i ){
+        int left = ( i % C_WORLD_CHUNKS ) * C_CHUNK_SIZE;
+        int top = ( i / C_WORLD_CHUNKS ) * C_CHUNK_SIZE;
+        shared_ptr<Chunk> chunk ( new Chunk );
+        chunk->cells.resize( C_CHUNK_SIZE * C_CHUNK_SIZE );
+        for ( int row = 0; row < C_CHUNK_SIZE; ++row ){
+            for ( int col = 0; col < C_CHUNK_SIZE; ++col ){
+                int index = left + col + ( top + row ) * C_WORLD_SIDE;
+                ChunkEnemy enemy = { col + row * C_CHUNK_SIZE, Stats () };
+                unsigned char type = SaveGame::typeOf( map.getTile( index ) );
+                if ( map.getEnemyStats( index, enemy.stats ) ){
+                    type = ENEMY;
+                    chunk->enemies.push_back( enemy );
+                } else if ( type == ITEM ){
+                    ChunkItem item = { enemy.index, map.getTile( index ).getItem() };
+                    chunk->items.push_back( item );
+                }
+                chunk->cells[ enemy.index ] = type;
+            }
+        }
+        if ( !( *chunk == *window[i] ) ){
+            chunks.put( originX + i % C_WORLD_CHUNKS, originY + i / C_WORLD_CHUNKS, chunk );
+            window[i] = chunk;
+        }
+    }
+}
+/*********************************************************/
+bool ChunkWorld::save( const Map &map ){
+    store( map );
+    return chunks.flush();
+}
+/*********************************************************/
+ChunkStore &ChunkWorld::getChunks(){
+    return chunks;
+}
+/*********************************************************/
+shared_ptr<Map> ChunkWorld::build( shared_ptr<Hero> hero, int x, int y ){
+    PROFILE_SCOPE( "ChunkWorld::build" );
+    originX = chunkOf( x ) - C_WORLD_RADIUS;
+    originY = chunkOf( y ) - C_WORLD_RADIUS;
+    shared_ptr<Map> map ( new Map ( C_WORLD_SIDE, C_WORLD_SIDE ) );
+    for ( int i = 0; i < (int)window.size(); ++i ){
+        int left = ( i % C_WORLD_CHUNKS ) * C_CHUNK_SIZE;
+        int top = ( i / C_WORLD_CHUNKS ) * C_CHUNK_SIZE;
+        window[i] = chunks.get( originX + i % C_WORLD_CHUNKS, originY + i / C_WORLD_CHUNKS );
+        const Chunk &chunk = *window[i];
+        for ( int j = 0; j < (int)chunk.cells.size(); ++j ){
+            if ( chunk.cells[j] != ENEMY && chunk.cells[j] != EMPTY && chunk.cells[j] != ITEM ){
+                map->createMapObject( (typeMapObj)chunk.cells[j], left + j % C_CHUNK_SIZE + ( top + j / C_CHUNK_SIZE ) * C_WORLD_SIDE, hero );
+            }
+        }
+        for ( int j = 0; j < (int)chunk.enemies.size(); ++j ){
+            int index = chunk.enemies[j].index;
+            map->placeEnemy( left + index % C_CHUNK_SIZE + ( top + index / C_CHUNK_SIZE ) * C_WORLD_SIDE, chunk.enemies[j].stats );
+            map->countEnemies++;
+        }
+        for ( int j = 0; j < (int)chunk.items.size(); ++j ){
+            int index = chunk.items[j].index;
+            map->placeItem( left + index % C_CHUNK_SIZE + ( top + index / C_CHUNK_SIZE ) * C_WORLD_SIDE, chunk.items[j].item );
+        }
+    }
+    map->createMapObject( HERO, x - originX * C_CHUNK_SIZE + ( y - originY * C_CHUNK_SIZE ) * C_WORLD_SIDE, hero );
+    map->regions = shared_ptr<RegionMap>( new RegionMap ( *map ) );
+    return map;
+}
+/*********************************************************/
+void ChunkWorld::moveGraph( Map &map, const NavGrid &previousGrid, const ClusterGraph &previous, int previousX, int previousY ){
+    PROFILE_SCOPE( "ChunkWorld::moveGraph" );
+    int dx = ( previousX - originX ) * C_CHUNK_SIZE;
+    int dy = ( previousY - originY ) * C_CHUNK_SIZE;
+    shared_ptr<ClusterGraph> graph ( new ClusterGraph ( map.getNavGrid(), previous, dx, dy ) );
+    // only chunks loaded into window now are new for graph
+    for ( int i = 0; i < (int)window.size(); ++i ){
+        int x = originX + i % C_WORLD_CHUNKS;
+        int y = originY + i / C_WORLD_CHUNKS;
+        if ( x < previousX || x >= previousX + C_WORLD_CHUNKS || y < previousY || y >= previousY + C_WORLD_CHUNKS ){
+            graph->updateArea( ( i % C_WORLD_CHUNKS ) * C_CHUNK_SIZE, ( i / C_WORLD_CHUNKS ) * C_CHUNK_SIZE,
+                               C_CHUNK_SIZE, C_CHUNK_SIZE );
+        }
+    }
+    // old grid could read place differently, when hero stood on it while grid was made
+    const NavGrid &grid = map.getNavGrid();
+    for ( int y = max( dy, 0 ); y < C_WORLD_SIDE && y - dy < C_WORLD_SIDE; ++y ){
+        for ( int x = max( dx, 0 ); x < C_WORLD_SIDE && x - dx < C_WORLD_SIDE; ++x ){
+            if ( grid.at( x + y * C_WORLD_SIDE ) != previousGrid.at( x - dx + ( y - dy ) * C_WORLD_SIDE ) ){
+                graph->update( x + y * C_WORLD_SIDE );
+            }
+        }
+    }
+    map.clusterGraph = graph;
+}
+/*********************************************************/
+void ChunkWorld::prefetchAhead( int dx, int dy ){
+    if ( dx != 0 ){
+        int x = ( dx > 0 ) ? originX + C_WORLD_CHUNKS : originX - 1;
+        for ( int y = originY - 1; y <= originY + C_WORLD_CHUNKS; ++y ){
+            chunks.prefetch( x, y );
+        }
+    }
+    if ( dy != 0 ){
+        int y = ( dy > 0 ) ? originY + C_WORLD_CHUNKS : originY - 1;
+        for ( int x = originX - 1; x <= originX + C_WORLD_CHUNKS; ++x ){
+            chunks.prefetch( x, y );
+        }
+    }
+}
+/*********************************************************/
+int ChunkWorld::chunkOf( int coord ){
+    return ( coord >= 0 ) ? coord / C_CHUNK_SIZE : -( ( -coord - 1 ) / C_CHUNK_SIZE ) - 1;
+}
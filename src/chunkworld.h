@@ -0,0 +1,100 @@
+/** @file chunkworld.h
+ * Header file of ChunkWorld class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef CHUNKWORLD_H
+#define CHUNKWORLD_H
+#include <memory>
+#include <string>
+#include <vector>
+#include "chunkstore.h"
+#include "map.h"
+using namespace std;
+#define C_WORLD_RADIUS      1               // window has chunk of hero and so many chunks on every side
+#define C_WORLD_CHUNKS      ( 2 * C_WORLD_RADIUS + 1 )
+#define C_WORLD_SIDE        ( C_WORLD_CHUNKS * C_CHUNK_SIZE )   // height and width of window in places
+/**********************************************************************************************/
+/**
+ * @brief The ChunkWorld class is procedural world without borders
+ * @detailed    Hero plays on ordinary Map, which is window of C_WORLD_CHUNKS x C_WORLD_CHUNKS chunks
+ *              with hero in the middle one. When hero goes out of the middle chunk, changes of window
+ *              are given back to ChunkStore and new window is built around him, so pathfinding,
+ *              regions and real-time mode work as on any map. Cluster graph of window moves with
+ *              it, only clusters of newly loaded chunks are built again. Chunks ahead of hero are prefetched
+ *              on every step, so they are usually ready before window gets there.
+ *              Hero starts at place (0,0) of world.
+ */
+class ChunkWorld{
+    public:
+        /**
+         * @brief ChunkWorld is constructor with parameters
+         * @param seed is seed of world
+         * @param directory is directory of modified chunks
+         */
+        ChunkWorld( uint64_t seed, const string &directory = C_WORLD_DIR );
+        /**
+         * @brief create builds the first window, hero is at (0,0) of world
+         * @param hero is hero
+         * @return map of window
+         */
+        shared_ptr<Map> create( shared_ptr<Hero> hero );
+        /**
+         * @brief moved is called after every step, it prefetches chunks ahead and moves window
+         * @param map is map of window, it is replaced, when hero leaves the middle chunk
+         * @return true if map was replaced
+         */
+        bool moved( shared_ptr<Map> &map );
+        /**
+         * @brief store gives modified chunks of window to ChunkStore
+         * @param map is map of window
+         */
+        void store( const Map &map );
+        /**
+         * @brief save stores window and writes all modified chunks
+         * @param map is map of window
+         * @return false if some chunk couldn't be written
+         */
+        bool save( const Map &map );
+        /**
+         * @brief getChunks is getter of store of chunks
+         * @return store
+         */
+        ChunkStore &getChunks();
+    private:
+        ChunkStore chunks;
+        int originX, originY;                   // chunk in the top left corner of window
+        int lastX, lastY;                       // place of hero in world after previous step
+        vector<shared_ptr<const Chunk> > window;    // chunks as they were given to map
+        /**
+         * @brief build makes map of window around hero
+         * @param hero is hero
+         * @param x is column of hero in world
+         * @param y is row of hero in world
+         * @return map of window
+         */
+        shared_ptr<Map> build( shared_ptr<Hero> hero, int x, int y );
+        /**
+         * @brief moveGraph gives cluster graph of previous window to new map, only clusters of new chunks are built
+         * @param map is map of new window
+         * @param previousGrid is navigation grid of previous window
+         * @param previous is cluster graph of previous window
+         * @param previousX is column of chunk in the top left corner of previous window
+         * @param previousY is row of chunk in the top left corner of previous window
+         */
+        void moveGraph( Map &map, const NavGrid &previousGrid, const ClusterGraph &previous, int previousX, int previousY );
+        /**
+         * @brief prefetchAhead asks for chunks behind edge of window in direction of step
+         * @param dx is step in columns
+         * @param dy is step in rows
+         */
+        void prefetchAhead( int dx, int dy );
+        /**
+         * @brief chunkOf is getter of chunk coordinate of place, it rounds down also for negative ones
+         * @param coord is coordinate of place in world
+         * @return coordinate of chunk
+         */
+        static int chunkOf( int coord );
+};
+/**********************************************************************************************/
+#endif // CHUNKWORLD_H
@@ -0,0 +1,437 @@
+/** @file clustergraph.cpp
+ * Implementation of ClusterGraph class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <queue>
+#include <algorithm>
+#include <cstdlib>
+#include "clustergraph.h"
+/**********************************************************************************************/
+ClusterGraph::ClusterGraph( const NavGrid &grid ) : grid(grid){
+    width = grid.getWidth();
+    height = grid.getHeight();
+    clustersX = ( width + C_CLUSTER_SIZE - 1 ) / C_CLUSTER_SIZE;
+    clustersY = ( height + C_CLUSTER_SIZE - 1 ) / C_CLUSTER_SIZE;
+    clusters.resize( clustersX * clustersY );
+    hBorders.resize( clustersX * clustersY );
+    vBorders.resize( clustersX * clustersY );
+    for ( int i = 0; i < clustersX * clustersY; ++i ){
+        clusters[i].dirty = true;
+        hBorders[i].dirty = true;
+        vBorders[i].dirty = true;
+    }
+    distances.resize( C_CLUSTER_SIZE * C_CLUSTER_SIZE );
+    parents.resize( C_CLUSTER_SIZE * C_CLUSTER_SIZE );
+    queue.resize( C_CLUSTER_SIZE * C_CLUSTER_SIZE );
+    dirty = true;
+    rebuild();
+}
+/*********************************************************/
+ClusterGraph::ClusterGraph( const NavGrid &grid, const ClusterGraph &previous, int dx, int dy ) : grid(grid){
+    width = grid.getWidth();
+    height = grid.getHeight();
+    clustersX = ( width + C_CLUSTER_SIZE - 1 ) / C_CLUSTER_SIZE;
+    clustersY = ( height + C_CLUSTER_SIZE - 1 ) / C_CLUSTER_SIZE;
+    clusters.resize( clustersX * clustersY );
+    hBorders.resize( clustersX * clustersY );
+    vBorders.resize( clustersX * clustersY );
+    distances.resize( C_CLUSTER_SIZE * C_CLUSTER_SIZE );
+    parents.resize( C_CLUSTER_SIZE * C_CLUSTER_SIZE );
+    queue.resize( C_CLUSTER_SIZE * C_CLUSTER_SIZE );
+    int moved = dx + dy * width;                // every place of previous graph has index so much bigger
+    for ( int cy = 0; cy < clustersY; ++cy ){
+        for ( int cx = 0; cx < clustersX; ++cx ){
+            int c = cx + cy * clustersX;
+            int ox = cx - dx / C_CLUSTER_SIZE;
+            int oy = cy - dy / C_CLUSTER_SIZE;
+            clusters[c].dirty = hBorders[c].dirty = vBorders[c].dirty = false;
+            if ( ox < 0 || ox >= previous.clustersX || oy < 0 || oy >= previous.clustersY ){
+                continue;                       // new place, updateArea marks it
+            }
+            int o = ox + oy * previous.clustersX;
+            clusters[c] = previous.clusters[o];
+            Cluster &cl = clusters[c];
+            for ( int i = 0; i < (int)cl.nodes.size(); ++i ){
+                cl.nodes[i] += moved;
+                for ( int j = 0; j < (int)cl.edges[i].size(); ++j ){
+                    cl.edges[i][j].first += moved;
+                }
+            }
+            // neighbour behind edge of new grid is gone, its entrances have to go too
+            if ( ( cx == 0 && ox > 0 ) || ( cx == clustersX - 1 && ox < previous.clustersX - 1 ) ||
+                 ( cy == 0 && oy > 0 ) || ( cy == clustersY - 1 && oy < previous.clustersY - 1 ) ){
+                cl.dirty = true;
+            }
+            if ( cx + 1 < clustersX && ox + 1 < previous.clustersX ){
+                hBorders[c] = previous.hBorders[o];
+                for ( int i = 0; i < (int)hBorders[c].entrances.size(); ++i ){
+                    hBorders[c].entrances[i].first += moved;
+                    hBorders[c].entrances[i].second += moved;
+                }
+            }
+            if ( cy + 1 < clustersY && oy + 1 < previous.clustersY ){
+                vBorders[c] = previous.vBorders[o];
+                for ( int i = 0; i < (int)vBorders[c].entrances.size(); ++i ){
+                    vBorders[c].entrances[i].first += moved;
+                    vBorders[c].entrances[i].second += moved;
+                }
+            }
+        }
+    }
+    dirty = true;
+}
+/*********************************************************/
+void ClusterGraph::update( int index ){
+    int c = clusterOf(index);
+    int x = index % width % C_CLUSTER_SIZE;
+    int y = index / width % C_CLUSTER_SIZE;
+    clusters[c].dirty = true;
+    // place on border changes entrances, so neighbour cluster changes too
+    if ( x == C_CLUSTER_SIZE - 1 && c % clustersX + 1 < clustersX ){
+        hBorders[c].dirty = true;
+        clusters[c+1].dirty = true;
+    }
+    if ( x == 0 && c % clustersX > 0 ){
+        hBorders[c-1].dirty = true;
+        clusters[c-1].dirty = true;
+    }
+    if ( y == C_CLUSTER_SIZE - 1 && c / clustersX + 1 < clustersY ){
+        vBorders[c].dirty = true;
+        clusters[c+clustersX].dirty = true;
+    }
+    if ( y == 0 && c / clustersX > 0 ){
+        vBorders[c-clustersX].dirty = true;
+        clusters[c-clustersX].dirty = true;
+    }
+    dirty = true;
+}
+/*********************************************************/
+void ClusterGraph::updateArea( int x, int y, int w, int h ){
+    x = max( x, 0 );
+    y = max( y, 0 );
+    for ( int cy = y / C_CLUSTER_SIZE; cy * C_CLUSTER_SIZE < y+h && cy < clustersY; ++cy ){
+        for ( int cx = x / C_CLUSTER_SIZE; cx * C_CLUSTER_SIZE < x+w && cx < clustersX; ++cx ){
+            // first and last place of cluster mark all four borders
+            int lastX = min( ( cx + 1 ) * C_CLUSTER_SIZE, width ) - 1;
+            int lastY = min( ( cy + 1 ) * C_CLUSTER_SIZE, height ) - 1;
+            update( cx * C_CLUSTER_SIZE + cy * C_CLUSTER_SIZE * width );
+            update( lastX + lastY * width );
+        }
+    }
+}
+/*********************************************************/
+int ClusterGraph::getCountNodes() const{
+    int count = 0;
+    for ( int i = 0; i < (int)clusters.size(); ++i ){
+        count += clusters[i].nodes.size();
+    }
+    return count;
+}
+/*********************************************************/
+size_t ClusterGraph::getMemory() const{
+    size_t bytes = clusters.capacity() * sizeof(Cluster) + ( hBorders.capacity() + vBorders.capacity() ) * sizeof(Border)
+                 + ( distances.capacity() + parents.capacity() + queue.capacity() ) * sizeof(int);
+    for ( int i = 0; i < (int)clusters.size(); ++i ){
+        bytes += clusters[i].nodes.capacity() * sizeof(int) + clusters[i].edges.capacity() * sizeof(vector<pair<int,int> >);
+        for ( int j = 0; j < (int)clusters[i].edges.size(); ++j ){
+            bytes += clusters[i].edges[j].capacity() * sizeof(pair<int,int>);
+        }
+    }
+    for ( int i = 0; i < (int)hBorders.size(); ++i ){
+        bytes += hBorders[i].entrances.capacity() * sizeof(pair<int,int>);
+    }
+    for ( int i = 0; i < (int)vBorders.size(); ++i ){
+        bytes += vBorders[i].entrances.capacity() * sizeof(pair<int,int>);
+    }
+    return bytes;
+}
+/*********************************************************/
+void ClusterGraph::rebuild(){
+    if ( !dirty ){
+        return;
+    }
+    for ( int i = 0; i < clustersX * clustersY; ++i ){
+        if ( hBorders[i].dirty ){
+            buildBorder( i, true );
+        }
+        if ( vBorders[i].dirty ){
+            buildBorder( i, false );
+        }
+    }
+    for ( int i = 0; i < clustersX * clustersY; ++i ){
+        if ( clusters[i].dirty ){
+            buildCluster( i );
+        }
+    }
+    dirty = false;
+}
+/*********************************************************/
+void ClusterGraph::buildBorder( int cluster, bool horizontal ){
+    Border &border = horizontal ? hBorders[cluster] : vBorders[cluster];
+    border.dirty = false;
+    border.entrances.clear();
+    int cx = cluster % clustersX, cy = cluster / clustersX;
+    if ( ( horizontal && cx + 1 >= clustersX ) || ( !horizontal && cy + 1 >= clustersY ) ){
+        return;
+    }
+    // places of first cluster on border are first + i*along, places of second are first + i*along + across
+    int first, along, across, length;
+    if ( horizontal ){
+        first = ( cx * C_CLUSTER_SIZE + C_CLUSTER_SIZE - 1 ) + cy * C_CLUSTER_SIZE * width;
+        along = width;
+        across = 1;
+        length = min( C_CLUSTER_SIZE, height - cy * C_CLUSTER_SIZE );
+    } else {
+        first = cx * C_CLUSTER_SIZE + ( cy * C_CLUSTER_SIZE + C_CLUSTER_SIZE - 1 ) * width;
+        along = 1;
+        across = width;
+        length = min( C_CLUSTER_SIZE, width - cx * C_CLUSTER_SIZE );
+    }
+    int runStart = -1;
+    for ( int i = 0; i <= length; ++i ){
+        int a = first + i * along;
+        bool open = ( i < length ) && grid.at(a) <= NAV_ITEM && grid.at(a + across) <= NAV_ITEM;
+        if ( open && runStart < 0 ){
+            runStart = i;
+        }
+        if ( !open && runStart >= 0 ){
+            int runEnd = i - 1;
+            if ( runEnd - runStart + 1 >= C_ENTRANCE_LONG ){
+                int s = first + runStart * along, e = first + runEnd * along;
+                border.entrances.push_back( make_pair( s, s + across ) );
+                border.entrances.push_back( make_pair( e, e + across ) );
+            } else {
+                int m = first + ( runStart + runEnd ) / 2 * along;
+                border.entrances.push_back( make_pair( m, m + across ) );
+            }
+            runStart = -1;
+        }
+    }
+}
+/*********************************************************/
+void ClusterGraph::buildCluster( int cluster ){
+    Cluster &cl = clusters[cluster];
+    cl.dirty = false;
+    cl.nodes.clear();
+    cl.edges.clear();
+    int cx = cluster % clustersX, cy = cluster / clustersX;
+    // (place in this cluster, place in neighbour cluster)
+    vector<pair<int,int> > links = hBorders[cluster].entrances;
+    links.insert( links.end(), vBorders[cluster].entrances.begin(), vBorders[cluster].entrances.end() );
+    if ( cx > 0 ){
+        const vector<pair<int,int> > &e = hBorders[cluster-1].entrances;
+        for ( int i = 0; i < (int)e.size(); ++i ){
+            links.push_back( make_pair( e[i].second, e[i].first ) );
+        }
+    }
+    if ( cy > 0 ){
+        const vector<pair<int,int> > &e = vBorders[cluster-clustersX].entrances;
+        for ( int i = 0; i < (int)e.size(); ++i ){
+            links.push_back( make_pair( e[i].second, e[i].first ) );
+        }
+    }
+    for ( int i = 0; i < (int)links.size(); ++i ){
+        int n = find( cl.nodes.begin(), cl.nodes.end(), links[i].first ) - cl.nodes.begin();
+        if ( n == (int)cl.nodes.size() ){
+            cl.nodes.push_back( links[i].first );
+            cl.edges.push_back( vector<pair<int,int> >() );
+        }
+        cl.edges[n].push_back( make_pair( links[i].second, 1 ) );
+    }
+    for ( int i = 0; i < (int)cl.nodes.size(); ++i ){
+        searchCluster( cluster, cl.nodes[i] );
+        for ( int j = 0; j < (int)cl.nodes.size(); ++j ){
+            int d = distances[ localOf( cluster, cl.nodes[j] ) ];
+            if ( i != j && d >= 0 ){
+                cl.edges[i].push_back( make_pair( cl.nodes[j], d ) );
+            }
+        }
+    }
+}
+/*********************************************************/
+void ClusterGraph::searchCluster( int cluster, int from ){
+    int x0 = cluster % clustersX * C_CLUSTER_SIZE, y0 = cluster / clustersX * C_CLUSTER_SIZE;
+    int w = min( C_CLUSTER_SIZE, width - x0 ), h = min( C_CLUSTER_SIZE, height - y0 );
+    // -1 is unvisited free place, -2 is place where hero cannot go (or outside of map)
+    for ( int y = 0; y < C_CLUSTER_SIZE; ++y ){
+        for ( int x = 0; x < C_CLUSTER_SIZE; ++x ){
+            bool inside = x < w && y < h && grid.at( x0 + x + ( y0 + y ) * width ) <= NAV_ITEM;
+            distances[ x + y * C_CLUSTER_SIZE ] = inside ? -1 : -2;
+        }
+    }
+    int start = localOf( cluster, from );
+    distances[start] = 0;
+    parents[start] = -1;
+    int tail = 0;
+    queue[tail++] = start;
+    for ( int q = 0; q < tail; ++q ){
+        int curr = queue[q];
+        int x = curr % C_CLUSTER_SIZE, y = curr / C_CLUSTER_SIZE;
+        int next[4] = { x + 1 < C_CLUSTER_SIZE ? curr + 1 : -1, x > 0 ? curr - 1 : -1,
+                        y + 1 < C_CLUSTER_SIZE ? curr + C_CLUSTER_SIZE : -1, y > 0 ? curr - C_CLUSTER_SIZE : -1 };
+        for ( int i = 0; i < 4; ++i ){
+            if ( next[i] < 0 || distances[ next[i] ] != -1 ){
+                continue;
+            }
+            distances[ next[i] ] = distances[curr] + 1;
+            parents[ next[i] ] = curr;
+            queue[tail++] = next[i];
+        }
+    }
+}
+/*********************************************************/
+void ClusterGraph::refine( int from, int to, vector<int> &path ){
+    int cluster = clusterOf(from);
+    int x0 = cluster % clustersX * C_CLUSTER_SIZE, y0 = cluster / clustersX * C_CLUSTER_SIZE;
+    searchCluster( cluster, from );
+    size_t begin = path.size();
+    int start = localOf( cluster, from );
+    for ( int local = localOf( cluster, to ); local != start; local = parents[local] ){
+        path.push_back( x0 + local % C_CLUSTER_SIZE + ( y0 + local / C_CLUSTER_SIZE ) * width );
+    }
+    reverse( path.begin() + begin, path.end() );
+}
+/*********************************************************/
+bool ClusterGraph::findPath( int from, int to, vector<int> &path ){
+    path.clear();
+    if ( from == to || to < 0 || to >= width*height || grid.at(to) == NAV_BLOCKED ){
+        return false;
+    }
+    rebuild();
+    int startCluster = clusterOf(from);
+    // temporary node of start is connected to nodes of its cluster
+    vector<pair<int,int> > startEdges;
+    searchCluster( startCluster, from );
+    vector<int> startDistances = distances;
+    const Cluster &sc = clusters[startCluster];
+    for ( int i = 0; i < (int)sc.nodes.size(); ++i ){
+        int d = startDistances[ localOf( startCluster, sc.nodes[i] ) ];
+        if ( d >= 0 ){
+            startEdges.push_back( make_pair( sc.nodes[i], d ) );
+        }
+    }
+    // enemy or thorn as target is reached from its free neighbours (they can be in other clusters)
+    vector<int> approaches;
+    if ( grid.at(to) <= NAV_ITEM ){
+        approaches.push_back(to);
+    } else {
+        int x = to % width, y = to / width;
+        int nx[4] = { x+1, x-1, x, x };
+        int ny[4] = { y, y, y+1, y-1 };
+        for ( int i = 0; i < 4; ++i ){
+            if ( grid.isWalkable( nx[i], ny[i] ) ){
+                approaches.push_back( nx[i] + ny[i] * width );
+            }
+        }
+    }
+    // node -> (distance to target, approach place)
+    unordered_map<int, pair<int,int> > goalEdges;
+    pair<int,int> direct( -1, -1 );
+    for ( int a = 0; a < (int)approaches.size(); ++a ){
+        int cluster = clusterOf( approaches[a] );
+        int extra = ( approaches[a] == to ) ? 0 : 1;
+        searchCluster( cluster, approaches[a] );
+        const Cluster &gc = clusters[cluster];
+        for ( int i = 0; i < (int)gc.nodes.size(); ++i ){
+            int d = distances[ localOf( cluster, gc.nodes[i] ) ];
+            if ( d < 0 ){
+                continue;
+            }
+            unordered_map<int, pair<int,int> >::iterator it = goalEdges.find( gc.nodes[i] );
+            if ( it == goalEdges.end() || it->second.first > d + extra ){
+                goalEdges[ gc.nodes[i] ] = make_pair( d + extra, approaches[a] );
+            }
+        }
+        if ( cluster == startCluster ){
+            int d = startDistances[ localOf( cluster, approaches[a] ) ];
+            if ( d >= 0 && ( direct.first < 0 || direct.first > d + extra ) ){
+                direct = make_pair( d + extra, approaches[a] );
+            }
+        }
+    }
+    // A* on abstract graph, open list has (-f, (g, position))
+    struct Node{
+        int g;
+        int parent;
+        int via;                                // approach place, if parent is connected to target
+        bool closed;
+    };
+    unordered_map<int, Node> nodes;
+    priority_queue<pair<int, pair<int,int> > > open;
+    Node start = { 0, -1, -1, false };
+    nodes[from] = start;
+    open.push( make_pair( -distance(from, to), make_pair( 0, from ) ) );
+    bool found = false;
+    vector<pair<int,int> > neighbours;
+    vector<int> vias;                           // approach places of edges to target
+    while ( !open.empty() ){
+        int curr = open.top().second.second;
+        open.pop();
+        if ( nodes[curr].closed ){
+            continue;
+        }
+        nodes[curr].closed = true;
+        if ( curr == to ){
+            found = true;
+            break;
+        }
+        int g = nodes[curr].g;
+        neighbours.clear();
+        if ( curr == from ){
+            neighbours = startEdges;
+        }
+        const Cluster &cl = clusters[clusterOf(curr)];
+        int self = find( cl.nodes.begin(), cl.nodes.end(), curr ) - cl.nodes.begin();
+        if ( self < (int)cl.nodes.size() ){
+            neighbours.insert( neighbours.end(), cl.edges[self].begin(), cl.edges[self].end() );
+        }
+        vias.assign( neighbours.size(), -1 );
+        if ( curr == from && direct.first >= 0 ){
+            neighbours.push_back( make_pair( to, direct.first ) );
+            vias.push_back( direct.second );
+        }
+        unordered_map<int, pair<int,int> >::iterator ge = goalEdges.find(curr);
+        if ( ge != goalEdges.end() ){
+            neighbours.push_back( make_pair( to, ge->second.first ) );
+            vias.push_back( ge->second.second );
+        }
+        for ( int i = 0; i < (int)neighbours.size(); ++i ){
+            int next = neighbours[i].first;
+            int ng = g + neighbours[i].second;
+            unordered_map<int, Node>::iterator it = nodes.find(next);
+            if ( it != nodes.end() && ( it->second.closed || it->second.g <= ng ) ){
+                continue;
+            }
+            Node n = { ng, curr, vias[i], false };
+            nodes[next] = n;
+            open.push( make_pair( -( ng + distance(next, to) ), make_pair( ng, next ) ) );
+        }
+    }
+    if ( found ){
+        vector<int> route;
+        for ( int curr = to; curr != -1; curr = nodes[curr].parent ){
+            route.push_back(curr);
+        }
+        reverse( route.begin(), route.end() );
+        // refine only clusters on the route, step over border is one step
+        for ( int i = 1; i < (int)route.size(); ++i ){
+            int prev = route[i-1];
+            if ( route[i] == to && nodes[to].via >= 0 ){
+                refine( prev, nodes[to].via, path );
+                if ( nodes[to].via != to ){
+                    path.push_back(to);
+                }
+            } else if ( clusterOf(prev) == clusterOf( route[i] ) ){
+                refine( prev, route[i], path );
+            } else {
+                path.push_back( route[i] );
+            }
+        }
+    }
+    return found;
+}
+/*********************************************************/
+int ClusterGraph::distance( int a, int b ) const{
+    return abs( a % width - b % width ) + abs( a / width - b / width );
+}
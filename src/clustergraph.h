@@ -0,0 +1,151 @@
+/** @file clustergraph.h
+ * Header file of ClusterGraph class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef CLUSTERGRAPH_H
+#define CLUSTERGRAPH_H
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include "pathfinder.h"
+using namespace std;
+#define C_CLUSTER_SIZE  16          // width and height of one cluster
+#define C_ENTRANCE_LONG 6           // longer entrances have two abstract nodes (on both ends)
+#define C_HPA_DISTANCE  128         // targets farther than this are searched on abstract graph
+/**********************************************************************************************/
+/**
+ * @brief The ClusterGraph class is hierarchical path finder (HPA*)
+ * @detailed    Map is divided into square clusters. Free places on borders of clusters are entrances,
+ *              entrances are nodes of abstract graph. Nodes in one cluster are connected by distance
+ *              inside this cluster, nodes on both sides of entrance by one step.
+ *              Path is found on abstract graph at first and then it is refined only in clusters
+ *              on this path.
+ *              Enemy or thorn as target is reached from its free neighbours.
+ *              Change of some place rebuilds only its cluster (and neighbour cluster if place is on border),
+ *              dirty clusters are rebuilt lazily before next search.
+ */
+class ClusterGraph{
+    public:
+        /**
+         * @brief ClusterGraph is constructor with parameters, it builds all clusters
+         * @param grid is navigation grid to search on
+         */
+        ClusterGraph( const NavGrid &grid );
+        /**
+         * @brief ClusterGraph is constructor with parameters, it takes clusters of previous graph moved on new grid
+         * @detailed    It is for window over bigger world, which moved by whole clusters. Clusters which
+         *              were in previous graph stay as they were, except of ones which lost their neighbour.
+         *              Places which weren't in previous graph have to be marked by updateArea.
+         * @param grid is navigation grid to search on, it has the same size as previous one
+         * @param previous is graph of previous grid
+         * @param dx is count of columns which places of previous grid moved by, multiple of C_CLUSTER_SIZE
+         * @param dy is count of rows which places of previous grid moved by, multiple of C_CLUSTER_SIZE
+         */
+        ClusterGraph( const NavGrid &grid, const ClusterGraph &previous, int dx, int dy );
+        /**
+         * @brief update marks cluster of changed place as dirty
+         * @param index is changed position on map
+         */
+        void update( int index );
+        /**
+         * @brief updateArea marks all clusters of changed rectangle as dirty (for example loaded part of map)
+         * @param x is first column
+         * @param y is first row
+         * @param w is width of area
+         * @param h is height of area
+         */
+        void updateArea( int x, int y, int w, int h );
+        /**
+         * @brief findPath finds path between two places, path is near the shortest one
+         * @param from is start position (hero)
+         * @param to is target position, it can be also an enemy or thorn
+         * @param path is output, positions of all steps, without start and with target
+         * @return false if there isn't any path
+         */
+        bool findPath( int from, int to, vector<int> &path );
+        /**
+         * @brief getCountNodes is getter for size of abstract graph
+         * @return count of abstract nodes
+         */
+        int getCountNodes() const;
+        /**
+         * @brief getMemory counts memory used by clusters, borders and scratch of BFS
+         * @return size in bytes
+         */
+        size_t getMemory() const;
+    private:
+        /**
+         * @brief The Cluster struct is one square part of map
+         * @detailed edges[i] are neighbours of nodes[i]: (position of neighbour, distance)
+         */
+        struct Cluster{
+            vector<int> nodes;
+            vector<vector<pair<int,int> > > edges;
+            bool dirty;
+        };
+        /**
+         * @brief The Border struct is list of entrances between two neighbour clusters
+         * @detailed pairs are (place in first cluster, place in second cluster)
+         */
+        struct Border{
+            vector<pair<int,int> > entrances;
+            bool dirty;
+        };
+        const NavGrid &grid;
+        int width, height;
+        int clustersX, clustersY;
+        vector<Cluster> clusters;
+        vector<Border> hBorders;                // between cluster and its right neighbour
+        vector<Border> vBorders;                // between cluster and its bottom neighbour
+        bool dirty;
+        vector<int> distances;                  // scratch for BFS inside one cluster
+        vector<int> parents;
+        vector<int> queue;
+        /**
+         * @brief clusterOf counts cluster of place
+         */
+        int clusterOf( int index ) const{
+            return ( index / width ) / C_CLUSTER_SIZE * clustersX + ( index % width ) / C_CLUSTER_SIZE;
+        }
+        /**
+         * @brief localOf counts index of place inside its cluster
+         */
+        int localOf( int cluster, int index ) const{
+            return ( index % width - cluster % clustersX * C_CLUSTER_SIZE ) + ( index / width - cluster / clustersX * C_CLUSTER_SIZE ) * C_CLUSTER_SIZE;
+        }
+        /**
+         * @brief rebuild rebuilds all dirty borders and clusters
+         */
+        void rebuild();
+        /**
+         * @brief buildBorder finds entrances on border between cluster and its neighbour
+         * @param cluster is index of cluster
+         * @param horizontal is true for right neighbour, false for bottom neighbour
+         */
+        void buildBorder( int cluster, bool horizontal );
+        /**
+         * @brief buildCluster collects nodes from borders of cluster and connects them
+         * @param cluster is index of cluster
+         */
+        void buildCluster( int cluster );
+        /**
+         * @brief searchCluster is BFS inside one cluster, it fills distances and parents
+         * @param cluster is index of cluster
+         * @param from is start position
+         */
+        void searchCluster( int cluster, int from );
+        /**
+         * @brief refine appends steps of path inside of one cluster
+         * @param from is start position
+         * @param to is end position, it is in the same cluster
+         * @param path is output
+         */
+        void refine( int from, int to, vector<int> &path );
+        /**
+         * @brief distance is manhattan distance between two places
+         */
+        int distance( int a, int b ) const;
+};
+/**********************************************************************************************/
+#endif // CLUSTERGRAPH_H
@@ -1,6 +1,6 @@
 /** @file data.h
  * Header file and implementation family of classes:
- * ScreenData class -> MenuData class, MessageData class, MapData class.
+ * ScreenData class -> MenuData class, MessageData class, MapData class, DialogData class.
  *
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
 */
@@ -11,7 +11,13 @@
 #include <string>
 #include <fstream>
 #include "map.h"
+#include "autosave.h"
+#include "dungeon.h"
 using namespace std;
+#define C_WIDTH 40                  // width size of camera, for shows part of map on screen
+#define C_HEIGHT 20                 // height
+#define C_POSX  35                  // column on screen where map begins (with border)
+#define C_POSY  0                   // row on screen where map begins (with border)
 /**********************************************************************************************/
 /**
  * @brief The Modes of screen data
@@ -20,7 +26,8 @@ enum  ScreenDataType{
     MENU,               //<Show menu
     MESSAGE,            //<Show message
     MAP,                //<Show map
-    CREATEHERO          //<Show creation of hero
+    CREATEHERO,         //<Show creation of hero
+    DIALOG              //<Show dialog with NPC
 };
 /**********************************************************************************************/
 /**
@@ -133,8 +140,11 @@ class MapData : public ScreenData{
          * @brief MapData is constructor with parameters
          * @param map is map to show
          * @param heroIndex os possition where should be hero on the map
+         * @param autoSave is autosave of game to show its metrics, it can be NULL
+         * @param dungeon is dungeon of map to show its level, it can be NULL
          */
-        MapData( Map *map, const int &heroIndex) : map(map), hero(heroIndex) {
+        MapData( Map *map, const int &heroIndex, const AutoSave *autoSave = NULL, const Dungeon *dungeon = NULL )
+               : map(map), hero(heroIndex), autoSave(autoSave), dungeon(dungeon) {
             ScreenData::type = MAP;
         }
         /**
@@ -151,9 +161,48 @@ class MapData : public ScreenData{
         const int &getHeroIndex() const{
             return hero;
         }
+        /**
+         * @brief getAutoSave is getter of autosave of game
+         * @return autosave or NULL
+         */
+        const AutoSave *getAutoSave() const{
+            return autoSave;
+        }
+        /**
+         * @brief getDungeon is getter of dungeon of map
+         * @return dungeon or NULL
+         */
+        const Dungeon *getDungeon() const{
+            return dungeon;
+        }
+        /**
+         * @brief getCamera counts which part of map is shown on screen, camera follows the Hero
+         * @param cX is output, first shown column of map
+         * @param cY is output, first shown row of map
+         */
+        void getCamera( int &cX, int &cY ) const{
+            int width = map->getWidth();
+            int height = map->getHeight();
+            cX = hero % width - C_WIDTH/2;
+            cY = hero / width - C_HEIGHT/2;
+            if ( cX+C_WIDTH > width ){
+                cX = width - C_WIDTH;
+            }
+            if ( cY+C_HEIGHT > height ){
+                cY = height - C_HEIGHT;
+            }
+            if ( cX < 0 ) {
+                cX = 0;
+            }
+            if ( cY < 0 ){
+                cY = 0;
+            }
+        }
 private:
         Map * map;
         const int &hero;
+        const AutoSave *autoSave;
+        const Dungeon *dungeon;
 };
 /**********************************************************************************************/
 /**
@@ -207,4 +256,56 @@ class CreateHeroData : public ScreenData{
         int currSkill;
 };
 /**********************************************************************************************/
+/**
+ * @brief The DialogData class
+ * @detailed Descendant class of ScreenData, uses for forming of dialog data
+ */
+class DialogData : public ScreenData{
+    public:
+        /**
+         * @brief DialogData is constructor with parameters
+         * @param npc is name of NPC
+         * @param text is what NPC says
+         * @param choices are answers of hero
+         * @param curr is chosen answer
+         */
+        DialogData( const string &npc, const string &text, const vector<string> &choices, const int &curr ) :
+            npc(npc), text(text), choices(choices), currChoice(curr) {
+            ScreenData::type = DIALOG;
+        }
+        /**
+         * @brief getNpc is getter of name of NPC
+         * @return name
+         */
+        const string &getNpc() const{
+            return npc;
+        }
+        /**
+         * @brief getText is getter of what NPC says
+         * @return text
+         */
+        const string &getText() const{
+            return text;
+        }
+        /**
+         * @brief getChoices is getter of answers of hero
+         * @return answers, they can be empty at the end of dialog
+         */
+        const vector<string> &getChoices() const{
+            return choices;
+        }
+        /**
+         * @brief getCurrChoice is getter of chosen answer
+         * @return index of answer
+         */
+        int getCurrChoice() const{
+            return currChoice;
+        }
+    private:
+        string npc;
+        string text;
+        vector<string> choices;
+        int currChoice;
+};
+/**********************************************************************************************/
 #endif // DATA_H
@@ -0,0 +1,78 @@
+/** @file deltalog.cpp
+ * Implementation of DeltaLog class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include "deltalog.h"
+/**********************************************************************************************/
+DeltaLog::DeltaLog( int capacity ) : capacity(capacity), head(0), count(0), countSteps(0), isOpen(false){}
+/*********************************************************/
+void DeltaLog::beginStep( uint64_t random ){
+    isOpen = true;
+    push( DELTA_STEP, 0, (long long)random );
+}
+/*********************************************************/
+void DeltaLog::push( DeltaType type, int index, long long before, const MapElement *tile ){
+    if ( !isOpen ){
+        return;
+    }
+    if ( count == (int)ring.size() && count < capacity ){
+        // buffer grows up to capacity, short games don't need whole one
+        rotate( ring.begin(), ring.begin() + head, ring.end() );
+        head = ring.size();
+        ring.resize( min( capacity, max( C_DELTA_MIN, 2 * count ) ) );
+    }
+    if ( count == (int)ring.size() ){
+        dropOldest();
+        if ( count == 0 ){
+            // currient step is longer than whole buffer, it can't be undone
+            isOpen = false;
+            return;
+        }
+    }
+    Delta &delta = ring[head];
+    delta.type = type;
+    delta.index = index;
+    delta.before = before;
+    delta.tile = tile;
+    head = ( head + 1 ) % ring.size();
+    count++;
+    if ( type == DELTA_STEP ){
+        countSteps++;
+    }
+}
+/*********************************************************/
+bool DeltaLog::pop( Delta &delta ){
+    if ( count == 0 ){
+        return false;
+    }
+    head = ( head + ring.size() - 1 ) % ring.size();
+    delta = ring[head];
+    count--;
+    if ( delta.type == DELTA_STEP ){
+        countSteps--;
+    }
+    if ( count == 0 ){
+        isOpen = false;
+    }
+    return true;
+}
+/*********************************************************/
+void DeltaLog::clear(){
+    head = 0;
+    count = 0;
+    countSteps = 0;
+    isOpen = false;
+}
+/*********************************************************/
+void DeltaLog::dropOldest(){
+    // marker of the oldest step and all changes up to the next marker
+    do {
+        int tail = ( head + ring.size() - count ) % ring.size();
+        if ( ring[tail].type == DELTA_STEP ){
+            countSteps--;
+        }
+        count--;
+    } while ( count > 0 && ring[ ( head + ring.size() - count ) % ring.size() ].type != DELTA_STEP );
+}
@@ -0,0 +1,122 @@
+/** @file deltalog.h
+ * Header file of DeltaLog class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef DELTALOG_H
+#define DELTALOG_H
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "mapelement.h"
+using namespace std;
+#define C_DELTA_CAPACITY    4096        // max count of deltas kept for undo
+#define C_DELTA_MIN         64          // first size of buffer
+/**
+ * @brief The types of changes of game world
+ */
+enum DeltaType{
+    DELTA_STEP,         //<Beginning of step, before is state of random generator
+    DELTA_TILE,         //<Place index was replaced, tile is the old element
+    DELTA_HERO_POS,     //<Hero went from before to index
+    DELTA_ENEMIES,      //<Count of enemies to kill was before
+    DELTA_ENEMY,        //<Enemy with handle before (Handle::pack) was killed on index
+    DELTA_HEALTH,       //<Hero's health was before
+    DELTA_DAMAGE,       //<Hero's damage was before
+    DELTA_DEFENCE,      //<Hero's defence was before
+    DELTA_ITEM,         //<Hero had before items of type index
+    DELTA_TRIGGER,      //<Trigger index fired
+    DELTA_SPAWN,        //<Enemy appeared on index
+    DELTA_SPAWNER,      //<Spawner index made new enemy with handle before (Handle::pack)
+    DELTA_REVIVE,       //<Spawner index took killed enemy with handle before from its pool
+    DELTA_REGIONS       //<Barrier index was opened, before is count of RegionLinks links before it
+};
+/**
+ * @brief The Delta struct is one change of game world with value before it
+ */
+struct Delta{
+    DeltaType type;
+    int index;
+    long long before;
+    const MapElement *tile;
+};
+/**********************************************************************************************/
+/**
+ * @brief The DeltaLog class
+ * @detailed    Ring buffer of changes of map and hero. Every step of game begins by DELTA_STEP,
+ *              undo takes changes back from the newest one to the marker of step, so undo of N steps
+ *              costs only count of changes in them. Buffer grows up to fixed capacity, if it is full,
+ *              the oldest whole step is forgotten.
+ */
+class DeltaLog{
+    public:
+        /**
+         * @brief DeltaLog is constructor with parameters
+         * @param capacity is max count of deltas
+         */
+        DeltaLog( int capacity = C_DELTA_CAPACITY );
+        /**
+         * @brief beginStep starts new step, all next changes belong to it
+         * @param random is state of random generator before step
+         */
+        void beginStep( uint64_t random );
+        /**
+         * @brief push writes change into log, it is ignored outside of step
+         * @param type is type of change
+         * @param index is position on map
+         * @param before is value before change
+         * @param tile is element which was on position before change
+         */
+        void push( DeltaType type, int index, long long before, const MapElement *tile = NULL );
+        /**
+         * @brief pop takes the newest change out of log
+         * @param delta is output, the change
+         * @return false if log is empty
+         */
+        bool pop( Delta &delta );
+        /**
+         * @brief clear forgets all changes
+         */
+        void clear();
+        /**
+         * @brief getCountSteps is getter of count of steps which can be undone
+         * @return count of steps
+         */
+        int getCountSteps() const{
+            return countSteps;
+        }
+        /**
+         * @brief getCountDeltas is getter of count of changes in log
+         * @return count of changes
+         */
+        int getCountDeltas() const{
+            return count;
+        }
+        /**
+         * @brief getMemory is getter of memory used by buffer, it grows up to getMaxMemory
+         * @return size in bytes
+         */
+        size_t getMemory() const{
+            return ring.size() * sizeof(Delta);
+        }
+        /**
+         * @brief getMaxMemory is getter of memory of buffer with full capacity
+         * @return size in bytes
+         */
+        size_t getMaxMemory() const{
+            return capacity * sizeof(Delta);
+        }
+    private:
+        int capacity;
+        vector<Delta> ring;
+        int head;                               // place for next change
+        int count;
+        int countSteps;
+        bool isOpen;                            // false until first step or if step didn't fit into buffer
+        /**
+         * @brief dropOldest forgets the oldest step
+         */
+        void dropOldest();
+};
+/**********************************************************************************************/
+#endif // DELTALOG_H
@@ -0,0 +1,310 @@
+/** @file dialog.cpp
+ * Implementation of DialogLibrary class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dialog.h"
+#include "exception.h"
+#include "profiler.h"
+/**********************************************************************************************/
+/**
+ * @brief The DialogCompiler struct is state of compilation of one source
+ */
+struct DialogCompiler{
+    vector<DialogEntry> entries;
+    vector<DialogNode> nodes;
+    vector<DialogEdge> edges;
+    vector<string> targets;                     // names of target nodes of edges of current dialog
+    map<string, int> nodeNames;                 // nodes of current dialog
+    string text;                                // text of current node
+    string pool;
+    unordered_map<string, int32_t> interned;    // offsets of strings in pool
+    /**
+     * @brief intern puts string into pool, the same string is there only once
+     * @param str is string
+     * @return offset in pool
+     */
+    int32_t intern( const string &str ){
+        unordered_map<string, int32_t>::iterator found = interned.find( str );
+        if ( found != interned.end() ){
+            return found->second;
+        }
+        int32_t offset = pool.size();
+        pool.append( str.c_str(), str.size() + 1 );
+        interned.insert( make_pair( str, offset ) );
+        return offset;
+    }
+    /**
+     * @brief finishNode puts text of current node into pool
+     */
+    void finishNode(){
+        if ( !entries.empty() && entries.back().countNodes > 0 ){
+            nodes.back().text = intern( text );
+        }
+        text.clear();
+    }
+    /**
+     * @brief finishDialog translates names of targets to indexes of nodes
+     * @param errorEnd is end of error message
+     */
+    void finishDialog( const string &errorEnd ){
+        finishNode();
+        if ( entries.empty() ){
+            return;
+        }
+        if ( entries.back().countNodes == 0 ){
+            throw Exception ( "Dialog " + string ( pool.c_str() + entries.back().name ) + " hasn't any node" + errorEnd );
+        }
+        int firstEdge = edges.size() - targets.size();
+        for ( int i = 0; i < (int)targets.size(); ++i ){
+            if ( targets[i] == "end" ){
+                edges[ firstEdge + i ].target = C_DIALOG_END;
+                continue;
+            }
+            map<string, int>::iterator found = nodeNames.find( targets[i] );
+            if ( found == nodeNames.end() ){
+                throw Exception ( "Unknown node " + targets[i] + " in dialog " + string ( pool.c_str() + entries.back().name ) + errorEnd );
+            }
+            edges[ firstEdge + i ].target = found->second;
+        }
+        targets.clear();
+        nodeNames.clear();
+    }
+};
+/**
+ * @brief trim removes spaces, tabs and '\r' from both ends of string
+ * @param str is string
+ * @return trimmed string
+ */
+static string trim( const string &str ){
+    size_t begin = str.find_first_not_of( " \t\r" );
+    if ( begin == string::npos ){
+        return "";
+    }
+    size_t end = str.find_last_not_of( " \t\r" );
+    return str.substr( begin, end - begin + 1 );
+}
+/**
+ * @brief isBefore orders dialogs by name of NPC
+ * @param a is first dialog with its name
+ * @param b is second dialog with its name
+ * @return true if a goes before b
+ */
+static bool isBefore( const pair<string, DialogEntry> &a, const pair<string, DialogEntry> &b ){
+    return a.first < b.first;
+}
+/**********************************************************************************************/
+map<string, shared_ptr<DialogLibrary> > DialogLibrary::libraries;
+mutex DialogLibrary::lock;
+/*********************************************************/
+shared_ptr<DialogLibrary> DialogLibrary::open( const string &source ){
+    lock_guard<mutex> guard ( lock );
+    map<string, shared_ptr<DialogLibrary> >::iterator it = libraries.find( source );
+    if ( it != libraries.end() ){
+        return it->second;
+    }
+    PROFILE_SCOPE( "DialogLibrary::open" );
+    string compiled = compiledName( source );
+    struct stat src, bin;
+    memset( &src, 0, sizeof(src) );
+    memset( &bin, 0, sizeof(bin) );
+    bool isSource = ( stat( source.c_str(), &src ) == 0 );
+    bool isCompiled = ( stat( compiled.c_str(), &bin ) == 0 );
+    bool isNewer = src.st_mtim.tv_sec > bin.st_mtim.tv_sec ||
+                   ( src.st_mtim.tv_sec == bin.st_mtim.tv_sec && src.st_mtim.tv_nsec > bin.st_mtim.tv_nsec );
+    if ( isSource && ( !isCompiled || isNewer ) ){
+        compile( source, compiled );
+    }
+    shared_ptr<DialogLibrary> library ( new DialogLibrary ( compiled ) );
+    libraries.insert( make_pair( source, library ) );
+    return library;
+}
+/*********************************************************/
+DialogHeader DialogLibrary::compile( const string &source, const string &output ){
+    PROFILE_SCOPE( "DialogLibrary::compile" );
+    ifstream in ( source.c_str() );
+    if ( !in ){
+        throw Exception ( "Dialogs " + source + " can't be read.\n" );
+    }
+    DialogCompiler dc;
+    string line;
+    int number = 0;
+    while ( getline( in, line ) ){
+        number++;
+        stringstream where;
+        where << " at line " << number << " of " << source << ".\n";
+        string errorEnd = where.str();
+        line = trim( line );
+        if ( line.empty() || line.compare( 0, 2, "//" ) == 0 ){
+            continue;
+        }
+        if ( line[0] == '@' ){
+            dc.finishDialog( errorEnd );
+            DialogEntry entry = { dc.intern( trim( line.substr(1) ) ), (int32_t)dc.nodes.size(), 0 };
+            dc.entries.push_back( entry );
+            continue;
+        }
+        if ( dc.entries.empty() ){
+            throw Exception ( "Dialog has to begin by @npc" + errorEnd );
+        }
+        if ( line[0] == '#' ){
+            dc.finishNode();
+            string name = trim( line.substr(1) );
+            if ( !dc.nodeNames.insert( make_pair( name, dc.entries.back().countNodes ) ).second ){
+                throw Exception ( "Node " + name + " is twice" + errorEnd );
+            }
+            DialogNode node = { 0, (int32_t)dc.edges.size(), 0 };
+            dc.nodes.push_back( node );
+            dc.entries.back().countNodes++;
+            continue;
+        }
+        if ( dc.entries.back().countNodes == 0 ){
+            throw Exception ( "Text of dialog has to be in #node" + errorEnd );
+        }
+        if ( line[0] == '>' ){
+            size_t arrow = line.rfind( "->" );
+            if ( arrow == string::npos || arrow == 0 ){
+                throw Exception ( "Answer has to end by -> node" + errorEnd );
+            }
+            DialogEdge edge = { dc.intern( trim( line.substr( 1, arrow - 1 ) ) ), 0 };
+            dc.edges.push_back( edge );
+            dc.targets.push_back( trim( line.substr( arrow + 2 ) ) );
+            dc.nodes.back().countEdges++;
+            continue;
+        }
+        dc.text += ( dc.text.empty() ? "" : "\n" ) + line;
+    }
+    dc.finishDialog( " at the end of " + source + ".\n" );
+    // directory is sorted by name for binary search
+    const string &pool = dc.pool;
+    vector<pair<string, DialogEntry> > sorted;
+    for ( int i = 0; i < (int)dc.entries.size(); ++i ){
+        sorted.push_back( make_pair( string ( pool.c_str() + dc.entries[i].name ), dc.entries[i] ) );
+    }
+    sort( sorted.begin(), sorted.end(), isBefore );
+    for ( int i = 0; i < (int)sorted.size(); ++i ){
+        if ( i > 0 && sorted[i].first == sorted[i-1].first ){
+            throw Exception ( "Dialog " + sorted[i].first + " is twice in " + source + ".\n" );
+        }
+        dc.entries[i] = sorted[i].second;
+    }
+    DialogHeader header = { C_DIALOG_MAGIC, C_DIALOG_VERSION, (int32_t)dc.entries.size(), (int32_t)dc.nodes.size(),
+                            (int32_t)dc.edges.size(), (int32_t)pool.size() };
+    // other process (--dialogs) can compile the same file now
+    stringstream name;
+    name << output << "." << getpid() << ".tmp";
+    string temporary = name.str();
+    {
+        ofstream out ( temporary.c_str(), ios::binary );
+        out.write( (const char *)&header, sizeof(header) );
+        out.write( (const char *)dc.entries.data(), dc.entries.size() * sizeof(DialogEntry) );
+        out.write( (const char *)dc.nodes.data(), dc.nodes.size() * sizeof(DialogNode) );
+        out.write( (const char *)dc.edges.data(), dc.edges.size() * sizeof(DialogEdge) );
+        out.write( pool.data(), pool.size() );
+        if ( !out ){
+            throw Exception ( "Dialogs can't be written to " + output + ".\n" );
+        }
+    }
+    if ( rename( temporary.c_str(), output.c_str() ) != 0 ){
+        unlink( temporary.c_str() );
+        throw Exception ( "Dialogs can't be written to " + output + ".\n" );
+    }
+    return header;
+}
+/*********************************************************/
+string DialogLibrary::compiledName( const string &source ){
+    size_t dot = source.find_last_of( '.' );
+    size_t slash = source.find_last_of( '/' );
+    if ( dot == string::npos || ( slash != string::npos && dot < slash ) ){
+        return source + ".dlg";
+    }
+    return source.substr( 0, dot ) + ".dlg";
+}
+/*********************************************************/
+DialogLibrary::DialogLibrary( const string &fileName ) : data(NULL), size(0){
+    string errorMess = "Dialogs " + fileName + " are damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+    int fd = ::open( fileName.c_str(), O_RDONLY );
+    if ( fd < 0 ){
+        throw Exception ( "There aren't any dialogs in " + fileName + ".\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || st.st_size < (off_t)sizeof(DialogHeader) ){
+        close(fd);
+        throw Exception ( errorMess );
+    }
+    size = st.st_size;
+    void *mapped = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close(fd);
+    if ( mapped == MAP_FAILED ){
+        throw Exception ( errorMess );
+    }
+    data = (const char *)mapped;
+    header = (const DialogHeader *)data;
+    // only header and sizes are checked here, dialog is checked when it is found
+    long long needed = (long long)sizeof(DialogHeader) + (long long)header->countDialogs * sizeof(DialogEntry) +
+                       (long long)header->countNodes * sizeof(DialogNode) + (long long)header->countEdges * sizeof(DialogEdge) +
+                       header->poolSize;
+    if ( header->magic != C_DIALOG_MAGIC || header->version != C_DIALOG_VERSION || header->countDialogs < 0 ||
+         header->countNodes < 0 || header->countEdges < 0 || header->poolSize <= 0 || needed != (long long)size ||
+         data[ size - 1 ] != '\0' ){
+        munmap( (void *)data, size );
+        throw Exception ( errorMess );
+    }
+    entries = (const DialogEntry *)( data + sizeof(DialogHeader) );
+    nodes = (const DialogNode *)( entries + header->countDialogs );
+    edges = (const DialogEdge *)( nodes + header->countNodes );
+    pool = (const char *)( edges + header->countEdges );
+}
+/*********************************************************/
+DialogLibrary::~DialogLibrary(){
+    munmap( (void *)data, size );
+}
+/*********************************************************/
+bool DialogLibrary::find( const string &npc, Dialog &dialog ) const{
+    string errorMess = "Dialogs are damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+    int low = 0, high = header->countDialogs;
+    while ( low < high ){
+        int middle = ( low + high ) / 2;
+        const DialogEntry &entry = entries[middle];
+        if ( entry.name < 0 || entry.name >= header->poolSize ){
+            throw Exception ( errorMess );
+        }
+        int cmp = strcmp( pool + entry.name, npc.c_str() );
+        if ( cmp < 0 ){
+            low = middle + 1;
+        } else if ( cmp > 0 ){
+            high = middle;
+        } else {
+            if ( entry.firstNode < 0 || entry.countNodes <= 0 || entry.firstNode > header->countNodes - entry.countNodes ){
+                throw Exception ( errorMess );
+            }
+            for ( int i = entry.firstNode; i < entry.firstNode + entry.countNodes; ++i ){
+                const DialogNode &node = nodes[i];
+                if ( node.text < 0 || node.text >= header->poolSize || node.firstEdge < 0 || node.countEdges < 0 ||
+                     node.firstEdge > header->countEdges - node.countEdges ){
+                    throw Exception ( errorMess );
+                }
+                for ( int j = node.firstEdge; j < node.firstEdge + node.countEdges; ++j ){
+                    if ( edges[j].text < 0 || edges[j].text >= header->poolSize ||
+                         edges[j].target < C_DIALOG_END || edges[j].target >= entry.countNodes ){
+                        throw Exception ( errorMess );
+                    }
+                }
+            }
+            dialog = Dialog ( nodes + entry.firstNode, entry.countNodes, edges, pool );
+            return true;
+        }
+    }
+    return false;
+}
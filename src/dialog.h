@@ -0,0 +1,197 @@
+/** @file dialog.h
+ * Header file of DialogLibrary class.
+ * Header and implementation of Dialog class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef DIALOG_H
+#define DIALOG_H
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+using namespace std;
+#define C_DIALOG_FILE       "examples/dialogs.txt"      // dialogs of NPCs opened by triggers
+#define C_DIALOG_MAGIC      0x44475052                  // "RPGD"
+#define C_DIALOG_VERSION    1
+#define C_DIALOG_END        -1                          // target of choice which ends dialog
+/**
+ * @brief The DialogHeader struct is the beginning of compiled dialogs
+ */
+struct DialogHeader{
+    uint32_t magic;
+    uint32_t version;
+    int32_t countDialogs;
+    int32_t countNodes;
+    int32_t countEdges;
+    int32_t poolSize;
+};
+/**
+ * @brief The DialogEntry struct is dialog of one NPC in directory, sorted by name
+ */
+struct DialogEntry{
+    int32_t name;                   // offset of name in pool
+    int32_t firstNode;              // the first node is the beginning of dialog
+    int32_t countNodes;
+};
+/**
+ * @brief The DialogNode struct is what NPC says
+ */
+struct DialogNode{
+    int32_t text;                   // offset in pool
+    int32_t firstEdge;
+    int32_t countEdges;
+};
+/**
+ * @brief The DialogEdge struct is answer of hero
+ */
+struct DialogEdge{
+    int32_t text;                   // offset in pool
+    int32_t target;                 // node of the same dialog or C_DIALOG_END
+};
+class DialogLibrary;
+/**********************************************************************************************/
+/**
+ * @brief The Dialog class is view of dialog of one NPC in compiled file, it doesn't copy anything
+ */
+class Dialog{
+    public:
+        /**
+         * @brief Dialog is implicit constructor of empty dialog
+         */
+        Dialog() : nodes(NULL), edges(NULL), pool(NULL), countNodes(0) {}
+        /**
+         * @brief Dialog is constructor with parameters
+         * @param nodes are nodes of this dialog
+         * @param countNodes is count of nodes
+         * @param edges are all edges of file
+         * @param pool is string pool of file
+         */
+        Dialog( const DialogNode *nodes, int countNodes, const DialogEdge *edges, const char *pool ) :
+            nodes(nodes), edges(edges), pool(pool), countNodes(countNodes) {}
+        /**
+         * @brief getText is getter of what NPC says in node
+         * @param node is index of node, 0 is the beginning
+         * @return text
+         */
+        const char *getText( int node ) const{
+            return pool + nodes[node].text;
+        }
+        /**
+         * @brief getCountChoices is getter of count of answers of node
+         * @param node is index of node
+         * @return count
+         */
+        int getCountChoices( int node ) const{
+            return nodes[node].countEdges;
+        }
+        /**
+         * @brief getChoice is getter of text of answer
+         * @param node is index of node
+         * @param choice is index of answer
+         * @return text
+         */
+        const char *getChoice( int node, int choice ) const{
+            return pool + edges[ nodes[node].firstEdge + choice ].text;
+        }
+        /**
+         * @brief getTarget is getter of node where answer goes
+         * @param node is index of node
+         * @param choice is index of answer
+         * @return index of node or C_DIALOG_END
+         */
+        int getTarget( int node, int choice ) const{
+            return edges[ nodes[node].firstEdge + choice ].target;
+        }
+        /**
+         * @brief getCountNodes is getter of count of nodes
+         * @return count
+         */
+        int getCountNodes() const{
+            return countNodes;
+        }
+    private:
+        const DialogNode *nodes;
+        const DialogEdge *edges;
+        const char *pool;
+        int countNodes;
+};
+/**********************************************************************************************/
+/**
+ * @brief The DialogLibrary class is compiled file of dialogs of all NPCs
+ * @detailed    Source is text:
+ *                  @npc            begins dialog of NPC, its first node is the beginning
+ *                  #node           begins node, next lines are what NPC says
+ *                  > text -> node  is answer of hero, it goes to node or "end"
+ *              Lines beginning by // are comments. Source is compiled into binary file (.dlg next
+ *              to it) with directory of dialogs, arrays of nodes and edges and one pool of strings,
+ *              where every different string is only once. Compiled file is only mapped to memory,
+ *              so pages of dialogs which aren't talked through are never read. Source is compiled
+ *              again only when it is newer than compiled file. Nothing is done before the first
+ *              dialog is opened.
+ */
+class DialogLibrary{
+    public:
+        /**
+         * @brief open gives library of source, it is compiled and mapped only once in process,
+         *          mapped library is only read, so all threads (shards of server) share it
+         * @param source is name of source file
+         * @return library
+         * @throw exception if dialogs can't be compiled or read
+         */
+        static shared_ptr<DialogLibrary> open( const string &source );
+        /**
+         * @brief compile compiles source into binary file
+         * @param source is name of source file
+         * @param output is name of compiled file
+         * @return header of compiled file (counts)
+         * @throw exception if there is error in source or output can't be written
+         */
+        static DialogHeader compile( const string &source, const string &output );
+        /**
+         * @brief compiledName is name of compiled file of source
+         * @param source is name of source file
+         * @return name with extension .dlg
+         */
+        static string compiledName( const string &source );
+        /**
+         * @brief ~DialogLibrary is destruktor, it unmaps file
+         */
+        ~DialogLibrary();
+        /**
+         * @brief find finds dialog of NPC by binary search in directory
+         * @param npc is name of NPC
+         * @param dialog is output
+         * @return false if NPC doesn't have dialog
+         */
+        bool find( const string &npc, Dialog &dialog ) const;
+        /**
+         * @brief getHeader is getter of counts of compiled file
+         * @return header
+         */
+        const DialogHeader &getHeader() const{
+            return *header;
+        }
+    private:
+        const char *data;
+        size_t size;
+        const DialogHeader *header;
+        const DialogEntry *entries;
+        const DialogNode *nodes;
+        const DialogEdge *edges;
+        const char *pool;
+        static map<string, shared_ptr<DialogLibrary> > libraries;
+        static mutex lock;                      // threads compile and map the same source only once
+        /**
+         * @brief DialogLibrary is constructor with parameters, it maps compiled file and checks it
+         * @param fileName is name of compiled file
+         * @throw exception if file is damaged
+         */
+        DialogLibrary( const string &fileName );
+        DialogLibrary( const DialogLibrary & );
+        DialogLibrary &operator=( const DialogLibrary & );
+};
+/**********************************************************************************************/
+#endif // DIALOG_H
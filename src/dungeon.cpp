@@ -0,0 +1,426 @@
+/** @file dungeon.cpp
+ * Implementation of Dungeon class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dungeon.h"
+#include "savegame.h"
+#include "profiler.h"
+/**********************************************************************************************/
+static atomic<int> countGames ( 0 );            // files of dungeons of one process differ by it
+/**********************************************************************************************/
+Dungeon::Dungeon( const string &fileName, const string &directory ) : current(0), heroPos(-1), directory(directory),
+                                                                       writing(-1), stopping(false), countWaits(0),
+                                                                       countWritten(0){
+    ifstream in ( fileName.c_str() );
+    if ( !in ){
+        throw Exception ( "Dungeon " + fileName + " can't be read\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    string line;
+    int number = 0;
+    vector<pair<string, string> > stairsLines;  // (rest of line, end of error message)
+    while ( getline( in, line ) ){
+        number++;
+        stringstream where;
+        where << " at line " << number << " of " << fileName << "\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+        string errorEnd = where.str();
+        size_t quote1 = line.find_first_of( "\"" );
+        size_t comment = line.find( "//" );
+        if ( quote1 == string::npos || ( comment != string::npos && comment < quote1 ) ){
+            continue;
+        }
+        size_t quote2 = line.find_first_of( "\"", quote1+1 );
+        string kind = ( quote2 == string::npos ) ? "" : line.substr( quote1+1, quote2-quote1-1 );
+        string rest = ( quote2 == string::npos ) ? "" : line.substr( quote2+1, comment == string::npos ? string::npos : comment-quote2-1 );
+        if ( kind == "stairs" ){
+            // levels of stairs can be written after them
+            stairsLines.push_back( make_pair( rest, errorEnd ) );
+            continue;
+        }
+        if ( kind != "level" ){
+            throw Exception ( "Unknown object type" + errorEnd );
+        }
+        stringstream ss ( rest );
+        Level level;
+        string extra;
+        if ( !( ss >> level.name >> level.file ) || ss >> extra ){
+            throw Exception ( "Error in syntax of level" + errorEnd );
+        }
+        for ( int i = 0; i < (int)levels.size(); ++i ){
+            if ( levels[i].name == level.name ){
+                throw Exception ( "Level " + level.name + " is twice" + errorEnd );
+            }
+        }
+        level.enemies = 0;
+        level.stored = false;
+        levels.push_back( level );
+    }
+    if ( levels.empty() ){
+        throw Exception ( "Dungeon " + fileName + " has no level\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    for ( size_t i = 0; i < stairsLines.size(); ++i ){
+        parseStairs( stairsLines[i].first, stairsLines[i].second );
+    }
+    for ( int i = 0; i < (int)levels.size(); ++i ){
+        check( i );
+    }
+    mkdir( directory.c_str(), 0755 );
+    stringstream name;
+    name << directory << "/" << getpid() << "_" << countGames++ << "_";
+    prefix = name.str();
+    worker = thread( &Dungeon::run, this );
+}
+/*********************************************************/
+Dungeon::~Dungeon(){
+    {
+        lock_guard<mutex> guard ( lock );
+        stopping = true;
+    }
+    work.notify_all();
+    if ( worker.joinable() ){
+        worker.join();
+    }
+    for ( int i = 0; i < (int)levels.size(); ++i ){
+        remove( fileOf( i ).c_str() );
+        remove( ( fileOf( i ) + ".tmp" ).c_str() );
+    }
+    rmdir( directory.c_str() );                 // only if other games don't use it
+}
+/*********************************************************/
+shared_ptr<Map> Dungeon::create( shared_ptr<Hero> hero ){
+    shared_ptr<Map> level = make( 0 );
+    shared_ptr<Map> map = enter( level, hero, heroPos );
+    lock_guard<mutex> guard ( lock );
+    current = 0;
+    keep();
+    return map;
+}
+/*********************************************************/
+bool Dungeon::moved( shared_ptr<Map> &map ){
+    unordered_map<int, int>::const_iterator found = levels[current].stairs.find( map->getHeroPos() );
+    if ( found == levels[current].stairs.end() ){
+        return false;
+    }
+    PROFILE_SCOPE( "Dungeon::moved" );
+    const Exit &arrival = exits[ exits[found->second].other ];
+    shared_ptr<Map> level = get( arrival.level );
+    shared_ptr<Hero> hero = map->hero;
+    // level keeps hero's place on stairs, the same hero goes on
+    map->hero = shared_ptr<Hero>( new Hero );
+    levels[current].enemies = map->getCountEnemies();
+    Entry entry = { map, true };
+    map = enter( level, hero, arrival.place );
+    lock_guard<mutex> guard ( lock );
+    cache[current] = entry;
+    current = arrival.level;
+    keep();
+    return true;
+}
+/*********************************************************/
+const string &Dungeon::getLevelName() const{
+    return levels[current].name;
+}
+/*********************************************************/
+int Dungeon::getCountOthers() const{
+    int count = 0;
+    for ( int i = 0; i < (int)levels.size(); ++i ){
+        if ( i != current ){
+            count += levels[i].enemies;
+        }
+    }
+    return count;
+}
+/*********************************************************/
+int Dungeon::getCountLevels() const{
+    return levels.size();
+}
+/*********************************************************/
+int Dungeon::getCountCached(){
+    lock_guard<mutex> guard ( lock );
+    return cache.size() + writes.size();
+}
+/*********************************************************/
+int Dungeon::getCountWaits(){
+    lock_guard<mutex> guard ( lock );
+    return countWaits;
+}
+/*********************************************************/
+int Dungeon::getCountWritten(){
+    lock_guard<mutex> guard ( lock );
+    return countWritten;
+}
+/*********************************************************/
+void Dungeon::parseStairs( const string &line, const string &errorEnd ){
+    string text = line;
+    if ( count( text.begin(), text.end(), '[' ) != 2 || count( text.begin(), text.end(), ']' ) != 2 ){
+        throw Exception ( "Error in syntax of stairs" + errorEnd );
+    }
+    replace( text.begin(), text.end(), '[', ' ' );
+    replace( text.begin(), text.end(), ']', ' ' );
+    replace( text.begin(), text.end(), ',', ' ' );
+    stringstream ss ( text );
+    string names[2], extra;
+    Exit ends[2];
+    if ( !( ss >> names[0] >> ends[0].y >> ends[0].x >> names[1] >> ends[1].y >> ends[1].x ) || ss >> extra ){
+        throw Exception ( "Error in syntax of stairs" + errorEnd );
+    }
+    for ( int i = 0; i < 2; ++i ){
+        ends[i].level = -1;
+        for ( int j = 0; j < (int)levels.size(); ++j ){
+            if ( levels[j].name == names[i] ){
+                ends[i].level = j;
+            }
+        }
+        if ( ends[i].level < 0 ){
+            throw Exception ( "Unknown level " + names[i] + " of stairs" + errorEnd );
+        }
+        ends[i].place = -1;
+        ends[i].other = exits.size() + 1 - i;
+    }
+    if ( ends[0].level == ends[1].level ){
+        throw Exception ( "Stairs have to link two levels" + errorEnd );
+    }
+    exits.push_back( ends[0] );
+    exits.push_back( ends[1] );
+    for ( int i = 0; i < 2; ++i ){
+        vector<int> &near = levels[ ends[i].level ].near;
+        if ( std::find( near.begin(), near.end(), ends[1-i].level ) == near.end() ){
+            near.push_back( ends[1-i].level );
+        }
+    }
+}
+/*********************************************************/
+void Dungeon::check( int level ){
+    PROFILE_SCOPE( "Dungeon::check" );
+    Level &checked = levels[level];
+    string errorEnd = " of level " + checked.name + "\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+    shared_ptr<Map> map = make( level );
+    int width = map->getWidth();
+    int entry = -1;
+    for ( int i = 0; i < (int)exits.size(); ++i ){
+        if ( exits[i].level != level ){
+            continue;
+        }
+        exits[i].place = exits[i].x + exits[i].y * width;
+        if ( !checked.stairs.insert( make_pair( exits[i].place, i ) ).second ){
+            stringstream ss;
+            ss << "There can be only one stairs on place [" << exits[i].y << "," << exits[i].x << "]";
+            throw Exception ( ss.str() + errorEnd );
+        }
+        if ( entry < 0 ){
+            entry = exits[i].place;
+        }
+    }
+    if ( level == 0 ){
+        if ( map->hero == NULL ){
+            throw Exception ( "There has to be hero on map" + errorEnd );
+        }
+        heroPos = entry = map->getHeroPos();
+    }
+    if ( entry < 0 ){
+        throw Exception ( "There are no stairs on map" + errorEnd );
+    }
+    // everything hero has to visit is in region of his entry
+    vector<int> places;
+    for ( unordered_map<int, int>::const_iterator it = checked.stairs.begin(); it != checked.stairs.end(); ++it ){
+        places.push_back( it->first );
+    }
+    Components<Position> &positions = map->getWorld().getPositions();
+    for ( int i = 0; i < positions.getCount(); ++i ){
+        places.push_back( positions.at(i).index );
+    }
+    for ( int i = 0; i < map->spawners.getCount(); ++i ){
+        places.push_back( map->spawners.at(i).place );
+    }
+    for ( int i = 0; i < (int)places.size(); ++i ){
+        if ( !map->isReachable( entry, places[i] ) ){
+            stringstream ss;
+            ss << "Place [" << places[i] / width << "," << places[i] % width << "] can't be reached by hero";
+            throw Exception ( ss.str() + errorEnd );
+        }
+    }
+    checked.enemies = map->getCountEnemies();
+}
+/*********************************************************/
+shared_ptr<Map> Dungeon::make( int level ){
+    PROFILE_SCOPE( "Dungeon::make" );
+    bool stored = false;
+    {
+        lock_guard<mutex> guard ( lock );
+        stored = levels[level].stored;
+    }
+    shared_ptr<Map> map;
+    if ( stored ){
+        SaveGame save ( fileOf( level ) );
+        map = save.createMap();
+    } else {
+        // its hero only marks place of hero of map file
+        map = shared_ptr<Map>( new Map ( levels[level].file, shared_ptr<Hero>( new Hero ) ) );
+    }
+    // saved level doesn't have stairs under hero, they are put again
+    for ( int i = 0; i < (int)exits.size(); ++i ){
+        if ( exits[i].level != level ){
+            continue;
+        }
+        stringstream ss;
+        ss << "Stairs [" << exits[i].y << "," << exits[i].x << "] of level " << levels[level].name;
+        if ( exits[i].y < 0 || exits[i].x < 0 || exits[i].y >= map->getHeight() || exits[i].x >= map->getWidth() ){
+            throw Exception ( ss.str() + " can't be out of map bounds\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+        }
+        int place = exits[i].x + exits[i].y * map->getWidth();
+        if ( !stored && map->getSymbol( place ) != '.' ){
+            throw Exception ( ss.str() + " can't be on same position as another object\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+        }
+        map->createMapObject( STAIRS, place, shared_ptr<Hero>() );
+    }
+    return map;
+}
+/*********************************************************/
+shared_ptr<Map> Dungeon::get( int level ){
+    unique_lock<mutex> guard ( lock );
+    bool isReady = true;
+    while ( true ){
+        unordered_map<int, Entry>::iterator cached = cache.find( level );
+        if ( cached != cache.end() ){
+            shared_ptr<Map> map = cached->second.map;
+            cache.erase( cached );
+            countWaits += !isReady;
+            return map;
+        }
+        unordered_map<int, shared_ptr<Map> >::iterator written = writes.find( level );
+        if ( written != writes.end() ){
+            // its job of worker finds nothing
+            shared_ptr<Map> map = written->second;
+            writes.erase( written );
+            countWaits += !isReady;
+            return map;
+        }
+        isReady = false;
+        if ( pending.count( level ) > 0 ){
+            // level is in queue or worker loads it, queued one is taken away and made here
+            bool isQueued = false;
+            for ( int i = 0; i < (int)queue.size() && !isQueued; ++i ){
+                if ( queue[i].level == level && !queue[i].isWrite ){
+                    queue.erase( queue.begin() + i );
+                    pending.erase( level );
+                    isQueued = true;
+                }
+            }
+            if ( isQueued ){
+                break;
+            }
+        } else if ( writing != level ){
+            break;
+        }
+        ready.wait( guard );
+    }
+    countWaits++;
+    guard.unlock();
+    return make( level );
+}
+/*********************************************************/
+void Dungeon::keep(){
+    for ( unordered_map<int, Entry>::iterator it = cache.begin(); it != cache.end(); ){
+        if ( isNear( it->first ) ){
+            ++it;
+            continue;
+        }
+        if ( it->second.modified ){
+            Job job = { it->first, true };
+            writes[ it->first ] = it->second.map;
+            queue.push_back( job );
+        }
+        it = cache.erase( it );
+    }
+    const vector<int> &near = levels[current].near;
+    for ( int i = 0; i < (int)near.size(); ++i ){
+        if ( cache.count( near[i] ) == 0 && writes.count( near[i] ) == 0 && pending.count( near[i] ) == 0 ){
+            Job job = { near[i], false };
+            queue.push_back( job );
+            pending.insert( near[i] );
+        }
+    }
+    work.notify_one();
+}
+/*********************************************************/
+bool Dungeon::isNear( int level ) const{
+    const vector<int> &near = levels[current].near;
+    return level == current || std::find( near.begin(), near.end(), level ) != near.end();
+}
+/*********************************************************/
+shared_ptr<Map> Dungeon::enter( shared_ptr<Map> level, shared_ptr<Hero> hero, int index ){
+    // level isn't copied, nobody else has it; undo doesn't go back to previous visit of level
+    level->history.clear();
+    int previous = level->heroPos;
+    level->createMapObject( HERO, index, hero );
+    level->updateTile( previous );
+    level->updateTile( index );
+    return level;
+}
+/*********************************************************/
+string Dungeon::fileOf( int level ) const{
+    stringstream name;
+    name << prefix << level << ".sav";
+    return name.str();
+}
+/*********************************************************/
+void Dungeon::run(){
+    unique_lock<mutex> guard ( lock );
+    while ( true ){
+        while ( !stopping && queue.empty() ){
+            work.wait( guard );
+        }
+        if ( stopping ){
+            return;
+        }
+        Job job = queue.front();
+        queue.pop_front();
+        if ( job.isWrite ){
+            unordered_map<int, shared_ptr<Map> >::iterator found = writes.find( job.level );
+            if ( found == writes.end() ){
+                continue;                       // hero came back, level is played again
+            }
+            shared_ptr<Map> map = found->second;
+            writes.erase( found );
+            writing = job.level;
+            guard.unlock();
+            bool isWritten = true;
+            try{
+                SaveGame::save( fileOf( job.level ), *map );
+            } catch ( Exception &exc ){
+                isWritten = false;
+            }
+            guard.lock();
+            writing = -1;
+            if ( isWritten ){
+                levels[job.level].stored = true;
+                countWritten++;
+            } else {
+                Entry entry = { map, true };    // it stays, nothing is lost
+                cache[job.level] = entry;
+            }
+        } else {
+            guard.unlock();
+            shared_ptr<Map> map;
+            try{
+                map = make( job.level );
+            } catch ( Exception &exc ){
+                // get makes it again and shows error
+            }
+            guard.lock();
+            pending.erase( job.level );
+            if ( map != NULL && isNear( job.level ) ){
+                Entry entry = { map, false };
+                cache[job.level] = entry;
+            }
+        }
+        ready.notify_all();
+    }
+}
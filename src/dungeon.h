@@ -0,0 +1,202 @@
+/** @file dungeon.h
+ * Header file of Dungeon class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef DUNGEON_H
+#define DUNGEON_H
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "map.h"
+using namespace std;
+#define C_LEVELS_DIR    "levels"        // directory of visited levels which aren't in memory
+/**********************************************************************************************/
+/**
+ * @brief The Dungeon class is world of several maps (levels) linked by stairs
+ * @detailed    Levels and stairs are read from manifest:
+ *                  "level" NAME MAPFILE
+ *                  "stairs" NAME [y,x] NAME [y,x]
+ *              the first level is where hero begins (its map file needs hero), stairs lead both
+ *              ways and hero comes out on the other end of them. Hero plays on ordinary Map of
+ *              one level; when he steps on stairs, Map of the other level takes him, so history,
+ *              pathfinding and real-time mode work as on any map.
+ *              Only levels linked with the currient one by stairs are kept in memory. Worker thread
+ *              loads them while hero walks, so they are ready before he takes the stairs. Visited
+ *              level which isn't linked anymore is written by SaveGame into C_LEVELS_DIR and read
+ *              from there next time, files of game are removed at its end.
+ */
+class Dungeon{
+    public:
+        /**
+         * @brief Dungeon is constructor with parameters, every level is loaded once to check it
+         * @param fileName is name of manifest
+         * @param directory is directory of visited levels, it is created if it doesn't exist
+         * @throw exception if manifest or some level is wrong
+         */
+        Dungeon( const string &fileName, const string &directory = C_LEVELS_DIR );
+        /**
+         * @brief ~Dungeon is destruktor, worker stops and files of levels are removed
+         */
+        ~Dungeon();
+        /**
+         * @brief create builds map of the first level, levels linked with it are prefetched
+         * @param hero is hero
+         * @return map of the first level
+         */
+        shared_ptr<Map> create( shared_ptr<Hero> hero );
+        /**
+         * @brief moved is called after every step, it takes hero to other level if he is on stairs
+         * @param map is map of currient level, it is replaced by map of other level
+         * @return true if map was replaced
+         * @throw exception if visited level can't be read again
+         */
+        bool moved( shared_ptr<Map> &map );
+        /**
+         * @brief getLevelName is getter of name of currient level
+         * @return name
+         */
+        const string &getLevelName() const;
+        /**
+         * @brief getCountOthers is getter of count of enemies to kill on other levels
+         * @return count
+         */
+        int getCountOthers() const;
+        /**
+         * @brief getCountLevels is getter of count of levels in manifest
+         * @return count
+         */
+        int getCountLevels() const;
+        /**
+         * @brief getCountCached is getter of count of levels in memory besides the currient one
+         * @return count
+         */
+        int getCountCached();
+        /**
+         * @brief getCountWaits is getter of count of stairs, where hero had to wait for level
+         * @return count
+         */
+        int getCountWaits();
+        /**
+         * @brief getCountWritten is getter of count of levels written into directory
+         * @return count
+         */
+        int getCountWritten();
+    private:
+        /**
+         * @brief The Level struct is level of manifest
+         */
+        struct Level{
+            string name;
+            string file;                        // map file
+            int enemies;                        // to kill, it is known when level isn't currient
+            bool stored;                        // it is in directory, with lock
+            unordered_map<int, int> stairs;     // number of Exit of every place with stairs
+            vector<int> near;                   // levels linked by stairs, each of them once
+        };
+        /**
+         * @brief The Exit struct is one end of stairs
+         */
+        struct Exit{
+            int level;
+            int y, x;                           // place from manifest
+            int place;                          // index of place, it is known after level is checked
+            int other;                          // number of Exit on the other end
+        };
+        /**
+         * @brief The Entry struct is level in cache
+         */
+        struct Entry{
+            shared_ptr<Map> map;
+            bool modified;                      // hero played it, it isn't written yet
+        };
+        /**
+         * @brief The Job struct is work of worker thread
+         */
+        struct Job{
+            int level;
+            bool isWrite;                       // level of writes goes to directory, otherwise it is loaded
+        };
+        vector<Level> levels;
+        vector<Exit> exits;
+        int current;                            // level of hero, it changes with lock
+        int heroPos;                            // hero's place on the first level
+        string directory;
+        string prefix;                          // beginning of names of files of this game
+        mutex lock;
+        condition_variable work;                // job came into queue
+        condition_variable ready;               // level came into cache or was written
+        unordered_map<int, Entry> cache;        // loaded levels which nobody plays
+        unordered_map<int, shared_ptr<Map> > writes;    // visited levels waiting for worker
+        deque<Job> queue;
+        unordered_set<int> pending;             // levels in queue or just loaded
+        int writing;                            // level which worker writes, -1 if none
+        thread worker;
+        bool stopping;
+        int countWaits, countWritten;
+        /**
+         * @brief parseStairs reads stairs from line of manifest
+         * @param line is rest of line after "stairs"
+         * @param errorEnd is end of error message
+         * @throw exception if there is error in syntax or level isn't known
+         */
+        void parseStairs( const string &line, const string &errorEnd );
+        /**
+         * @brief check loads level and checks its stairs, without lock
+         * @param level is number of level
+         * @throw exception if stairs aren't on free place or hero can't reach something
+         */
+        void check( int level );
+        /**
+         * @brief make reads level from directory or from its map file and puts stairs on it, without lock
+         * @param level is number of level
+         * @return map of level
+         * @throw exception if file is wrong
+         */
+        shared_ptr<Map> make( int level );
+        /**
+         * @brief get takes level from cache, waits for worker or makes it itself
+         * @param level is number of level
+         * @return map of level, nobody else has it
+         * @throw exception if file is wrong
+         */
+        shared_ptr<Map> get( int level );
+        /**
+         * @brief keep leaves in memory only levels linked with currient level and prefetches the missing ones, with lock
+         */
+        void keep();
+        /**
+         * @brief isNear says if level is currient one or it is linked with it, with lock
+         * @param level is number of level
+         * @return true if level should be in memory
+         */
+        bool isNear( int level ) const;
+        /**
+         * @brief enter gives hero map of level, without copy, its history is forgotten
+         * @param level is map of level from get or make, nobody else has it
+         * @param hero is hero
+         * @param index is place where hero comes
+         * @return map for hero (level)
+         */
+        static shared_ptr<Map> enter( shared_ptr<Map> level, shared_ptr<Hero> hero, int index );
+        /**
+         * @brief fileOf is getter of name of file of level
+         * @param level is number of level
+         * @return path
+         */
+        string fileOf( int level ) const;
+        /**
+         * @brief run is loop of worker thread
+         */
+        void run();
+        Dungeon( const Dungeon & );
+        Dungeon &operator=( const Dungeon & );
+};
+/**********************************************************************************************/
+#endif // DUNGEON_H
@@ -0,0 +1,155 @@
+/** @file feed.cpp
+ * Implementation of Feed class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include "feed.h"
+#include "exception.h"
+/**********************************************************************************************/
+/**
+ * @brief put appends little-endian number
+ * @param out is output
+ * @param value is number
+ * @param bytes is size of number
+ */
+static void put( string &out, uint32_t value, int bytes ){
+    for ( int i = 0; i < bytes; ++i ){
+        out += (char)( ( value >> ( 8 * i ) ) & 0xff );
+    }
+}
+/*********************************************************/
+/**
+ * @brief get reads little-endian number
+ * @param bytes are bytes of number
+ * @param size is size of number
+ * @return number
+ */
+static uint32_t get( const char *bytes, int size ){
+    uint32_t value = 0;
+    for ( int i = 0; i < size; ++i ){
+        value |= (uint32_t)(unsigned char)bytes[i] << ( 8 * i );
+    }
+    return value;
+}
+/*********************************************************/
+/**
+ * @brief isChanged says if place belongs to frame
+ * @param previous is previous screen, NULL for keyframe
+ * @param canvas is currient screen
+ * @param y is row
+ * @param x is column
+ * @return true if place changed, for keyframe if it isn't blank
+ */
+static bool isChanged( const TextCanvas *previous, const TextCanvas &canvas, int y, int x ){
+    if ( previous == NULL ){
+        return canvas.getCell( y, x ) != ' ';
+    }
+    return canvas.getCell( y, x ) != previous->getCell( y, x );
+}
+/*********************************************************/
+shared_ptr<const string> Feed::encode( const TextCanvas *previous, const TextCanvas &canvas, const ScreenData &data, uint32_t number ){
+    shared_ptr<string> frame ( new string );
+    string &out = *frame;
+    int32_t stats[C_FEED_STATS] = { 0, 0, 0, 0, 0, 0 };
+    int cameraX = -1, cameraY = -1;
+    if ( data.type == MAP ){
+        const MapData &mapData = static_cast<const MapData &>( data );
+        Map *map = mapData.getMap();
+        mapData.getCamera( cameraX, cameraY );
+        stats[0] = map->getHeroHealth();
+        stats[1] = map->getHeroDamage();
+        stats[2] = map->getHeroDefence();
+        stats[3] = map->getInventory().getTotal();
+        stats[4] = map->getInventory().getSize();
+        stats[5] = map->getCountEnemies();
+    }
+    out.reserve( C_FEED_HEADER + 64 );
+    put( out, 0, 4 );                           // size is known at the end
+    put( out, previous == NULL ? FRAME_KEY : FRAME_DELTA, 1 );
+    put( out, data.type, 1 );
+    put( out, number, 4 );
+    put( out, cameraX, 4 );
+    put( out, cameraY, 4 );
+    for ( int i = 0; i < C_FEED_STATS; ++i ){
+        put( out, stats[i], 4 );
+    }
+    put( out, 0, 2 );
+    int countRuns = 0;
+    int width = canvas.getWidth();
+    for ( int y = 0; y < canvas.getHeight(); ++y ){
+        int x = 0;
+        while ( x < width ){
+            // keyframe skips blank places, spectator's screen is clean
+            if ( !isChanged( previous, canvas, y, x ) ){
+                x++;
+                continue;
+            }
+            int end = x + 1;
+            // one unchanged place costs less than header of next run
+            while ( end < width && end - x < 255 && ( isChanged( previous, canvas, y, end ) ||
+                    ( end + 1 < width && end + 1 - x < 255 && isChanged( previous, canvas, y, end + 1 ) ) ) ){
+                end++;
+            }
+            put( out, y, 1 );
+            put( out, x, 1 );
+            put( out, end - x, 1 );
+            for ( int i = x; i < end; ++i ){
+                put( out, canvas.getCell( y, i ), 2 );
+            }
+            countRuns++;
+            x = end;
+        }
+    }
+    string size;
+    put( size, out.size(), 4 );
+    out.replace( 0, 4, size );
+    string runs;
+    put( runs, countRuns, 2 );
+    out.replace( C_FEED_HEADER - 2, 2, runs );
+    return frame;
+}
+/*********************************************************/
+bool Feed::readHeader( const char *bytes, size_t length, FrameHeader &header ){
+    if ( length < C_FEED_HEADER ){
+        return false;
+    }
+    header.size = get( bytes, 4 );
+    header.kind = (FrameKind)get( bytes + 4, 1 );
+    header.page = (ScreenDataType)get( bytes + 5, 1 );
+    header.number = get( bytes + 6, 4 );
+    header.cameraX = (int32_t)get( bytes + 10, 4 );
+    header.cameraY = (int32_t)get( bytes + 14, 4 );
+    for ( int i = 0; i < C_FEED_STATS; ++i ){
+        header.stats[i] = (int32_t)get( bytes + 18 + 4 * i, 4 );
+    }
+    header.countRuns = get( bytes + C_FEED_HEADER - 2, 2 );
+    if ( header.size < C_FEED_HEADER || header.kind > FRAME_DELTA ){
+        throw Exception ( "Frame of spectator feed is damaged.\n" );
+    }
+    return length >= header.size;
+}
+/*********************************************************/
+FrameHeader Feed::apply( const char *bytes, TextCanvas &canvas ){
+    FrameHeader header;
+    readHeader( bytes, C_FEED_HEADER, header );
+    if ( header.kind == FRAME_KEY ){
+        canvas.clean();
+    }
+    size_t at = C_FEED_HEADER;
+    for ( int i = 0; i < header.countRuns; ++i ){
+        if ( at + 3 > header.size ){
+            throw Exception ( "Frame of spectator feed is damaged.\n" );
+        }
+        int y = (unsigned char)bytes[at];
+        int x = (unsigned char)bytes[at + 1];
+        int count = (unsigned char)bytes[at + 2];
+        at += 3;
+        if ( at + 2 * count > header.size || y >= canvas.getHeight() || x + count > canvas.getWidth() ){
+            throw Exception ( "Frame of spectator feed is damaged.\n" );
+        }
+        for ( int j = 0; j < count; ++j, at += 2 ){
+            canvas.setCell( y, x + j, get( bytes + at, 2 ) );
+        }
+    }
+    return header;
+}
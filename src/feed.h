@@ -0,0 +1,80 @@
+/** @file feed.h
+ * Header file of Feed class and FrameHeader structure.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef FEED_H
+#define FEED_H
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include "data.h"
+#include "canvas.h"
+using namespace std;
+#define C_FEED_KEYFRAME     60              // every so many frames of session is keyframe
+#define C_FEED_BACKLOG      (256 << 10)     // bytes waiting for one spectator, then he drops to keyframe
+#define C_FEED_HEADER       44              // size of header of frame in bytes
+#define C_FEED_STATS        6               // count of stat counters in frame
+/**********************************************************************************************/
+/**
+ * @brief The FrameKind enum
+ */
+enum FrameKind{ FRAME_KEY,                  // whole screen, spectator cleans his screen first
+                FRAME_DELTA };              // only places changed since previous frame
+/**********************************************************************************************/
+/**
+ * @brief The FrameHeader struct
+ * @detailed    Decoded header of frame. In stream (little-endian) it is:
+ *              u32 size of whole frame, u8 kind, u8 page (ScreenDataType), u32 number of frame,
+ *              i32 camera x, i32 camera y, i32 stats[6], u16 count of runs. Run follows as
+ *              u8 row, u8 column, u8 count of places and 2 bytes for every place: character
+ *              and attribute (color pair, bit 7 is boldness). Camera is -1 and stats are 0
+ *              when page isn't map. Stats are health, damage, defence, carried items, kinds of carried items, enemies.
+ */
+struct FrameHeader{
+    uint32_t size;
+    FrameKind kind;
+    ScreenDataType page;
+    uint32_t number;
+    int32_t cameraX, cameraY;
+    int32_t stats[C_FEED_STATS];
+    uint16_t countRuns;
+};
+/**********************************************************************************************/
+/**
+ * @brief The Feed class
+ * @detailed    Binary frames for spectators. Frame is made once and shared by all spectators
+ *              of session (shared_ptr), nobody copies it. Delta has only runs of changed places,
+ *              so a step on map costs tens of bytes instead of whole screen.
+ */
+class Feed{
+    public:
+        /**
+         * @brief encode makes frame from screen
+         * @param previous is screen of previous frame, NULL for keyframe
+         * @param canvas is currient screen
+         * @param data is data of currient screen, for camera and stats
+         * @param number is number of frame
+         * @return frame
+         */
+        static shared_ptr<const string> encode( const TextCanvas *previous, const TextCanvas &canvas, const ScreenData &data, uint32_t number );
+        /**
+         * @brief readHeader decodes header of frame
+         * @param bytes are bytes of stream
+         * @param length is count of bytes
+         * @param header is output
+         * @return false if there isn't whole frame yet
+         * @throw exception if frame is damaged
+         */
+        static bool readHeader( const char *bytes, size_t length, FrameHeader &header );
+        /**
+         * @brief apply draws whole frame on canvas
+         * @param bytes is frame, readHeader has to succeed for it
+         * @param canvas is spectator's screen
+         * @return header of frame
+         * @throw exception if frame is damaged
+         */
+        static FrameHeader apply( const char *bytes, TextCanvas &canvas );
+};
+/**********************************************************************************************/
+#endif // FEED_H
@@ -4,6 +4,8 @@
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
  */
 #include "game.h"
+#include "profiler.h"
+#include "alloctracker.h"
 /**********************************************************************************************/
 Game::Game ( int argc, char **argv ){
     //don't need to add argv[0], because first argument is run file
@@ -24,6 +26,11 @@ Game::Game ( int argc, char **argv ){
     questFile.close();
     mainMenu = NULL;
     createHero = NULL;
+    saving = true;
+    realTime = false;
+    world = false;
+    worldSeed = 0;
+    dungeon = false;
     currentCondition = MAINMENU;
     currentPart = getGamePart ( currentCondition );
 }
@@ -33,6 +40,8 @@ shared_ptr<ScreenData> Game::start(){
 }
 /*********************************************************/
 shared_ptr<ScreenData> Game::handleKey( const int &ch ){
+    PROFILE_SCOPE( "Game::handleKey" );
+    ALLOC_SCOPE( "Game::handleKey" );
     GameCondition condition = currentCondition;
     try{
         condition  = currentPart->handleKey(ch);
@@ -47,7 +56,15 @@ shared_ptr<ScreenData> Game::handleKey( const int &ch ){
     return currentPart->getScreenData();
 }
 /*********************************************************/
+shared_ptr<ScreenData> Game::update(){
+    if ( !currentPart->update() ){
+        return shared_ptr<ScreenData>();
+    }
+    return currentPart->getScreenData();
+}
+/*********************************************************/
 shared_ptr<GamePart> Game::getGamePart( const GameCondition &condition){
+    ALLOC_SCOPE( "Game::getGamePart" );
     if ( condition == MAINMENU ){
         if ( mainMenu == NULL ){
             mainMenu = shared_ptr<MainMenu>( new MainMenu() );
@@ -68,12 +85,29 @@ shared_ptr<GamePart> Game::getGamePart( const GameCondition &condition){
     }
     if ( condition == GAMECHUCK ){
         shared_ptr<ChuckPart> cp ( new ChuckPart ( arguments ) );
+        cp->setSaving( saving );
+        cp->setRealTime( realTime );
+        cp->setWorld( world, worldSeed );
+        cp->setDungeon( dungeon );
         return cp;
     }
     if ( condition == GAMEHERO ){
         shared_ptr<HeroPart> hp ( new HeroPart ( arguments, createHero->getSkills()) );
+        hp->setSaving( saving );
+        hp->setRealTime( realTime );
+        hp->setWorld( world, worldSeed );
+        hp->setDungeon( dungeon );
         return hp;
     }
+    if ( condition == LOADGAME ){
+        if ( saving == false ){
+            shared_ptr<ErrorPart> noSaves ( new ErrorPart ( "Saved games aren't available here.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" ) );
+            return noSaves;
+        }
+        shared_ptr<LoadPart> lp ( new LoadPart ( arguments ) );
+        lp->setRealTime( realTime );
+        return lp;
+    }
     if ( condition == EXIT ){
         shared_ptr<ExitPart> ex ( new ExitPart );
         return ex;
@@ -86,3 +120,20 @@ bool Game::gameStopped(){
     return ( currentCondition == EXIT );
 }
 /*********************************************************/
+void Game::setSaving( bool isOn ){
+    saving = isOn;
+}
+/*********************************************************/
+/*********************************************************/
+void Game::setRealTime( bool isOn ){
+    realTime = isOn;
+}
+/*********************************************************/
+void Game::setWorld( bool isOn, uint64_t seed ){
+    world = isOn;
+    worldSeed = seed;
+}
+/*********************************************************/
+void Game::setDungeon( bool isOn ){
+    dungeon = isOn;
+}
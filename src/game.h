@@ -53,18 +53,49 @@ class Game{
      * @return one of possible data to show on screen
      */
     shared_ptr<ScreenData> handleKey(const int &ch );
+    /**
+     * @brief update lets currient Game Part go on without key (real-time mode)
+     * @return screen data to show, NULL if nothing changed
+     */
+    shared_ptr<ScreenData> update();
     /**
      * @brief getGamePart is calling from handleKey to get currient Game Part by condition
      * @param condition is for choosing necessary Game Part
      * @return Part of the Game by condition
      */
     shared_ptr<GamePart> getGamePart( const GameCondition &condition);
+    /**
+     * @brief setSaving turns saving and loading of games on or off (server doesn't save games)
+     * @param isOn is true if games can be saved
+     */
+    void setSaving( bool isOn );
+    /**
+     * @brief setRealTime turns real-time mode of next games on or off
+     * @param isOn is true if world goes on without keys
+     */
+    void setRealTime( bool isOn );
+    /**
+     * @brief setWorld turns procedural world of next games on or off, map file is used only without it
+     * @param isOn is true for procedural world
+     * @param seed is seed of world
+     */
+    void setWorld( bool isOn, uint64_t seed );
+    /**
+     * @brief setDungeon turns dungeon of next games on or off, map file is its manifest then
+     * @param isOn is true for dungeon
+     */
+    void setDungeon( bool isOn );
   private:
     GameCondition currentCondition;
     shared_ptr<MainMenu> mainMenu;
     shared_ptr<CreateHeroPart> createHero;
     shared_ptr<GamePart> currentPart;
     vector<string> arguments;
+    bool saving;
+    bool realTime;
+    bool world;
+    uint64_t worldSeed;
+    bool dungeon;
 };
 /**********************************************************************************************/
 #endif // GAME_H
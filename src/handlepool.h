@@ -0,0 +1,172 @@
+/** @file handlepool.h
+ * Header file and implementation of Handle struct and HandlePool class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef HANDLEPOOL_H
+#define HANDLEPOOL_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+#define C_HANDLE_NONE       0xffffffffu     // index of handle which doesn't point anywhere
+/**********************************************************************************************/
+/**
+ * @brief The Handle struct is reference to object in HandlePool
+ * @detailed    Index is slot in pool, generation is counter of reuses of slot. Handle of destroyed
+ *              object is stale: its slot has another generation, so it can't reach the new object.
+ */
+struct Handle{
+    uint32_t index;
+    uint32_t generation;
+    /**
+     * @brief Handle is implicit constructor, handle points nowhere
+     */
+    Handle() : index(C_HANDLE_NONE), generation(0) {}
+    /**
+     * @brief Handle is constructor with parameters
+     * @param index is slot in pool
+     * @param generation is generation of slot
+     */
+    Handle( uint32_t index, uint32_t generation ) : index(index), generation(generation) {}
+    /**
+     * @brief isNone says if handle points nowhere
+     * @return true for empty handle
+     */
+    bool isNone() const{
+        return index == C_HANDLE_NONE;
+    }
+    /**
+     * @brief pack puts handle into one number (DeltaLog keeps it as value before change)
+     * @return packed handle
+     */
+    long long pack() const{
+        return (long long)( ( (uint64_t)generation << 32 ) | index );
+    }
+    /**
+     * @brief unpack makes handle from number made by pack
+     * @param packed is packed handle
+     * @return handle
+     */
+    static Handle unpack( long long packed ){
+        return Handle ( (uint32_t)( (uint64_t)packed & 0xffffffffu ), (uint32_t)( (uint64_t)packed >> 32 ) );
+    }
+    bool operator==( const Handle &other ) const{
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=( const Handle &other ) const{
+        return !( *this == other );
+    }
+};
+/**********************************************************************************************/
+/**
+ * @brief The HandlePool class
+ * @detailed    Objects of one type in one vector, they are reached by Handle instead of pointer,
+ *              so nothing counts references. Destroyed slots are reused, generation of slot
+ *              grows at every destroy, so stale handle is found instead of using wrong object.
+ *              Pointer from get is valid only until next create (vector can move).
+ */
+template <class T>
+class HandlePool{
+    public:
+        /**
+         * @brief HandlePool is implicit constructor
+         */
+        HandlePool() : countLive(0) {}
+        /**
+         * @brief create puts copy of object into pool
+         * @param value is object
+         * @return handle of new object
+         */
+        Handle create( const T &value ){
+            uint32_t index;
+            if ( !freeSlots.empty() ){
+                index = freeSlots.back();
+                freeSlots.pop_back();
+                slots[index].value = value;
+            } else {
+                index = slots.size();
+                Slot slot = { value, 1, false };
+                slots.push_back( slot );
+            }
+            slots[index].live = true;
+            countLive++;
+            return Handle ( index, slots[index].generation );
+        }
+        /**
+         * @brief destroy frees slot of object, all its handles become stale
+         * @param handle is handle of object
+         * @return false if handle was already stale
+         */
+        bool destroy( Handle handle ){
+            if ( !isValid( handle ) ){
+                return false;
+            }
+            Slot &slot = slots[ handle.index ];
+            slot.live = false;
+            slot.generation++;
+            freeSlots.push_back( handle.index );
+            countLive--;
+            return true;
+        }
+        /**
+         * @brief isValid says if handle points at living object
+         * @param handle is handle
+         * @return false for empty or stale handle
+         */
+        bool isValid( Handle handle ) const{
+            return handle.index < slots.size() && slots[ handle.index ].live && slots[ handle.index ].generation == handle.generation;
+        }
+        /**
+         * @brief get finds object of handle
+         * @param handle is handle
+         * @return object, NULL for empty or stale handle
+         */
+        T *get( Handle handle ){
+            return isValid( handle ) ? &slots[ handle.index ].value : NULL;
+        }
+        /**
+         * @brief get finds object of handle
+         * @param handle is handle
+         * @return object, NULL for empty or stale handle
+         */
+        const T *get( Handle handle ) const{
+            return isValid( handle ) ? &slots[ handle.index ].value : NULL;
+        }
+        /**
+         * @brief getHandle makes handle of slot with its current generation
+         * @param index is slot in pool
+         * @return handle, it is stale if slot isn't living
+         */
+        Handle getHandle( uint32_t index ) const{
+            return Handle ( index, index < slots.size() ? slots[index].generation : 0 );
+        }
+        /**
+         * @brief getCount is getter of count of living objects
+         * @return count
+         */
+        int getCount() const{
+            return countLive;
+        }
+        /**
+         * @brief getMemory is getter of memory used by pool
+         * @return size in bytes
+         */
+        size_t getMemory() const{
+            return slots.capacity() * sizeof(Slot) + freeSlots.capacity() * sizeof(uint32_t);
+        }
+    private:
+        /**
+         * @brief The Slot struct is place of one object
+         */
+        struct Slot{
+            T value;
+            uint32_t generation;
+            bool live;
+        };
+        vector<Slot> slots;
+        vector<uint32_t> freeSlots;
+        int countLive;
+};
+/**********************************************************************************************/
+#endif // HANDLEPOOL_H
@@ -4,72 +4,71 @@
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
  */
 #include "hero.h"
+#include "map.h"
+#include "profiler.h"
+#include "alloctracker.h"
+#include "runtimestats.h"
+#include "world.h"
 /**********************************************************************************************/
 Hero::Hero(){
     direction = 0;
-    whisky = 0;
-    sword = 0;
+    history = NULL;
 }
 /*********************************************************/
 Hero::Hero( const string &name, const int &health, const int &damage, const int &defence ){
     this->name = name;
-    this->health = health;
-    this->damage = damage;
-    this->defence = defence;
+    stats.health = health;
+    stats.damage = damage;
+    stats.defence = defence;
     direction = 0;
-    whisky = 0;
-    sword = 0;
+    history = NULL;
 }
-bool Hero::collide(shared_ptr<MapElement> elem, vector<shared_ptr<MapElement> > *map, int to){
-    if( elem->getSymbol() == '.' ){
-        return true;
-    }
-    if (  dynamic_cast<Sword*>(elem.get()) ){
-        map->at(to) = shared_ptr<MapElement>(new MapElement);
-        sword++;
-        return true;
+/*********************************************************/
+bool Hero::collide( Map &map, int to ){
+    PROFILE_SCOPE( "Hero::collide" );
+    ALLOC_SCOPE( "Hero::collide" );
+    Stats enemy;
+    if ( map.getEnemyStats( to, enemy ) ){
+        long long begin = RuntimeStats::nanos();
+        CombatResult result = CombatSystem::fight( stats, enemy, map.getRandom() );
+        if ( result.enemyHealth < 0 && result.heroHealth > 0 ) {
+            map.killEnemy( to );
+        }
+        change( DELTA_HEALTH, stats.health, result.heroHealth );
+        if ( result.heroHealth > 0 ){
+            change( DELTA_DEFENCE, stats.defence, stats.defence + enemy.damage / 5 );
+        }
+        RuntimeStats::addCombat( result.rounds, RuntimeStats::nanos() - begin, result.heroHealth > 0 );
+        return false;
     }
-    if ( dynamic_cast<Thorn*>(elem.get()) ){
-        map->at(to) = shared_ptr<MapElement>(new MapElement);
-        health -= 20;
+    int item = map.getTile( to ).getItem();
+    if ( item >= 0 ){
+        // with full stack hero goes over item, it stays on map
+        if ( pickUp( item ) ){
+            map.setTile( to, EMPTY );
+            map.fire( TRIGGER_PICKUP, to );
+        }
         return true;
     }
-    if ( dynamic_cast<Whisky*>(elem.get()) ){
-        map->at(to) = shared_ptr<MapElement>(new MapElement);
-        whisky++;
-        return true;
+    switch ( map.getTile( to ).getSymbol() ){
+        case '.':
+        case '%':
+            return true;
+        case '!':
+            map.setTile( to, EMPTY );
+            change( DELTA_HEALTH, stats.health, stats.health - 20 );
+            return true;
     }
-    if ( Enemy *en = dynamic_cast<Enemy*>(elem.get()) ){       //damage +  random - defence
-        int heroHlth = getHealth();
-        int heroDmg = getDamage();
-        int heroDfc = getDefence();
-        int enHlth = en->getHealth();
-        int enDmg = en->getDamage();
-        int enDfc = en->getDefence();
-        int heroFight = 0, enemyFigth = 0;
-        srand (time(NULL));
-        while ( heroHlth > 0 && enHlth > 0 ){
-            enemyFigth = enDmg + 2*( rand() % enDmg ) - heroDfc;
-            if ( enemyFigth < 0 ) {
-                enemyFigth = MIN_DAMAGE;
-            }
-            heroHlth -= enemyFigth;
-            heroFight = heroDmg + ( rand() % heroDmg ) - enDfc;
-            if ( heroFight < 0 ) {
-                heroFight = MIN_DAMAGE - 10;
-            }
-            enHlth -= heroFight;
-        }
-        if ( enHlth < 0 && heroHlth > 0) {
-            map->at(to) = shared_ptr<MapElement>(new MapElement);
-        }
-        health = heroHlth;
-        if ( heroHlth > 0 ){
-            defence += en->getDamage() / 5 ;
-        }
+    return false;
+}
+/*********************************************************/
+bool Hero::isBlocked( const Map &map, int to ) const{
+    Stats enemy;
+    if ( map.getEnemyStats( to, enemy ) || map.getTile( to ).getItem() >= 0 ){
         return false;
     }
-    return false;
+    char symbol = map.getTile( to ).getSymbol();
+    return symbol != '.' && symbol != '%' && symbol != '!';
 }
 /*********************************************************/
 char Hero::getSymbol() const{
@@ -94,24 +93,78 @@ void Hero::setDirection( int dir){
     direction = dir;
 }
 /*********************************************************/
-int Hero::getConutWhisky(){
-    return whisky;
+int Hero::getDirection() const{
+    return direction;
+}
+/*********************************************************/
+const Inventory &Hero::getInventory() const{
+    return inventory;
 }
 /*********************************************************/
-int Hero::getCountSword(){
-    return sword;
+int Hero::useItem( int slot ){
+    if ( slot < 0 || slot >= inventory.getSize() ){
+        return -1;
+    }
+    const ItemStack &stack = inventory.at( slot );
+    int item = stack.item;
+    const ItemType &type = ItemRegistry::get().getType( item );
+    changeItem( item, stack.count - 1 );
+    changeSkill( (DeltaType)type.skill, type.value );
+    return item;
+}
+/*********************************************************/
+bool Hero::pickUp( int item ){
+    int count = inventory.getCount( item );
+    if ( count >= ItemRegistry::get().getType( item ).stack ){
+        return false;
+    }
+    changeItem( item, count + 1 );
+    return true;
+}
+/*********************************************************/
+void Hero::changeSkill( DeltaType type, int diff ){
+    switch ( type ){
+        case DELTA_HEALTH:  change( type, stats.health, stats.health + diff );          return;
+        case DELTA_DAMAGE:  change( type, stats.damage, stats.damage + diff );          return;
+        case DELTA_DEFENCE: change( type, stats.defence, stats.defence + diff );        return;
+        default:            return;
+    }
+}
+/*********************************************************/
+void Hero::setSkills( int health, int damage, int defence ){
+    stats.health = health;
+    stats.damage = damage;
+    stats.defence = defence;
+}
+/*********************************************************/
+void Hero::setItem( int item, int count ){
+    inventory.set( item, count );
+}
+/*********************************************************/
+void Hero::setHistory( DeltaLog *log ){
+    history = log;
+}
+/*********************************************************/
+void Hero::restore( DeltaType type, int index, int value ){
+    switch ( type ){
+        case DELTA_HEALTH:  stats.health = value;               return;
+        case DELTA_DAMAGE:  stats.damage = value;               return;
+        case DELTA_DEFENCE: stats.defence = value;              return;
+        case DELTA_ITEM:    inventory.set( index, value );      return;
+        default:            return;
+    }
 }
 /*********************************************************/
-void Hero::useWhisky (){
-    if ( whisky > 0 ){
-        whisky--;
-        Entity::health += 50;
+void Hero::change( DeltaType type, int &field, int value ){
+    if ( history != NULL ){
+        history->push( type, 0, field );
     }
+    field = value;
 }
 /*********************************************************/
-void Hero::useSword(){
-    if ( sword > 0 ){
-        sword--;
-        damage += 20;
+void Hero::changeItem( int item, int count ){
+    if ( history != NULL ){
+        history->push( DELTA_ITEM, item, inventory.getCount( item ) );
     }
+    inventory.set( item, count );
 }
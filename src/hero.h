@@ -9,7 +9,9 @@
 #include <cstdlib>
 #include <time.h>
 #include "mapelement.h"
-#define MIN_DAMAGE 20
+#include "deltalog.h"
+#include "items.h"
+class Map;
 /**********************************************************************************************/
 /**
  * @brief The Hero class is descendant class of Entity
@@ -38,12 +40,19 @@ class Hero : public Entity{
         virtual ~Hero(){}
         /**
          * @brief collide is behaviour hero when he collides some other object on game map
-         * @param elem is object on map
+         * @detailed all changes of map go through Map, so they are written into its history
          * @param map is game map
          * @param to is position where hero goes
          * @return true or false, if hero can or cannot move on this position
          */
-        bool collide(shared_ptr<MapElement> elem, vector<shared_ptr<MapElement> > *map, int to);
+        bool collide( Map &map, int to );
+        /**
+         * @brief isBlocked says if hero only bumps into place, collide with it wouldn't change anything
+         * @param map is game map
+         * @param to is position where hero goes
+         * @return true for barrier and other places without enemy, item or free ground
+         */
+        bool isBlocked( const Map &map, int to ) const;
         /**
          * @brief getSymbol is getter for symbol of objects on map
          * @return symbol
@@ -60,29 +69,78 @@ class Hero : public Entity{
          */
         void setDirection( int dir);
         /**
-         * @brief getConutWhisky
-         * @return count of whisky hero has
+         * @brief getDirection is getter for hero direction on map
+         * @return last direction key
+         */
+        int getDirection() const;
+        /**
+         * @brief getInventory is getter of items hero carries
+         * @return inventory
          */
-        int getConutWhisky();
+        const Inventory &getInventory() const;
         /**
-         * @brief getCountSword
-         * @return count of sword hero has
+         * @brief useItem uses one item of inventory, its type changes skill of hero
+         * @param slot is index of stack in inventory
+         * @return id of used item type or -1 if there isn't such stack
          */
-        int getCountSword();
+        int useItem( int slot );
         /**
-         * @brief useWhisky is method for drinking whisky (adding health skill)
+         * @brief pickUp puts item into inventory if its stack isn't full
+         * @param item is id of item type
+         * @return false if hero can't carry more items of the type
          */
-        void useWhisky ();
+        bool pickUp( int item );
         /**
-         * @brief useSword is method for equipping sword (adding damage skill)
+         * @brief changeSkill adds difference to skill or inventory, it is written into history
+         * @detailed    used by events of real-time mode (enemy's hit, poison, effect of whisky)
+         * @param type is type of change (DELTA_HEALTH, DELTA_DAMAGE or DELTA_DEFENCE)
+         * @param diff is difference to add
+         */
+        void changeSkill( DeltaType type, int diff );
+        /**
+         * @brief setSkills is setter for all hero's skills (loading of saved game)
+         * @param health
+         * @param damage
+         * @param defence
          */
-        void useSword();
+        void setSkills( int health, int damage, int defence );
+        /**
+         * @brief setItem is setter for count of items of type in inventory (loading of saved game)
+         * @param item is id of item type
+         * @param count is count
+         */
+        void setItem( int item, int count );
+        /**
+         * @brief setHistory is setter for log, where all changes of hero are written
+         * @param log is history of map or NULL
+         */
+        void setHistory( DeltaLog *log );
+        /**
+         * @brief restore sets skill or inventory back to value from history, it isn't written into history
+         * @param type is type of change (DELTA_HEALTH, DELTA_DAMAGE, DELTA_DEFENCE or DELTA_ITEM)
+         * @param index is id of item type for DELTA_ITEM
+         * @param value is value to set
+         */
+        void restore( DeltaType type, int index, int value );
     protected:
         string name;
     private:
         int direction;
-        int whisky;
-        int sword;
+        Inventory inventory;
+        DeltaLog *history;
+        /**
+         * @brief change sets new value of skill and writes old one into history
+         * @param type is type of change
+         * @param field is skill to change
+         * @param value is new value
+         */
+        void change( DeltaType type, int &field, int value );
+        /**
+         * @brief changeItem sets new count of items of type and writes old one into history
+         * @param item is id of item type
+         * @param count is new count
+         */
+        void changeItem( int item, int count );
 };
 /**********************************************************************************************/
 /**
@@ -94,9 +152,9 @@ class Chuck : public Hero{
          * @brief Chuck is implicit constructor, it sets base skills for Chuck the hero
          */
         Chuck(){
-            health = 10000;
-            damage = 10000;
-            defence = 10000;
+            stats.health = 10000;
+            stats.damage = 10000;
+            stats.defence = 10000;
             name = "Chuck Norris";
         }
 };
@@ -0,0 +1,302 @@
+/** @file items.cpp
+ * Implementation of ItemRegistry class, LootTable class and Inventory class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "items.h"
+#include "exception.h"
+/**********************************************************************************************/
+/**
+ * @brief mix scatters bits of number (finalizer of splitmix64)
+ * @param x is number
+ * @return mixed number
+ */
+static uint64_t mix( uint64_t x ){
+    x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBULL;
+    return x ^ ( x >> 31 );
+}
+/**********************************************************************************************/
+const ItemRegistry &ItemRegistry::get(){
+    static const ItemRegistry registry ( C_ITEMS_FILE );
+    return registry;
+}
+/*********************************************************/
+ItemRegistry::ItemRegistry( const string &fileName ) : mask(0){
+    memset( symbols, 0, sizeof(symbols) );
+    ifstream in ( fileName.c_str() );
+    if ( !in ){
+        // without it items of maps would be reported as unknown objects
+        throw Exception ( "Items " + fileName + " can't be read, game has to be run from its directory\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    string line;
+    int number = 0;
+    set<string> names;
+    vector<pair<string, string> > lootLines;    // (rest of line, end of error message)
+    while ( getline( in, line ) ){
+        number++;
+        stringstream where;
+        where << " at line " << number << " of " << fileName << "\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+        string errorEnd = where.str();
+        size_t quote1 = line.find_first_of( "\"" );
+        size_t comment = line.find( "//" );
+        if ( quote1 == string::npos || ( comment != string::npos && comment < quote1 ) ){
+            continue;
+        }
+        size_t quote2 = line.find_first_of( "\"", quote1+1 );
+        string kind = ( quote2 == string::npos ) ? "" : line.substr( quote1+1, quote2-quote1-1 );
+        string rest = ( quote2 == string::npos ) ? "" : line.substr( quote2+1, comment == string::npos ? string::npos : comment-quote2-1 );
+        if ( kind == "loot" ){
+            // items of table are known only after all lines
+            lootLines.push_back( make_pair( rest, errorEnd ) );
+            continue;
+        }
+        if ( kind != "item" ){
+            throw Exception ( "Unknown object type" + errorEnd );
+        }
+        stringstream ss ( rest );
+        ItemType type;
+        string symbol, skill;
+        if ( !( ss >> type.name >> symbol >> skill >> type.value >> type.stack ) || symbol.size() != 3 ||
+             symbol[0] != '\'' || symbol[2] != '\'' ){
+            throw Exception ( "Error in syntax of item" + errorEnd );
+        }
+        type.symbol = symbol[1];
+        if ( skill == "health" ){
+            type.skill = DELTA_HEALTH;
+        } else if ( skill == "damage" ){
+            type.skill = DELTA_DAMAGE;
+        } else if ( skill == "defence" ){
+            type.skill = DELTA_DEFENCE;
+        } else {
+            throw Exception ( "Unknown skill of item" + errorEnd );
+        }
+        if ( !names.insert( type.name ).second ){
+            throw Exception ( "Item " + type.name + " is twice" + errorEnd );
+        }
+        add( type, errorEnd );
+    }
+    build();
+    for ( size_t i = 0; i < lootLines.size(); ++i ){
+        parseLoot( lootLines[i].first, lootLines[i].second );
+    }
+}
+/*********************************************************/
+int ItemRegistry::find( const string &name ) const{
+    if ( slots.empty() ){
+        return -1;
+    }
+    uint64_t hash = hashOf( name );
+    int item = slots[ slotOf( hash, displacements[ ( hash >> 32 ) % displacements.size() ] ) ];
+    return ( item >= 0 && types[item].name == name ) ? item : -1;
+}
+/*********************************************************/
+int ItemRegistry::findLoot( const string &name ) const{
+    for ( int i = 0; i < (int)loots.size(); ++i ){
+        if ( loots[i].getName() == name ){
+            return i;
+        }
+    }
+    return -1;
+}
+/*********************************************************/
+void ItemRegistry::add( const ItemType &type, const string &errorEnd ){
+    // symbols of other objects and of hero can't be used
+    if ( strchr( ".#!%ev^<> ", type.symbol ) != NULL || type.symbol <= ' ' ){
+        throw Exception ( "Symbol of item can't be '" + string ( 1, type.symbol ) + "'" + errorEnd );
+    }
+    if ( type.name == "hero" || type.name == "enemy" || type.name == "barrier" || type.name == "thorn" || type.name == "trigger" ||
+         type.name == "nothing" ){
+        throw Exception ( "Item can't be named " + type.name + errorEnd );
+    }
+    if ( type.stack <= 0 ){
+        throw Exception ( "Stack of item has to be > 0" + errorEnd );
+    }
+    if ( (int)types.size() >= C_ITEMS_MAX ){
+        throw Exception ( "There can't be more items" + errorEnd );
+    }
+    types.push_back( type );
+    symbols[ (unsigned char)type.symbol ] = true;
+}
+/*********************************************************/
+void ItemRegistry::build(){
+    tiles.clear();
+    for ( int i = 0; i < (int)types.size(); ++i ){
+        tiles.push_back( Item ( i, types[i].symbol ) );
+    }
+    if ( types.empty() ){
+        return;
+    }
+    vector<uint64_t> hashes;
+    for ( int i = 0; i < (int)types.size(); ++i ){
+        hashes.push_back( hashOf( types[i].name ) );
+    }
+    // about four names in bucket, every slot is used at most once
+    size_t countSlots = 1;
+    while ( countSlots < types.size() ){
+        countSlots *= 2;
+    }
+    size_t countBuckets = ( types.size() + 3 ) / 4;
+    for ( bool done = false; !done; countSlots *= 2 ){
+        mask = countSlots - 1;
+        slots.assign( countSlots, -1 );
+        displacements.assign( countBuckets, 0 );
+        vector<vector<int> > buckets ( countBuckets );
+        for ( int i = 0; i < (int)hashes.size(); ++i ){
+            buckets[ ( hashes[i] >> 32 ) % countBuckets ].push_back( i );
+        }
+        // the biggest buckets are placed first, while there are many free slots; pairs are (-size, bucket)
+        vector<pair<int, size_t> > order;
+        for ( size_t b = 0; b < countBuckets; ++b ){
+            order.push_back( make_pair( -(int)buckets[b].size(), b ) );
+        }
+        sort( order.begin(), order.end() );
+        done = true;
+        for ( size_t b = 0; b < countBuckets && done; ++b ){
+            const vector<int> &bucket = buckets[ order[b].second ];
+            if ( bucket.empty() ){
+                break;
+            }
+            uint32_t displacement = 0;
+            for ( ; displacement < ( 1u << 20 ); ++displacement ){
+                vector<uint64_t> taken;
+                bool isFree = true;
+                for ( int i = 0; i < (int)bucket.size() && isFree; ++i ){
+                    uint64_t slot = slotOf( hashes[ bucket[i] ], displacement );
+                    isFree = slots[slot] < 0 && std::find( taken.begin(), taken.end(), slot ) == taken.end();
+                    taken.push_back( slot );
+                }
+                if ( isFree ){
+                    for ( int i = 0; i < (int)bucket.size(); ++i ){
+                        slots[ taken[i] ] = bucket[i];
+                    }
+                    displacements[ order[b].second ] = displacement;
+                    break;
+                }
+            }
+            done = ( displacement < ( 1u << 20 ) );
+        }
+        if ( done ){
+            break;
+        }
+        if ( countSlots > 64 * types.size() ){
+            throw Exception ( "Names of items can't be hashed.\n" );
+        }
+    }
+}
+/*********************************************************/
+void ItemRegistry::parseLoot( const string &line, const string &errorEnd ){
+    stringstream ss ( line );
+    string name, item;
+    vector<int> items, weights;
+    if ( !( ss >> name ) ){
+        throw Exception ( "Error in syntax of loot" + errorEnd );
+    }
+    if ( findLoot( name ) >= 0 ){
+        throw Exception ( "Loot " + name + " is twice" + errorEnd );
+    }
+    while ( ss >> item ){
+        int weight = 0;
+        if ( !( ss >> weight ) || weight <= 0 || weight > C_LOOT_WEIGHT ){
+            throw Exception ( "Weight of drop has to be from 1 to 1000000" + errorEnd );
+        }
+        int id = ( item == "nothing" ) ? -1 : find( item );
+        if ( id < 0 && item != "nothing" ){
+            throw Exception ( "Unknown item " + item + " of loot" + errorEnd );
+        }
+        if ( (int)items.size() >= C_ITEMS_MAX ){
+            throw Exception ( "There can't be more drops" + errorEnd );
+        }
+        items.push_back( id );
+        weights.push_back( weight );
+    }
+    if ( !ss.eof() || items.empty() ){
+        throw Exception ( "Error in syntax of loot" + errorEnd );
+    }
+    loots.push_back( LootTable ( name, items, weights ) );
+}
+/*********************************************************/
+uint64_t ItemRegistry::hashOf( const string &name ){
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for ( size_t i = 0; i < name.size(); ++i ){
+        hash = ( hash ^ (unsigned char)name[i] ) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+/*********************************************************/
+uint64_t ItemRegistry::slotOf( uint64_t hash, uint32_t displacement ) const{
+    return mix( hash ^ ( displacement * 0x9E3779B97F4A7C15ULL ) ) & mask;
+}
+/**********************************************************************************************/
+LootTable::LootTable( const string &name, const vector<int> &items, const vector<int> &weights )
+                    : name(name), items(items), probabilities(items.size(), C_LOOT_SCALE), aliases(items){
+    // column is full at total weight, weights are scaled by count of columns
+    long long total = 0;
+    for ( size_t i = 0; i < weights.size(); ++i ){
+        total += weights[i];
+    }
+    vector<long long> scaled;
+    vector<int> small, large;
+    for ( size_t i = 0; i < weights.size(); ++i ){
+        scaled.push_back( (long long)weights[i] * weights.size() );
+        if ( scaled[i] < total ){
+            small.push_back( i );
+        } else {
+            large.push_back( i );
+        }
+    }
+    // every small column is filled up by some large one, which can become small
+    while ( !small.empty() && !large.empty() ){
+        int less = small.back();
+        int more = large.back();
+        small.pop_back();
+        probabilities[less] = scaled[less] * C_LOOT_SCALE / total;
+        aliases[less] = items[more];
+        scaled[more] -= total - scaled[less];
+        if ( scaled[more] < total ){
+            large.pop_back();
+            small.push_back( more );
+        }
+    }
+    // columns left in any list are full, they differ from it only by rounding
+}
+/**********************************************************************************************/
+void Inventory::set( int item, int count ){
+    int slot = 0;
+    while ( slot < size && stackAt(slot).item < item ){
+        slot++;
+    }
+    bool isFound = ( slot < size && stackAt(slot).item == item );
+    if ( isFound && count > 0 ){
+        stackAt(slot).count = count;
+    } else if ( isFound ){
+        for ( int i = slot; i < size - 1; ++i ){
+            stackAt(i) = stackAt(i+1);
+        }
+        size--;
+        spilled.resize( max( 0, size - C_INVENTORY_INLINE ) );
+    } else if ( count > 0 ){
+        if ( size >= C_INVENTORY_INLINE ){
+            spilled.push_back( ItemStack () );
+        }
+        size++;
+        for ( int i = size - 1; i > slot; --i ){
+            stackAt(i) = stackAt(i-1);
+        }
+        ItemStack stack = { (uint16_t)item, count };
+        stackAt(slot) = stack;
+    }
+}
+/*********************************************************/
+int Inventory::getTotal() const{
+    int total = 0;
+    for ( int i = 0; i < size; ++i ){
+        total += at(i).count;
+    }
+    return total;
+}
@@ -0,0 +1,275 @@
+/** @file items.h
+ * Header file of ItemRegistry class, LootTable class and Inventory class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef ITEMS_H
+#define ITEMS_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mapelement.h"
+#include "deltalog.h"
+#include "random.h"
+using namespace std;
+#define C_ITEMS_FILE        "examples/items.txt"    // item types of game
+#define C_ITEMS_MAX         0xffff                  // ids of item types are 16-bit
+#define C_INVENTORY_INLINE  4                       // kinds of items hero carries without allocation
+#define C_LOOT_SCALE        ( 1 << 24 )             // probabilities of loot tables are parts of it
+#define C_LOOT_WEIGHT       1000000                 // max weight of one drop
+/**
+ * @brief The ItemType struct is one type of item from items file
+ */
+struct ItemType{
+    string name;                // name in map files
+    char symbol;                // symbol on map
+    int32_t skill;              // skill changed by use (DELTA_HEALTH, DELTA_DAMAGE or DELTA_DEFENCE)
+    int32_t value;              // difference of skill
+    int32_t stack;              // max count hero can carry
+};
+/**
+ * @brief The ItemStack struct is items of one type in inventory
+ */
+struct ItemStack{
+    uint16_t item;
+    int32_t count;
+};
+/**********************************************************************************************/
+/**
+ * @brief The LootTable class is weighted drops of enemy, sampled by alias method (Walker)
+ * @detailed    Every drop gets one column of the same width: column keeps own drop with some
+ *              probability and gives the rest to alias, other drop which has too big weight.
+ *              Sample is one random column and one random number compared to its probability,
+ *              so it takes the same time for two drops and for thousands of them.
+ *              Table is built once, when items file is read.
+ */
+class LootTable{
+    public:
+        /**
+         * @brief LootTable is constructor with parameters, it builds columns (Vose's way)
+         * @param name is name of table in map files
+         * @param items are ids of dropped item types, -1 is drop of nothing
+         * @param weights are weights of drops, > 0
+         */
+        LootTable( const string &name, const vector<int> &items, const vector<int> &weights );
+        /**
+         * @brief sample chooses drop
+         * @param random is random generator of game session
+         * @return id of item type or -1 if enemy drops nothing
+         */
+        int sample( Random &random ) const{
+            int column = random.next( items.size() );
+            return random.next( C_LOOT_SCALE ) < probabilities[column] ? items[column] : aliases[column];
+        }
+        /**
+         * @brief getName is getter of name of table
+         * @return name
+         */
+        const string &getName() const{
+            return name;
+        }
+    private:
+        string name;
+        vector<int32_t> items;                  // own drop of every column
+        vector<int32_t> probabilities;          // of own drop of every column, parts of C_LOOT_SCALE
+        vector<int32_t> aliases;                // drop of every column in the rest of cases
+};
+/**********************************************************************************************/
+/**
+ * @brief The ItemRegistry class keeps all item types of game
+ * @detailed    Types are read from items file, lines are:
+ *                  "item" NAME 'SYMBOL' health|damage|defence DIFF STACK
+ *              Types get dense ids in order of file. Names of map files are translated to ids by
+ *              perfect hash (hash and displace): every name has its own slot, so lookup is one hash,
+ *              one displacement, one slot and one comparison, whatever count of types is.
+ *              Symbols of items are kept in table of 256 flags for pathfinding and drawing.
+ *              Every type has one shared tile (Item), so places don't own anything.
+ *              Loot tables of enemies are in the same file, after items which they drop:
+ *                  "loot" NAME ITEM WEIGHT ITEM WEIGHT ...
+ *              where ITEM nothing means that enemy drops nothing.
+ *              Items file is required, C_ITEMS_FILE is relative to directory of game.
+ */
+class ItemRegistry{
+    public:
+        /**
+         * @brief get is getter of registry of game, it is read from C_ITEMS_FILE at first use
+         * @return registry
+         * @throw exception if items file is missing or it has error
+         */
+        static const ItemRegistry &get();
+        /**
+         * @brief ItemRegistry is constructor with parameters
+         * @param fileName is name of items file
+         * @throw exception if file can't be read or it has error
+         */
+        ItemRegistry( const string &fileName );
+        /**
+         * @brief find translates name of item type to id
+         * @param name is name
+         * @return id or -1 if there isn't such type
+         */
+        int find( const string &name ) const;
+        /**
+         * @brief getType is getter of item type
+         * @param item is id
+         * @return type
+         */
+        const ItemType &getType( int item ) const{
+            return types[item];
+        }
+        /**
+         * @brief getTile is getter of shared tile of item type
+         * @param item is id
+         * @return tile
+         */
+        const MapElement *getTile( int item ) const{
+            return &tiles[item];
+        }
+        /**
+         * @brief getCount is getter of count of item types
+         * @return count
+         */
+        int getCount() const{
+            return types.size();
+        }
+        /**
+         * @brief isSymbol says if symbol belongs to some item type
+         * @param symbol is symbol on map
+         * @return true for item
+         */
+        bool isSymbol( char symbol ) const{
+            return symbols[ (unsigned char)symbol ];
+        }
+        /**
+         * @brief findLoot translates name of loot table to id, it is used only while maps are loaded
+         * @param name is name
+         * @return id or -1 if there isn't such table
+         */
+        int findLoot( const string &name ) const;
+        /**
+         * @brief getLoot is getter of loot table
+         * @param loot is id
+         * @return table
+         */
+        const LootTable &getLoot( int loot ) const{
+            return loots[loot];
+        }
+        /**
+         * @brief getCountLoots is getter of count of loot tables
+         * @return count
+         */
+        int getCountLoots() const{
+            return loots.size();
+        }
+    private:
+        vector<ItemType> types;
+        vector<LootTable> loots;
+        vector<Item> tiles;
+        vector<uint32_t> displacements;         // of buckets of perfect hash
+        vector<int32_t> slots;                  // id of type in every slot, -1 is free slot
+        uint64_t mask;                          // slots - 1
+        bool symbols[256];
+        /**
+         * @brief add adds item type
+         * @param type is type
+         * @param errorEnd is end of error message
+         * @throw exception if type isn't valid
+         */
+        void add( const ItemType &type, const string &errorEnd );
+        /**
+         * @brief build makes tiles and perfect hash of names, names are different
+         * @throw exception if names can't be hashed (the same 64-bit hash)
+         */
+        void build();
+        /**
+         * @brief parseLoot reads loot table, items of table have to be already built
+         * @param line is rest of line after "loot"
+         * @param errorEnd is end of error message
+         * @throw exception if table has error
+         */
+        void parseLoot( const string &line, const string &errorEnd );
+        /**
+         * @brief hashOf is hash of name (FNV-1a)
+         * @param name is name
+         * @return hash
+         */
+        static uint64_t hashOf( const string &name );
+        /**
+         * @brief slotOf is slot of hash with displacement
+         * @param hash is hash of name
+         * @param displacement is displacement of bucket
+         * @return index of slot
+         */
+        uint64_t slotOf( uint64_t hash, uint32_t displacement ) const;
+        ItemRegistry( const ItemRegistry & );
+        ItemRegistry &operator=( const ItemRegistry & );
+};
+/**********************************************************************************************/
+/**
+ * @brief The Inventory class is items of hero, stacks are ordered by id of type
+ * @detailed    Hero carries only few kinds of items, so stacks are small vector: the first
+ *              C_INVENTORY_INLINE of them are inside of object, others go to heap. Search is
+ *              linear through carried kinds only, it doesn't depend on count of item types.
+ */
+class Inventory{
+    public:
+        /**
+         * @brief Inventory is implicit constructor of empty inventory
+         */
+        Inventory() : size(0) {}
+        /**
+         * @brief getCount is getter of count of items of type
+         * @param item is id of type
+         * @return count
+         */
+        int getCount( int item ) const{
+            for ( int i = 0; i < size; ++i ){
+                const ItemStack &stack = at(i);
+                if ( stack.item == item ){
+                    return stack.count;
+                }
+            }
+            return 0;
+        }
+        /**
+         * @brief set sets count of items of type, stack without items is removed
+         * @param item is id of type
+         * @param count is new count
+         */
+        void set( int item, int count );
+        /**
+         * @brief getSize is getter of count of stacks
+         * @return count of kinds of items
+         */
+        int getSize() const{
+            return size;
+        }
+        /**
+         * @brief at is getter of stack
+         * @param slot is index of stack, 0 is the type with the least id
+         * @return stack
+         */
+        const ItemStack &at( int slot ) const{
+            return slot < C_INVENTORY_INLINE ? inlined[slot] : spilled[ slot - C_INVENTORY_INLINE ];
+        }
+        /**
+         * @brief getTotal is getter of count of all items
+         * @return count
+         */
+        int getTotal() const;
+    private:
+        ItemStack inlined[C_INVENTORY_INLINE];
+        vector<ItemStack> spilled;              // stacks after the inline ones
+        int size;
+        /**
+         * @brief stackAt is getter of stack for change
+         * @param slot is index of stack
+         * @return stack
+         */
+        ItemStack &stackAt( int slot ){
+            return slot < C_INVENTORY_INLINE ? inlined[slot] : spilled[ slot - C_INVENTORY_INLINE ];
+        }
+};
+/**********************************************************************************************/
+#endif // ITEMS_H
@@ -0,0 +1,108 @@
+/** @file latency.h
+ * Header file and implementation of LatencyHistogram class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef LATENCY_H
+#define LATENCY_H
+#include <algorithm>
+#include <atomic>
+using namespace std;
+#define C_LATENCY_STEPS     4               // buckets between two powers of two
+#define C_LATENCY_BUCKETS   ( 64 * C_LATENCY_STEPS )
+/**********************************************************************************************/
+/**
+ * @brief The LatencyHistogram class
+ * @detailed    Counts durations in logarithmic buckets (every power of two is divided into
+ *              C_LATENCY_STEPS parts, so error is at most 25 %). One thread adds durations,
+ *              any other thread can read percentiles at the same time.
+ */
+class LatencyHistogram{
+    public:
+        /**
+         * @brief LatencyHistogram is implicit constructor
+         */
+        LatencyHistogram() : count(0), maximum(0){
+            for ( int i = 0; i < C_LATENCY_BUCKETS; ++i ){
+                buckets[i].store( 0, memory_order_relaxed );
+            }
+        }
+        /**
+         * @brief add counts one duration
+         * @param nanos is duration in nanoseconds
+         */
+        void add( long long nanos ){
+            buckets[ bucketOf( nanos ) ].fetch_add( 1, memory_order_relaxed );
+            count.fetch_add( 1, memory_order_relaxed );
+            if ( nanos > maximum.load( memory_order_relaxed ) ){
+                maximum.store( nanos, memory_order_relaxed );
+            }
+        }
+        /**
+         * @brief getCount is getter of count of durations
+         * @return count
+         */
+        long long getCount() const{
+            return count.load( memory_order_relaxed );
+        }
+        /**
+         * @brief getMax is getter of the longest duration
+         * @return duration in nanoseconds
+         */
+        long long getMax() const{
+            return maximum.load( memory_order_relaxed );
+        }
+        /**
+         * @brief getPercentile finds duration which isn't exceeded by given part of durations
+         * @param part is from 0 to 1 (0.99 for p99)
+         * @return upper bound of bucket (at most maximum) in nanoseconds, 0 if there isn't any duration
+         */
+        long long getPercentile( double part ) const{
+            long long total = 0;
+            for ( int i = 0; i < C_LATENCY_BUCKETS; ++i ){
+                total += buckets[i].load( memory_order_relaxed );
+            }
+            long long rank = (long long)( part * total );
+            long long seen = 0;
+            for ( int i = 0; i < C_LATENCY_BUCKETS; ++i ){
+                seen += buckets[i].load( memory_order_relaxed );
+                if ( seen > rank ){
+                    // bucket of the longest duration isn't full, percentile can't be over it
+                    return min( upperOf( i ), maximum.load( memory_order_relaxed ) );
+                }
+            }
+            return 0;
+        }
+    private:
+        atomic<long long> buckets[C_LATENCY_BUCKETS];
+        atomic<long long> count;
+        atomic<long long> maximum;
+        /**
+         * @brief bucketOf finds bucket of duration
+         * @param nanos is duration
+         * @return index of bucket
+         */
+        static int bucketOf( long long nanos ){
+            if ( nanos < C_LATENCY_STEPS ){
+                return nanos < 0 ? 0 : (int)nanos;
+            }
+            int power = 63 - __builtin_clzll( (unsigned long long)nanos );
+            int step = (int)( ( nanos >> ( power - 2 ) ) & ( C_LATENCY_STEPS - 1 ) );
+            return power * C_LATENCY_STEPS + step;
+        }
+        /**
+         * @brief upperOf counts the biggest duration of bucket
+         * @param bucket is index of bucket
+         * @return duration in nanoseconds
+         */
+        static long long upperOf( int bucket ){
+            int power = bucket / C_LATENCY_STEPS;
+            int step = bucket % C_LATENCY_STEPS;
+            if ( power < 2 ){
+                return bucket;
+            }
+            return ( ( 1LL << power ) + ( (long long)( step + 1 ) << ( power - 2 ) ) ) - 1;
+        }
+};
+/**********************************************************************************************/
+#endif // LATENCY_H
@@ -2,9 +2,130 @@
 #include <iostream>
 #include "screencontroller.h"
 #include "game.h"
+#include "server.h"
+#include "watcher.h"
+#include "replay.h"
+#include "world.h"
+#include "realtime.h"
+#include "profiler.h"
+#include "alloctracker.h"
+#include "runtimestats.h"
+#include "autosave.h"
+#include "dialog.h"
 /**********************************************************************************************/
 int main( int argc, char **argv ){
 
+    while ( argc >= 3 && ( string ( argv[1] ) == "--profile" || string ( argv[1] ) == "--allocs" ) ){
+        // ./ostroiul --profile TRACE.json ..., trace for chrome://tracing or ui.perfetto.dev is written at exit
+        // ./ostroiul --allocs REPORT.txt ..., allocations per frame and screen are written at exit
+        if ( string ( argv[1] ) == "--profile" ){
+            Profiler::start( argv[2] );
+        } else {
+            AllocTracker::start( argv[2] );
+        }
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
+    }
+    bool realTime = false;
+    if ( argc >= 2 && string ( argv[1] ) == "--realtime" ){
+        // ./ostroiul --realtime MAP QUEST, enemies, poison and effects go on without keys
+        realTime = true;
+        argv[1] = argv[0];
+        argc--;
+        argv++;
+    }
+    bool world = false;
+    uint64_t worldSeed = 0;
+    if ( argc >= 3 && string ( argv[1] ) == "--world" ){
+        // ./ostroiul --world SEED MAP QUEST, games are played in endless procedural world instead of MAP,
+        // its modified chunks are kept in directory world
+        world = true;
+        worldSeed = strtoull( argv[2], NULL, 10 );
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
+    }
+    bool dungeon = false;
+    if ( argc >= 2 && string ( argv[1] ) == "--dungeon" ){
+        // ./ostroiul --dungeon MANIFEST QUEST, games are played on levels of MANIFEST linked by stairs,
+        // visited levels which aren't near hero are kept in directory levels
+        dungeon = true;
+        argv[1] = argv[0];
+        argc--;
+        argv++;
+    }
+    if ( world && dungeon ){
+        // hero plays either on window of world or on level of dungeon
+        cout << "Please run game either with --world SEED MAP QUEST or with --dungeon MANIFEST QUEST, not with both of them.\n";
+        return EXIT_FAILURE;
+    }
+    if ( argc == 5 && string ( argv[1] ) == "--server" ){
+        // ./ostroiul --server SOCKET MAP QUEST, players connect e.g. by: socat -,raw,echo=0 UNIX-CONNECT:SOCKET
+        vector<string> arguments;
+        arguments.push_back( argv[3] );
+        arguments.push_back( argv[4] );
+        try{
+            Server server ( argv[2], arguments );
+            server.run();
+        } catch ( Exception &exc ){
+            cout << exc;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if ( ( argc == 3 || argc == 4 ) && string ( argv[1] ) == "--watch" ){
+        // ./ostroiul --watch SOCKET.watch [SESSION], without session the newest game is shown
+        try{
+            Watcher watcher ( argv[2], argc == 4 ? atoll( argv[3] ) : 0 );
+            watcher.run();
+        } catch ( Exception &exc ){
+            cout << exc;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if ( argc == 6 && string ( argv[1] ) == "--replay" ){
+        // ./ostroiul --replay SCRIPT COUNT MAP QUEST, keys of script are played COUNT times without terminal
+        vector<string> arguments;
+        arguments.push_back( argv[4] );
+        arguments.push_back( argv[5] );
+        try{
+            Replay replay ( argv[2], arguments );
+            replay.run( atoi( argv[3] ) );
+        } catch ( Exception &exc ){
+            cout << exc;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if ( argc == 6 && string ( argv[1] ) == "--generate" ){
+        // ./ostroiul --generate HEIGHT WIDTH SEED FILE writes random map for replays
+        try{
+            Replay::generate( argv[5], atoi( argv[2] ), atoi( argv[3] ), atoi( argv[4] ) );
+        } catch ( Exception &exc ){
+            cout << exc;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if ( argc == 4 && string ( argv[1] ) == "--combat" ){
+        // ./ostroiul --combat COUNT SEED compares vectorized combat tick with scalar one
+        return CombatBatch::benchmark( atoi( argv[2] ), atoi( argv[3] ) ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if ( argc == 3 && string ( argv[1] ) == "--dialogs" ){
+        // ./ostroiul --dialogs SOURCE compiles dialogs of NPCs (it is done also when game opens the first dialog)
+        try{
+            string output = DialogLibrary::compiledName( argv[2] );
+            DialogHeader header = DialogLibrary::compile( argv[2], output );
+            cout << output << ": " << header.countDialogs << " dialogs, " << header.countNodes << " nodes, "
+                 << header.countEdges << " answers, " << header.poolSize << " B of strings" << endl;
+        } catch ( Exception &exc ){
+            cout << exc;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
     shared_ptr<Game> game;
     try{
         game = shared_ptr<Game> (new Game ( argc, argv ) ) ;
@@ -12,16 +133,48 @@ int main( int argc, char **argv ){
         cout << exc;
         return EXIT_FAILURE;
     }
+    game->setRealTime( realTime );
+    game->setWorld( world, worldSeed );
+    game->setDungeon( dungeon );
     shared_ptr<ScreenController> sc ( new ScreenController );
     sc->graphicDriverOn();
-    sc->processData( game->start() );
+    if ( realTime ){
+        timeout( C_REALTIME_TICK );                 // getch gives ERR if no key comes during tick
+    }
+    shared_ptr<ScreenData> data = game->start();
+    sc->processData( data );
     int key = 0;
+    // kill -USR1 PID appends snapshot to ostroiul-PID.stats
+    RuntimeStats::install();
+    // finished save of game (key K) is shown without waiting for next key
+    AutoSave::install();
 
     do{
+        if ( RuntimeStats::isRequested() ){
+            RuntimeStats::dump( data.get() );
+        }
         key = getch();
+        shared_ptr<ScreenData> updated;
+        if ( key == ERR ){
+            // getch was interrupted by signal or tick of real-time mode passed without key
+            updated = game->update();
+            if ( updated == NULL ){
+                continue;
+            }
+        }
+        long long begin = RuntimeStats::nanos();
+        AllocTracker::beginFrame();
         clear();
-        sc->processData( game->handleKey(key) );
-        refresh();
+        data = ( updated != NULL ) ? updated : game->handleKey(key);
+        long long handled = RuntimeStats::nanos();
+        sc->processData( data );
+        {
+            PROFILE_SCOPE( "refresh" );
+            ALLOC_SCOPE( "refresh" );
+            refresh();
+        }
+        AllocTracker::endFrame( data->type );
+        RuntimeStats::addFrame( RuntimeStats::nanos() - begin, handled - begin );
     } while( game->gameStopped() == false );
     getch();
     sc->graphicDriverOff();
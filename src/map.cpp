@@ -3,12 +3,72 @@
  *
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
  */
+#include <algorithm>
 #include "map.h"
+#include "profiler.h"
+/**********************************************************************************************/
+/**
+ * @brief readWord reads word (up to space, '[', '(' or '"') of line
+ * @param line is line
+ * @param pos is position in line, it moves after word
+ * @param word is output
+ * @return false if there isn't word
+ */
+static bool readWord( const string &line, size_t &pos, string &word ){
+    size_t begin = line.find_first_not_of( " \t", pos );
+    if ( begin == string::npos ){
+        return false;
+    }
+    size_t end = line.find_first_of( " \t[(\"", begin );
+    if ( end == begin ){
+        return false;
+    }
+    pos = ( end == string::npos ) ? line.size() : end;
+    word = line.substr( begin, pos - begin );
+    return true;
+}
+/**
+ * @brief readNumbers reads numbers in brackets divided by commas, e.g. [y,x]
+ * @param line is line
+ * @param pos is position in line, it moves after closing bracket
+ * @param open is opening bracket
+ * @param close is closing bracket
+ * @param numbers is output
+ * @param count is count of numbers
+ * @return false if there aren't brackets with exactly count numbers
+ */
+static bool readNumbers( const string &line, size_t &pos, char open, char close, int *numbers, int count ){
+    size_t begin = line.find_first_not_of( " \t", pos );
+    if ( begin == string::npos || line[begin] != open ){
+        return false;
+    }
+    size_t end = line.find( close, begin );
+    if ( end == string::npos ){
+        return false;
+    }
+    string inner = line.substr( begin + 1, end - begin - 1 );
+    replace( inner.begin(), inner.end(), ',', ' ' );
+    stringstream ss ( inner );
+    string rest;
+    for ( int i = 0; i < count; ++i ){
+        if ( !( ss >> numbers[i] ) ){
+            return false;
+        }
+    }
+    if ( ss >> rest ){
+        return false;
+    }
+    pos = end + 1;
+    return true;
+}
 /**********************************************************************************************/
 Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
+    PROFILE_SCOPE( "Map::Map" );
     fstream in ( inputArg.c_str() );
     countEnemies = 0;
-    map = new vector<shared_ptr<MapElement>>();
+    turn = 0;
+    heroPos = 0;                                // level of Dungeon doesn't need hero
+    map = new vector<const MapElement *>();
     shared_ptr <Hero> hr = hero;
     string line;
     stringstream ss;
@@ -32,10 +92,11 @@ Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
         errorMess =  "Error in map size" + aboutKeyMess;
         throw Exception ( errorMess );
     }
-    for ( int i = 0; i < height*width; ++i ){
-        (*map).push_back(shared_ptr <MapElement>(new MapElement));
-    }
+    map->assign( height*width, tileOf( EMPTY ) );
+    occupants.resize( height*width );
     int countHero = 0;
+    vector<int> enemyPlaces;
+    shared_ptr<TriggerIndex> index ( new TriggerIndex );
     while ( getline(in, line) ){                    // read all map elements
        size_t quote1 = line.find_first_of("\"");
        if ( quote1 == string::npos ){
@@ -47,6 +108,14 @@ Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
            throw Exception ( errorMess );
        }
        string type = line.substr(quote1+1, quote2-quote1-1);
+       if ( type == "trigger" ){
+           parseTrigger( *index, line, quote2+1, aboutKeyMess );
+           continue;
+       }
+       if ( type == "spawner" || type == "budget" ){
+           parseSpawner( type, line, quote2+1, aboutKeyMess );
+           continue;
+       }
        bracket1 = line.find_first_of("[", quote2+1);
        comma = line.find_first_of(",", bracket1+1);
        bracket2 = line.find_first_of("]", comma+1);
@@ -62,7 +131,7 @@ Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
        ss >> w;
        clearStrStream ( ss );
        int index = w+h*width;
-       if ( (*map)[index]->getSymbol() != '.' ){
+       if ( getSymbol( index ) != '.' ){
            errorMess = "Object can't be on same position as another one" + aboutKeyMess;
            throw Exception ( errorMess );
        }
@@ -71,15 +140,15 @@ Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
            throw Exception ( errorMess );
        }
        typeMapObj tp;
+       int item = ItemRegistry::get().find( type );
+       if ( item >= 0 ){
+           placeItem( index, item );
+           continue;
+       }
        if ( type == "barrier"){
            tp = BARRIER;
        }
-       else if ( type == "whisky" ) {
-           tp = WHISKY;
-       }
-       else if (type == "sword" ) {
-           tp = SWORD;
-       }else if ( type == "thorn" ){
+       else if ( type == "thorn" ){
            tp = THORN;
        }
        else if ( type == "enemy" ){
@@ -106,12 +175,27 @@ Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
                errorMess = "Enemies can't have characteristics <= 0" + aboutKeyMess;
                throw Exception ( errorMess );
            }
-           shared_ptr <Enemy> en (new Enemy);
-           (*map)[index] = en;
-           en->setHealth(hlth);
-           en->setDamage(dmg);
-           en->setDefence(dfnc);
+           // optional loot table after stats: (health, damage, defence) loot NAME
+           size_t comment = line.find( "//", bracket2 );
+           ss << line.substr( bracket2+1, comment == string::npos ? string::npos : comment-bracket2-1 );
+           string word, name;
+           int loot = -1;
+           if ( ss >> word ){
+               if ( word != "loot" || !( ss >> name ) ){
+                   errorMess = "Error in syntax (expected loot NAME) at enemy creation" + aboutKeyMess;
+                   throw Exception ( errorMess );
+               }
+               loot = ItemRegistry::get().findLoot( name );
+               if ( loot < 0 ){
+                   errorMess = "Unknown loot " + name + " at enemy creation" + aboutKeyMess;
+                   throw Exception ( errorMess );
+               }
+           }
+           clearStrStream ( ss );
+           Stats stats = { hlth, dmg, dfnc };
+           placeEnemy( index, stats, loot );
            countEnemies++;
+           enemyPlaces.push_back(index);
        }else if ( type == "hero"){
            if ( countHero > 0 ){
                errorMess = "There can be only one hero" + aboutKeyMess;
@@ -127,49 +211,323 @@ Map::Map( const string &inputArg, shared_ptr<Hero> hero ){
        createMapObject( tp, index, hr );
     }
     in.close();
+    index->build();
+    triggers = index;
+    fired.assign( index->getCount(), false );
+    // game can't be won if some enemy is walled off by barriers
+    regions = shared_ptr<RegionMap>( new RegionMap ( *this ) );
+    spawners.relabel( *regions, links, world );
+    for ( int i = 0; i < spawners.getCount(); ++i ){
+        enemyPlaces.push_back( spawners.at(i).place );
+    }
+    for ( int i = 0; countHero > 0 && i < (int)enemyPlaces.size(); ++i ){
+        if ( !regions->isConnected( heroPos, enemyPlaces[i] ) ){
+            ss << "Enemy [" << enemyPlaces[i] / width << "," << enemyPlaces[i] % width << "] can't be reached by hero";
+            errorMess = ss.str() + aboutKeyMess;
+            throw Exception ( errorMess );
+        }
+    }
+}
+/*********************************************************/
+Map::Map( const Map &prototype, shared_ptr<Hero> hero ) : height(prototype.height), width(prototype.width){
+    PROFILE_SCOPE( "Map::Map copy" );
+    countEnemies = prototype.countEnemies;
+    heroPos = prototype.heroPos;
+    map = new vector<const MapElement *>( *prototype.map );
+    world = prototype.world;
+    occupants = prototype.occupants;
+    regions = prototype.regions;
+    links = prototype.links;
+    triggers = prototype.triggers;
+    fired = prototype.fired;
+    spawners = prototype.spawners;
+    turn = prototype.turn;
+    if ( prototype.hero != NULL ){
+        createMapObject( HERO, heroPos, hero );
+    }
 }
+/*********************************************************/
+Map::Map( int height, int width ) : height(height), width(width){
+    countEnemies = 0;
+    turn = 0;
+    heroPos = 0;
+    map = new vector<const MapElement *>( height*width, tileOf( EMPTY ) );
+    occupants.resize( height*width );
+}
+/*********************************************************/
+void Map::parseTrigger( TriggerIndex &index, const string &line, size_t pos, const string &aboutKeyMess ){
+    string errorMess = "Error in syntax of trigger" + aboutKeyMess;
+    Trigger trigger = { 0, 0, 0, 0, { 0, 0, 0 } };
+    string word;
+    int place[2];
+    if ( readNumbers( line, pos, '[', ']', place, 2 ) ){
+        if ( place[0] < 0 || place[1] < 0 || place[0] >= height || place[1] >= width ){
+            throw Exception ( "Trigger can't be out of map bounds" + aboutKeyMess );
+        }
+        trigger.key = place[1] + place[0] * width;
+        if ( !readWord( line, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        if ( word == "enter" ){
+            trigger.event = TRIGGER_ENTER;
+        } else if ( word == "kill" ){
+            trigger.event = TRIGGER_KILL;
+        } else if ( word == "pickup" ){
+            trigger.event = TRIGGER_PICKUP;
+        } else {
+            throw Exception ( "Unknown event of trigger" + aboutKeyMess );
+        }
+    } else {
+        stringstream ss;
+        if ( !readWord( line, pos, word ) || word != "left" || !readWord( line, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        ss << word;
+        if ( !( ss >> trigger.key ) || !ss.eof() || trigger.key < 0 ){
+            throw Exception ( errorMess );
+        }
+        trigger.event = TRIGGER_LEFT;
+    }
+    if ( !readWord( line, pos, word ) ){
+        throw Exception ( errorMess );
+    }
+    if ( word == "message" ){
+        size_t quote1 = line.find_first_of( "\"", pos );
+        size_t quote2 = ( quote1 == string::npos ) ? string::npos : line.find_first_of( "\"", quote1+1 );
+        if ( quote2 == string::npos ){
+            throw Exception ( errorMess );
+        }
+        string text = line.substr( quote1+1, quote2-quote1-1 );
+        for ( size_t br = text.find( "\\n" ); br != string::npos; br = text.find( "\\n", br ) ){
+            text.replace( br, 2, "\n" );
+        }
+        trigger.action = ACTION_MESSAGE;
+        trigger.target = index.addMessage( text );
+    } else if ( word == "spawn" || word == "open" ){
+        if ( !readNumbers( line, pos, '[', ']', place, 2 ) ){
+            throw Exception ( errorMess );
+        }
+        if ( place[0] < 0 || place[1] < 0 || place[0] >= height || place[1] >= width ){
+            throw Exception ( "Trigger can't be out of map bounds" + aboutKeyMess );
+        }
+        trigger.target = place[1] + place[0] * width;
+        trigger.action = ACTION_OPEN;
+        if ( word == "spawn" ){
+            trigger.action = ACTION_SPAWN;
+            if ( !readNumbers( line, pos, '(', ')', trigger.values, 3 ) ){
+                throw Exception ( errorMess );
+            }
+            if ( trigger.values[0] <= 0 || trigger.values[1] <= 0 || trigger.values[2] <= 0 ){
+                throw Exception ( "Enemies can't have characteristics <= 0" + aboutKeyMess );
+            }
+        }
+    } else if ( word == "stat" ){
+        stringstream ss;
+        if ( !readWord( line, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        if ( word == "health" ){
+            trigger.target = DELTA_HEALTH;
+        } else if ( word == "damage" ){
+            trigger.target = DELTA_DAMAGE;
+        } else if ( word == "defence" ){
+            trigger.target = DELTA_DEFENCE;
+        } else {
+            throw Exception ( errorMess );
+        }
+        if ( !readWord( line, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        ss << word;
+        if ( !( ss >> trigger.values[0] ) || !ss.eof() ){
+            throw Exception ( errorMess );
+        }
+        trigger.action = ACTION_STAT;
+    } else if ( word == "dialog" ){
+        if ( !readWord( line, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        trigger.action = ACTION_DIALOG;
+        trigger.target = index.addMessage( word );
+    } else {
+        throw Exception ( "Unknown action of trigger" + aboutKeyMess );
+    }
+    index.add( trigger );
+}
+/*********************************************************/
+void Map::parseSpawner( const string &type, const string &line, size_t pos, const string &aboutKeyMess ){
+    string errorMess = "Error in syntax of " + type + aboutKeyMess;
+    string text = line.substr( 0, line.find( "//" ) );
+    int place[2];
+    if ( !readNumbers( text, pos, '[', ']', place, 2 ) ){
+        throw Exception ( errorMess );
+    }
+    if ( place[0] < 0 || place[1] < 0 || place[0] >= height || place[1] >= width ){
+        throw Exception ( "Object can't be out of map bounds" + aboutKeyMess );
+    }
+    string word;
+    stringstream ss;
+    if ( type == "budget" ){
+        int budget = 0;
+        if ( !readWord( text, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        ss << word;
+        if ( !( ss >> budget ) || !ss.eof() || readWord( text, pos, word ) ){
+            throw Exception ( errorMess );
+        }
+        if ( budget <= 0 ){
+            // spawners of region would never spawn and their enemies couldn't be killed
+            throw Exception ( "Budget of region can't be <= 0" + aboutKeyMess );
+        }
+        spawners.addBudget( place[1] + place[0] * width, budget );
+        return;
+    }
+    Spawner spawner;
+    spawner.place = place[1] + place[0] * width;
+    spawner.loot = -1;
+    spawner.every = 0;
+    spawner.near = 0;
+    spawner.total = 0;
+    spawner.spawned = 0;
+    spawner.budget = 0;
+    int stats[3];
+    if ( !readNumbers( text, pos, '(', ')', stats, 3 ) ){
+        throw Exception ( errorMess );
+    }
+    if ( stats[0] <= 0 || stats[1] <= 0 || stats[2] <= 0 ){
+        throw Exception ( "Enemies can't have characteristics <= 0" + aboutKeyMess );
+    }
+    spawner.stats.health = stats[0];
+    spawner.stats.damage = stats[1];
+    spawner.stats.defence = stats[2];
+    while ( readWord( text, pos, word ) ){
+        string value;
+        if ( !readWord( text, pos, value ) ){
+            throw Exception ( errorMess );
+        }
+        if ( word == "loot" ){
+            spawner.loot = ItemRegistry::get().findLoot( value );
+            if ( spawner.loot < 0 ){
+                throw Exception ( "Unknown loot " + value + " of spawner" + aboutKeyMess );
+            }
+            continue;
+        }
+        int number = 0;
+        clearStrStream( ss );
+        ss << value;
+        if ( !( ss >> number ) || !ss.eof() || number < 0 ){
+            throw Exception ( errorMess );
+        }
+        if ( word == "total" ){
+            spawner.total = number;
+        } else if ( word == "every" ){
+            spawner.every = number;
+        } else if ( word == "near" ){
+            spawner.near = number;
+        } else {
+            throw Exception ( errorMess );
+        }
+    }
+    if ( spawner.total <= 0 || ( spawner.every == 0 && spawner.near == 0 ) ){
+        throw Exception ( "Spawner needs total > 0 and every or near" + aboutKeyMess );
+    }
+    spawners.add( spawner );
+    countEnemies += spawner.total;
+}
+/*********************************************************/
+void Map::spawn( int number ){
+    Spawner &spawner = spawners.at( number );
+    if ( spawner.spawned >= spawner.total || spawners.isFull( number ) ){
+        return;
+    }
+    // spawner's place or its free neighbour
+    int neighbours[5] = { spawner.place, spawner.place - width, spawner.place + width,
+                          spawner.place % width > 0 ? spawner.place - 1 : -1,
+                          spawner.place % width < width - 1 ? spawner.place + 1 : -1 };
+    int index = -1;
+    for ( int i = 0; i < 5 && index < 0; ++i ){
+        if ( neighbours[i] >= 0 && neighbours[i] < height * width && getSymbol( neighbours[i] ) == '.' ){
+            index = neighbours[i];
+        }
+    }
+    if ( index < 0 ){
+        return;
+    }
+    if ( spawner.pool.empty() ){
+        occupants[index] = world.createEnemy( index, spawner.stats, spawner.loot, number );
+        history.push( DELTA_SPAWNER, number, occupants[index].pack() );
+    } else {
+        occupants[index] = spawner.pool.back();
+        spawner.pool.pop_back();
+        world.revive( occupants[index], index );
+        history.push( DELTA_REVIVE, number, occupants[index].pack() );
+    }
+    spawner.spawned++;
+    changePopulation( index, 1 );
+    updateTile( index );
+}
+/*********************************************************/
+void Map::changePopulation( int index, int diff ){
+    if ( regions != NULL ){
+        spawners.changePopulation( links.getRegion( *regions, index ), diff );
+    }
+}
+/*********************************************************/
+int Map::distance( int from, int to ) const{
+    return abs( from % width - to % width ) + abs( from / width - to / width );
+}
+/*********************************************************/
 void Map::clearStrStream( stringstream &ss){
     ss.str("");
     ss.clear();
 }
 /*********************************************************/
 Map::~Map(){
+    if ( hero != NULL ){
+        hero->setHistory( NULL );
+    }
     delete map;
 }
 /*********************************************************/
 void Map::createMapObject( typeMapObj type, int index, shared_ptr<Hero> hr ){
     switch( type){
-        case BARRIER: {
-            shared_ptr <Barrier> br( new Barrier );
-            (*map)[index] = br;
+        case BARRIER:
+        case THORN:
+        case STAIRS:
+            (*map)[index] = tileOf( type );
             return;
-        }
-        case THORN:{
-            shared_ptr <Thorn> th ( new Thorn );
-            (*map)[index] = th;
-            return;
-        }
-        case WHISKY:{
-            shared_ptr<Whisky> ws ( new Whisky );
-            (*map)[index] = ws;
-            return;
-        }
-        case SWORD:{
-            shared_ptr <Sword> sw ( new Sword );
-            (*map)[index] = sw;
-            return;
-        }
         case HERO:{
-            (*map)[index] = hr;
             hero = hr;
             heroPos = index;
-            dirHero = hr;
+            hero->setHistory( &history );
             return;
         }
         default: return;
     };
 }
 /*********************************************************/
+void Map::placeEnemy( int index, const Stats &stats, int loot ){
+    occupants[index] = world.createEnemy( index, stats, loot );
+}
+/*********************************************************/
+void Map::placeItem( int index, int item ){
+    (*map)[index] = ItemRegistry::get().getTile( item );
+}
+/*********************************************************/
+const MapElement *Map::tileOf( typeMapObj type ){
+    static const MapElement empty = MapElement();
+    static const Barrier barrier = Barrier();
+    static const Thorn thorn = Thorn();
+    static const Stairs stairs = Stairs();
+    switch ( type ){
+        case BARRIER:   return &barrier;
+        case THORN:     return &thorn;
+        case STAIRS:    return &stairs;
+        default:        return &empty;
+    }
+}
+/*********************************************************/
 int Map::getHeight() const{
     return height;
 }
@@ -182,53 +540,332 @@ int Map::getCountEnemies(){
     return countEnemies;
 }
 /*********************************************************/
+int Map::getCountComing() const{
+    return spawners.getRemaining();
+}
+/*********************************************************/
 void Map::setCountEnemies(){
+    history.push( DELTA_ENEMIES, 0, countEnemies );
     countEnemies--;
+    fire( TRIGGER_LEFT, countEnemies );
+}
+/*********************************************************/
+const MapElement &Map::getTile( int index ) const{
+    return *(*map)[index];
+}
+/*********************************************************/
+bool Map::getEnemyStats( int index, Stats &stats ) const{
+    return world.getStats( occupants[index], stats );
+}
+/*********************************************************/
+World &Map::getWorld(){
+    return world;
 }
 /*********************************************************/
-vector<shared_ptr<MapElement> > *Map::getMap() const{
-    return map;
+char Map::getSymbol( int index ) const{
+    if ( index == heroPos && hero != NULL ){
+        return hero->getSymbol();
+    }
+    const Glyph *glyph = world.getGlyph( occupants[index] );
+    if ( glyph != NULL ){
+        return glyph->symbol;
+    }
+    return (*map)[index]->getSymbol();
+}
+/*********************************************************/
+void Map::killEnemy( int index ){
+    history.push( DELTA_ENEMY, index, occupants[index].pack() );
+    world.getPositions().remove( occupants[index].index );
+    changePopulation( index, -1 );
+    // killed enemy of spawner waits in its pool, undo of kill takes it back from there
+    const Origin *origin = world.getOrigin( occupants[index] );
+    if ( origin != NULL ){
+        spawners.at( origin->spawner ).pool.push_back( occupants[index] );
+    }
+    const Loot *loot = world.getLoot( occupants[index] );
+    occupants[index] = Handle();
+    updateTile( index );
+    // drop lies on place of enemy, undo takes it back with tile and state of random generator
+    if ( loot != NULL && (*map)[index] == tileOf( EMPTY ) ){
+        int item = ItemRegistry::get().getLoot( loot->table ).sample( random );
+        if ( item >= 0 ){
+            setItem( index, item );
+        }
+    }
+    fire( TRIGGER_KILL, index );
 }
 /*********************************************************/
 void Map::moveHero( int newPos ){
-    (*map)[heroPos] = (*map)[newPos];
-    (*map)[newPos] = hero;
+    history.push( DELTA_HERO_POS, newPos, heroPos );
+    int oldPos = heroPos;
     heroPos = newPos;
-    hero = (*map)[newPos];
+    for ( int i = 0; i < spawners.getCount(); ++i ){
+        const Spawner &spawner = spawners.at(i);
+        if ( spawner.every == 0 && distance( oldPos, spawner.place ) > spawner.near && distance( newPos, spawner.place ) <= spawner.near ){
+            spawn( i );
+        }
+    }
+    fire( TRIGGER_ENTER, newPos );
 }
 /*********************************************************/
 void Map::setHeroDirection ( const int &newDirection ) {
-    dirHero->setDirection( newDirection );
+    hero->setDirection( newDirection );
 }
 /*********************************************************/
 string Map::getHeroName(){
-    return dirHero->getName();
+    return hero->getName();
 }
 /*********************************************************/
 int Map::getHeroHealth(){
-    return dirHero->getHealth();
+    return hero->getHealth();
 }
 /*********************************************************/
 int Map::getHeroDamage(){
-    return dirHero->getDamage();
+    return hero->getDamage();
 }
 /*********************************************************/
 int Map::getHeroDefence(){
- return dirHero->getDefence();
+ return hero->getDefence();
 }
 /*********************************************************/
-int Map::getConutWhisky(){
-    return dirHero->getConutWhisky();
+const Inventory &Map::getInventory() const{
+    return hero->getInventory();
 }
 /*********************************************************/
-int Map::getCountSword(){
-    return dirHero->getCountSword();
-}
-/*********************************************************/
-shared_ptr<Hero> Map::getHero() const{
-    return dirHero;
+Hero &Map::getHero() const{
+    return *hero;
 }
 /*********************************************************/
 int Map::getHeroPos(){
     return heroPos;
 }
+/*********************************************************/
+NavGrid &Map::getNavGrid(){
+    if ( navGrid == NULL ){
+        navGrid = shared_ptr<NavGrid>( new NavGrid ( *this ) );
+    }
+    return *navGrid;
+}
+/*********************************************************/
+PathFinder &Map::getPathFinder(){
+    if ( pathFinder == NULL ){
+        pathFinder = shared_ptr<PathFinder>( new PathFinder ( getNavGrid() ) );
+    }
+    return *pathFinder;
+}
+/*********************************************************/
+ClusterGraph &Map::getClusterGraph(){
+    if ( clusterGraph == NULL ){
+        clusterGraph = shared_ptr<ClusterGraph>( new ClusterGraph ( getNavGrid() ) );
+    }
+    return *clusterGraph;
+}
+/*********************************************************/
+bool Map::findPath( int from, int to, vector<int> &path ){
+    PROFILE_SCOPE( "Map::findPath" );
+    if ( !isReachable( from, to ) ){
+        path.clear();
+        return false;
+    }
+    int dist = abs( from % width - to % width ) + abs( from / width - to / width );
+    if ( dist > C_HPA_DISTANCE ){
+        return getClusterGraph().findPath( from, to, path );
+    }
+    return getPathFinder().findPath( from, to, path );
+}
+/*********************************************************/
+bool Map::isReachable( int from, int to ) const{
+    return links.isConnected( *regions, from, to );
+}
+/*********************************************************/
+Random &Map::getRandom(){
+    return random;
+}
+/*********************************************************/
+void Map::updateTile( int index ){
+    if ( navGrid != NULL ){
+        navGrid->update(index);
+    }
+    if ( clusterGraph != NULL ){
+        clusterGraph->update(index);
+    }
+}
+/*********************************************************/
+void Map::setTile( int index, typeMapObj type ){
+    history.push( DELTA_TILE, index, 0, (*map)[index] );
+    (*map)[index] = tileOf( type );
+    updateTile( index );
+}
+/*********************************************************/
+void Map::setItem( int index, int item ){
+    history.push( DELTA_TILE, index, 0, (*map)[index] );
+    (*map)[index] = ItemRegistry::get().getTile( item );
+    updateTile( index );
+}
+/*********************************************************/
+void Map::beginStep(){
+    history.beginStep( random.getState() );
+    turn++;
+    for ( int i = 0; i < spawners.getCount(); ++i ){
+        const Spawner &spawner = spawners.at(i);
+        if ( spawner.every > 0 && turn % spawner.every == 0 && ( spawner.near == 0 || distance( heroPos, spawner.place ) <= spawner.near ) ){
+            spawn( i );
+        }
+    }
+}
+/*********************************************************/
+int Map::undo( int steps ){
+    PROFILE_SCOPE( "Map::undo" );
+    int undone = 0;
+    Delta delta;
+    while ( undone < steps && history.pop( delta ) ){
+        switch ( delta.type ){
+            case DELTA_STEP:
+                random.setState( delta.before );
+                turn--;
+                undone++;
+                break;
+            case DELTA_TILE:
+                (*map)[delta.index] = delta.tile;
+                updateTile( delta.index );
+                break;
+            case DELTA_HERO_POS:
+                heroPos = delta.before;
+                updateTile( delta.index );
+                updateTile( heroPos );
+                break;
+            case DELTA_ENEMY:{
+                Position position = { delta.index };
+                occupants[delta.index] = Handle::unpack( delta.before );
+                world.getPositions().add( occupants[delta.index].index, position );
+                changePopulation( delta.index, 1 );
+                if ( world.getOrigin( occupants[delta.index] ) != NULL ){
+                    spawners.at( world.getOrigin( occupants[delta.index] )->spawner ).pool.pop_back();
+                }
+                updateTile( delta.index );
+                break;
+            }
+            case DELTA_ENEMIES:
+                countEnemies = delta.before;
+                break;
+            case DELTA_TRIGGER:
+                fired[delta.index] = false;
+                break;
+            case DELTA_SPAWN:
+                world.destroy( occupants[delta.index] );
+                occupants[delta.index] = Handle();
+                changePopulation( delta.index, -1 );
+                updateTile( delta.index );
+                break;
+            case DELTA_SPAWNER:
+            case DELTA_REVIVE:{
+                Handle entity = Handle::unpack( delta.before );
+                int index = world.getPosition( entity )->index;
+                occupants[index] = Handle();
+                if ( delta.type == DELTA_REVIVE ){
+                    world.getPositions().remove( entity.index );
+                    spawners.at( delta.index ).pool.push_back( entity );
+                } else {
+                    world.destroy( entity );
+                }
+                spawners.at( delta.index ).spawned--;
+                changePopulation( index, -1 );
+                updateTile( index );
+                break;
+            }
+            case DELTA_REGIONS:
+                // barrier is back, budgets of spawners go back to regions before opening
+                links.close( delta.index, delta.before );
+                spawners.relabel( *regions, links, world );
+                break;
+            default:
+                hero->restore( delta.type, delta.index, delta.before );
+                break;
+        }
+    }
+    return undone;
+}
+/*********************************************************/
+const DeltaLog &Map::getHistory() const{
+    return history;
+}
+/*********************************************************/
+MapMemory Map::getMemory() const{
+    MapMemory memory;
+    memory.places = map->capacity() * sizeof(const MapElement *);
+    memory.navGrid = navGrid == NULL ? 0 : navGrid->getMemory();
+    memory.clusterGraph = clusterGraph == NULL ? 0 : clusterGraph->getMemory();
+    memory.regions = ( regions == NULL ? 0 : regions->getMemory() ) + links.getMemory();
+    memory.history = history.getMemory();
+    memory.entities = world.getMemory() + occupants.capacity() * sizeof(Handle) + spawners.getMemory();
+    memory.triggers = ( triggers == NULL ? 0 : triggers->getMemory() ) + fired.capacity() / 8;
+    return memory;
+}
+/*********************************************************/
+void Map::fire( TriggerEvent event, int key ){
+    int begin = 0, end = 0;
+    if ( triggers == NULL || !triggers->find( event, key, begin, end ) ){
+        return;
+    }
+    for ( int id = begin; id < end; ++id ){
+        if ( fired[id] ){
+            continue;
+        }
+        fired[id] = true;
+        history.push( DELTA_TRIGGER, id, 0 );
+        const Trigger &trigger = triggers->getTrigger( id );
+        switch ( trigger.action ){
+            case ACTION_MESSAGE:
+                message += ( message.empty() ? "" : "\n" ) + triggers->getMessage( trigger.target );
+                break;
+            case ACTION_SPAWN:
+                if ( trigger.target != heroPos && getSymbol( trigger.target ) == '.' ){
+                    Stats stats = { trigger.values[0], trigger.values[1], trigger.values[2] };
+                    placeEnemy( trigger.target, stats );
+                    changePopulation( trigger.target, 1 );
+                    history.push( DELTA_SPAWN, trigger.target, 0 );
+                    history.push( DELTA_ENEMIES, 0, countEnemies );
+                    countEnemies++;
+                    updateTile( trigger.target );
+                }
+                break;
+            case ACTION_OPEN:
+                if ( getSymbol( trigger.target ) == '#' ){
+                    setTile( trigger.target, EMPTY );
+                    // new connections only in links, regions of other copies of map stay as they were
+                    int countLinks = links.open( *regions, trigger.target, width, height );
+                    history.push( DELTA_REGIONS, trigger.target, countLinks );
+                    spawners.relabel( *regions, links, world );
+                }
+                break;
+            case ACTION_STAT:
+                hero->changeSkill( (DeltaType)trigger.target, trigger.values[0] );
+                break;
+            case ACTION_DIALOG:
+                dialog = triggers->getMessage( trigger.target );
+                break;
+        }
+    }
+}
+/*********************************************************/
+bool Map::hasMessage() const{
+    return !message.empty();
+}
+/*********************************************************/
+bool Map::takeMessage( string &text ){
+    if ( message.empty() ){
+        return false;
+    }
+    text.swap( message );
+    message.clear();
+    return true;
+}
+/*********************************************************/
+bool Map::takeDialog( string &npc ){
+    if ( dialog.empty() ){
+        return false;
+    }
+    npc.swap( dialog );
+    dialog.clear();
+    return true;
+}
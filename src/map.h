@@ -13,6 +13,14 @@
 #include "mapelement.h"
 #include "hero.h"
 #include "exception.h"
+#include "pathfinder.h"
+#include "clustergraph.h"
+#include "regions.h"
+#include "random.h"
+#include "deltalog.h"
+#include "world.h"
+#include "triggers.h"
+#include "spawners.h"
 using namespace std;
 /**
  * @brief The possible types of elements on map
@@ -20,10 +28,24 @@ using namespace std;
 enum typeMapObj{
     BARRIER,
     THORN,
-    WHISKY,
-    SWORD,
+    ITEM,               // type of item is in ItemRegistry
     HERO,
-    ENEMY
+    ENEMY,
+    EMPTY,
+    STAIRS              // stairs of Dungeon, they lead to other level
+};
+/**********************************************************************************************/
+/**
+ * @brief The MapMemory struct is memory used by parts of one map (in bytes)
+ */
+struct MapMemory{
+    size_t places;                              // vector of places, tiles are shared
+    size_t navGrid;
+    size_t clusterGraph;
+    size_t regions;                             // shared with all copies of the same map, and opened barriers
+    size_t history;
+    size_t entities;                            // World of enemies, their handles on places and spawners
+    size_t triggers;                            // shared with all copies of the same map
 };
 /**********************************************************************************************/
 /**
@@ -31,6 +53,10 @@ enum typeMapObj{
  * @detailed    it reads data from file;
  *              knows how many items are on it;
  *              moves hero and sets his direction;
+ *              places have two layers: tiles (free place, barrier, thorn, items) and entities,
+ *              enemies are entities of World and places only keep their handles, hero is at heroPos;
+ *              spawners make enemies during game, count of enemies to kill includes enemies which
+ *              spawners still have to make, so game is won when all of them are killed
  */
 class Map{
     public:
@@ -40,6 +66,13 @@ class Map{
          * @param hero is pointr at hero on map
          */
         Map( const string &inputArg, shared_ptr<Hero> hero );
+        /**
+         * @brief Map is constructor of copy of loaded map with another hero
+         * @detailed    copy shares labelled regions with prototype, it has own places, enemies and hero
+         * @param prototype is loaded map (MapLibrary)
+         * @param hero is pointr at hero on new map
+         */
+        Map( const Map &prototype, shared_ptr<Hero> hero );
         /**
          * @brief ~Map is destruktor, it cleans all MapElement type's objects
          */
@@ -55,12 +88,39 @@ class Map{
          */
         int getWidth() const;
         /**
-         * @brief getMap is getter for map consists of map elements
-         * @return map
+         * @brief getTile is getter for tile of place, entities on place aren't tiles
+         * @param index is position on map
+         * @return tile
+         */
+        const MapElement &getTile( int index ) const;
+        /**
+         * @brief getEnemyStats is getter for stats of enemy standing on place
+         * @param index is position on map
+         * @param stats is output, stats of enemy
+         * @return false if there isn't living enemy
          */
-        vector<shared_ptr <MapElement>> *getMap() const;
+        bool getEnemyStats( int index, Stats &stats ) const;
         /**
-         * @brief moveHero is moving hero on new position
+         * @brief getWorld is getter for entities of map (real-time mode schedules their actions)
+         * @return world
+         */
+        World &getWorld();
+        /**
+         * @brief getSymbol is getter for symbol of place (hero, enemy or tile)
+         * @param index is position on map
+         * @return symbol of place
+         */
+        char getSymbol( int index ) const;
+        /**
+         * @brief killEnemy removes enemy from place, it is written into history
+         * @detailed    enemy only loses its Position, so undo can put the same entity back;
+         *              enemy with loot table drops item sampled by random generator of session
+         * @param index is position of enemy
+         */
+        void killEnemy( int index );
+        /**
+         * @brief moveHero is moving hero on new position, it is written into history
+         * @detailed    spawners which wait for hero act when he comes near
          * @param newPos is position where hero comes
          */
         void moveHero( int newPos );
@@ -91,40 +151,156 @@ class Map{
         int getHeroDefence();
         /**
          * @brief getHero is getter for Hero
-         * @return pointer at Hero as a object of class Hero
+         * @return hero of this map
          */
-        shared_ptr<Hero> getHero() const;
+        Hero &getHero() const;
         /**
          * @brief getCountEnemies is getter for currient count of the enemies on map
          * @return currient count of the enemies
          */
         int getCountEnemies();
         /**
-         * @brief setCountEnemies is setter for decrement, if hero is alive after fight
+         * @brief getCountComing is getter for count of enemies which spawners still have to make
+         * @return count, it is part of getCountEnemies
          */
-        void setCountEnemies();
+        int getCountComing() const;
         /**
-         * @brief getConutWhisky is getter for currient count of whisky on map
-         * @return currient count of whisky
+         * @brief setCountEnemies is setter for decrement, if hero is alive after fight, it is written into history
          */
-        int getConutWhisky();
+        void setCountEnemies();
         /**
-         * @brief getCountSword is getter for currient count of swords on map
-         * @return currient count of swords
+         * @brief getInventory is getter for items of hero
+         * @return inventory of hero
          */
-        int getCountSword();
+        const Inventory &getInventory() const;
         /**
          * @brief getHeroPos is getter for currient position (index) of Hero on map
          * @return index of Hero on map
          */
         int getHeroPos();
+        /**
+         * @brief getNavGrid is getter for navigation grid, it is built at first call
+         * @return navigation grid of map
+         */
+        NavGrid &getNavGrid();
+        /**
+         * @brief getPathFinder is getter for path finder working on navigation grid
+         * @return path finder
+         */
+        PathFinder &getPathFinder();
+        /**
+         * @brief getClusterGraph is getter for hierarchical path finder, it is built at first call
+         * @return abstract graph of clusters
+         */
+        ClusterGraph &getClusterGraph();
+        /**
+         * @brief findPath finds path for hero, far targets are searched by ClusterGraph, near ones by PathFinder
+         * @param from is start position
+         * @param to is target position
+         * @param path is output, positions of all steps, without start and with target
+         * @return false if there isn't any path
+         */
+        bool findPath( int from, int to, vector<int> &path );
+        /**
+         * @brief isReachable says if hero can get from one place to another one (sometimes through enemies or thorns)
+         * @param from is first position on map
+         * @param to is second position on map
+         * @return false if places are separated by barriers
+         */
+        bool isReachable( int from, int to ) const;
+        /**
+         * @brief updateTile has to be called after some place on map changes
+         * @param index is changed position on map
+         */
+        void updateTile( int index );
+        /**
+         * @brief getRandom is getter for random generator of this game session
+         * @return random generator
+         */
+        Random &getRandom();
+        /**
+         * @brief setTile puts new tile on position, old one is written into history
+         * @param index is position on map
+         * @param type is type of new tile (EMPTY after item is picked up)
+         */
+        void setTile( int index, typeMapObj type );
+        /**
+         * @brief setItem puts item on position, old tile is written into history
+         * @param index is position on map
+         * @param item is id of item type
+         */
+        void setItem( int index, int item );
+        /**
+         * @brief beginStep marks beginning of step in history, all next changes belong to it
+         * @detailed    spawners which make enemy every N steps act at beginning of step
+         */
+        void beginStep();
+        /**
+         * @brief undo takes back last steps from history
+         * @param steps is count of steps to undo
+         * @return count of really undone steps
+         */
+        int undo( int steps );
+        /**
+         * @brief getHistory is getter for history of changes of map and hero
+         * @return history
+         */
+        const DeltaLog &getHistory() const;
+        /**
+         * @brief getMemory counts memory of map's parts, parts which aren't built yet have zero
+         * @return memory of parts
+         */
+        MapMemory getMemory() const;
+        /**
+         * @brief fire runs triggers of event and key which haven't fired yet, changes are written into history
+         * @param event is event
+         * @param key is index of place or count of enemies (TRIGGER_LEFT)
+         */
+        void fire( TriggerEvent event, int key );
+        /**
+         * @brief hasMessage says if some trigger left message for player
+         * @return true if there is message
+         */
+        bool hasMessage() const;
+        /**
+         * @brief takeMessage gives message of triggers away
+         * @param text is output
+         * @return false if there isn't message
+         */
+        bool takeMessage( string &text );
+        /**
+         * @brief takeDialog gives name of NPC whose dialog was begun by trigger away
+         * @param npc is output
+         * @return false if no dialog was begun
+         */
+        bool takeDialog( string &npc );
 private:
         int height, width;                          // map size
-        vector <shared_ptr <MapElement>> *map;
-        shared_ptr <MapElement> hero;
-        shared_ptr <Hero> dirHero;
+        vector <const MapElement *> *map;           // tiles, elements of tileOf
+        shared_ptr <Hero> hero;                     // map owns its hero, others use getHero()
+        World world;
+        vector<Handle> occupants;                   // enemy entity on each place
         int heroPos;                                // index hero on the map
         int countEnemies;
+        shared_ptr <NavGrid> navGrid;
+        shared_ptr <PathFinder> pathFinder;
+        shared_ptr <ClusterGraph> clusterGraph;
+        shared_ptr <RegionMap> regions;
+        RegionLinks links;                          // barriers opened over regions
+        Random random;
+        DeltaLog history;
+        shared_ptr <const TriggerIndex> triggers;   // shared with all copies of the same map
+        vector<bool> fired;                         // fired triggers by id
+        string message;                             // messages of triggers of this step
+        string dialog;                              // NPC whose dialog was begun in this step
+        SpawnerSet spawners;
+        int turn;                                   // count of steps, spawners with period count by it
+        /**
+         * @brief Map is constructor of empty map, SaveGame fills it by saved objects
+         * @param height is map's height
+         * @param width is map's width
+         */
+        Map( int height, int width );
         /**
          * @brief createMapObject is method for creation by type on necessary place
          * @param type of element
@@ -132,8 +308,73 @@ private:
          * @param hr is pointer to Hero for possibility always remember where hero is
          */
         void createMapObject( typeMapObj type, int index, shared_ptr<Hero> hr );
+        /**
+         * @brief placeEnemy creates enemy entity on place
+         * @param index is position on map
+         * @param stats are health, damage and defence of enemy
+         * @param loot is id of loot table, -1 if enemy drops nothing
+         */
+        void placeEnemy( int index, const Stats &stats, int loot = -1 );
+        /**
+         * @brief placeItem puts item on place while map is built, it isn't written into history
+         * @param index is position on map
+         * @param item is id of item type
+         */
+        void placeItem( int index, int item );
+        /**
+         * @brief tileOf is getter for shared element of tile type
+         * @detailed    tiles don't have any state, so all places and all maps share one element of
+         *              each type, loading of map and picking up of item don't allocate anything
+         * @param type is type of tile (BARRIER, THORN, STAIRS, other types are EMPTY, items are in ItemRegistry)
+         * @return element of type
+         */
+        static const MapElement *tileOf( typeMapObj type );
+        /**
+         * @brief parseTrigger reads trigger from line of map file
+         * @detailed    "trigger" [y,x] enter|kill|pickup ACTION or "trigger" left N ACTION, where ACTION is
+         *              message "text", spawn [y,x] (health, damage, defence), open [y,x] or
+         *              stat health|damage|defence DIFF or dialog NPC
+         * @param index is index where trigger is added
+         * @param line is line of map file
+         * @param pos is position after "trigger"
+         * @param aboutKeyMess is end of error message
+         * @throw exception if there is error in syntax
+         */
+        void parseTrigger( TriggerIndex &index, const string &line, size_t pos, const string &aboutKeyMess );
+        /**
+         * @brief parseSpawner reads spawner or budget of region from line of map file
+         * @detailed    "spawner" [y,x] (health, damage, defence) total T [every N] [near R] [loot NAME]
+         *              or "budget" [y,x] N, see SpawnerSet
+         * @param type is type of object ("spawner" or "budget")
+         * @param line is line of map file
+         * @param pos is position after type
+         * @param aboutKeyMess is end of error message
+         * @throw exception if there is error in syntax
+         */
+        void parseSpawner( const string &type, const string &line, size_t pos, const string &aboutKeyMess );
+        /**
+         * @brief spawn lets spawner make enemy if it has some left, its region isn't full and there
+         *          is free place, it is written into history
+         * @param spawner is number of spawner
+         */
+        void spawn( int spawner );
+        /**
+         * @brief changePopulation counts living enemy in region of place
+         * @param index is position of enemy
+         * @param diff is difference
+         */
+        void changePopulation( int index, int diff );
+        /**
+         * @brief distance is count of steps between places without barriers
+         * @param from is first position on map
+         * @param to is second position on map
+         * @return Manhattan distance
+         */
+        int distance( int from, int to ) const;
         void clearStrStream( stringstream &ss);
-
+        friend class SaveGame;
+        friend class ChunkWorld;
+        friend class Dungeon;
 };
 /**********************************************************************************************/
 #endif // MAP_H
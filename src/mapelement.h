@@ -1,7 +1,7 @@
 /** @file mapelement.h
  * Header file and implementation family of classes:
- * MapElement class -> Barrier class, Whisky class, Sword class,
- * Entity class -> Enemy class.
+ * MapElement class -> Barrier class, Thorn class, Stairs class, Item class,
+ * Entity class.
  *
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
 */
@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <ncurses.h>
+#include "world.h"
 using namespace std;
 /**********************************************************************************************/
 /**
@@ -39,6 +40,13 @@ class MapElement{
         virtual char getSymbol() const{
             return '.';
         }
+        /**
+         * @brief getItem is virtual method for inheritance by Item class
+         * @return id of item type, -1 if element isn't item
+         */
+        virtual int getItem() const{
+            return -1;
+        }
 };
 /**********************************************************************************************/
 /**
@@ -70,43 +78,64 @@ class Thorn : public MapElement {
 };
 /**********************************************************************************************/
 /**
- * @brief The Whisky class
+ * @brief The Stairs class is end of stairs between levels of Dungeon
  */
-class Whisky : public MapElement{
+class Stairs : public MapElement {
     public:
         /**
          * @brief getSymbol is getter for symbol on map
-         * @return symbol of whisky on map
+         * @return symbol of stairs on map
          */
         char getSymbol() const{
-            return 'w';
+            return '%';
         }
 };
 /**********************************************************************************************/
 /**
- * @brief The Sword class
+ * @brief The Item class is tile of item type of ItemRegistry, all places with item of one type share it
  */
-class Sword : public MapElement{
+class Item : public MapElement{
     public:
+        /**
+         * @brief Item is constructor with parameters
+         * @param item is id of item type
+         * @param symbol is symbol of item type on map
+         */
+        Item( int item, char symbol ) : item(item), symbol(symbol) {}
         /**
          * @brief getSymbol is getter for symbol on map
-         * @return symbol of sword on map
+         * @return symbol of item type on map
          */
         char getSymbol() const{
-            return 's';
+            return symbol;
+        }
+        /**
+         * @brief getItem is getter for id of item type
+         * @return id
+         */
+        int getItem() const{
+            return item;
         }
+    private:
+        int item;
+        char symbol;
 };
 /**********************************************************************************************/
 /**
- * @brief The Entity class is paretn class for classes Hero and Enemy
- * @detailed Hero ane Enemy have the same skills as health, defence and damage
+ * @brief The Entity class is parent class for class Hero
+ * @detailed    Hero keeps his skills in the same Stats component as enemies of World have,
+ *              so they fight by one CombatSystem
  */
 class Entity : public MapElement{
     public:
         /**
          * @brief Entity is implicit constructor
          */
-        Entity() : health(0), defence(0), damage(0){}
+        Entity(){
+            stats.health = 0;
+            stats.damage = 0;
+            stats.defence = 0;
+        }
         /**
          * @brief ~Entity is virtual destruktor
          * @detailed for correct clean of this class and its descendants
@@ -114,7 +143,7 @@ class Entity : public MapElement{
         virtual ~Entity(){}
         /**
          * @brief getSymbol is getter for symbol on map
-         * @return symbol of entity on map ('v' as hero, 'e' as enemy)
+         * @return symbol of entity on map ('v' as hero)
          */
         virtual char getSymbol() const { return MapElement::getSymbol(); }
         /**
@@ -122,61 +151,30 @@ class Entity : public MapElement{
          * @return health of entity
          */
         int getHealth() const{
-            return health;
+            return stats.health;
         }
         /**
          * @brief getDamage is getter for damage of entity
          * @return damage of entity
          */
         int getDamage() const{
-            return damage;
+            return stats.damage;
         }
         /**
          * @brief getDefence is getter for defence of entity
          * @return defence of entity
          */
         int getDefence() const{
-            return defence;
+            return stats.defence;
         }
-    protected:
-        int health;
-        int defence;
-        int damage;
-};
-/**********************************************************************************************/
-/**
- * @brief The Enemy class
- * @detailed Enemy has health, defence and damage skills from parent class Entity
- */
-class Enemy : public Entity {
-    public:
         /**
-         * @brief getSymbol is getter for symbol on map
-         * @return symbol of enemy on map
+         * @brief getStats is getter for all skills of entity
+         * @return health, damage and defence
          */
-        char getSymbol() const{
-            return 'e';
-        }
-        /**
-         * @brief setDamage is setter for enemy's damage
-         * @param dmg  is damage to set
-         */
-        void setDamage( int dmg ){
-            damage = dmg;
-        }
-        /**
-         * @brief setDefence  is setter for enemy's defence
-         * @param dfnc is defence to set
-         */
-        void setDefence( int dfnc ){
-            defence = dfnc;
-        }
-        /**
-         * @brief setHealth  is setter for enemy's health
-         * @param hlth  is health to set
-         */
-        void setHealth (int hlth ){
-            health = hlth;
+        const Stats &getStats() const{
+            return stats;
         }
+    protected:
+        Stats stats;
 };
 #endif // MAPELEMENT_H
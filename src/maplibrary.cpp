@@ -0,0 +1,24 @@
+/** @file maplibrary.cpp
+ * Implementation of MapLibrary class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include "maplibrary.h"
+#include "profiler.h"
+/**********************************************************************************************/
+thread_local map<string, shared_ptr<const Map> > MapLibrary::prototypes;
+/*********************************************************/
+shared_ptr<Map> MapLibrary::create( const string &fileName, shared_ptr<Hero> hero ){
+    PROFILE_SCOPE( "MapLibrary::create" );
+    map<string, shared_ptr<const Map> >::iterator it = prototypes.find( fileName );
+    if ( it == prototypes.end() ){
+        // prototype's hero only marks his place
+        shared_ptr<const Map> prototype ( new Map ( fileName, shared_ptr<Hero>( new Hero ) ) );
+        it = prototypes.insert( make_pair( fileName, prototype ) ).first;
+    }
+    return shared_ptr<Map>( new Map ( *it->second, hero ) );
+}
+/*********************************************************/
+int MapLibrary::getCountMaps(){
+    return prototypes.size();
+}
@@ -0,0 +1,40 @@
+/** @file maplibrary.h
+ * Header file of MapLibrary class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef MAPLIBRARY_H
+#define MAPLIBRARY_H
+#include <map>
+#include <memory>
+#include <string>
+#include "map.h"
+using namespace std;
+/**********************************************************************************************/
+/**
+ * @brief The MapLibrary class
+ * @detailed    Every map file is read and checked only once, loaded map stays as prototype.
+ *              New games get copy of it (Map copy constructor), which shares all elements and
+ *              regions with prototype. It matters for server, where many games play one map.
+ *              Every thread has its own prototypes, so server's shards don't need a lock.
+ */
+class MapLibrary{
+    public:
+        /**
+         * @brief create makes new game map from file
+         * @param fileName is name of map file
+         * @param hero is hero for new map
+         * @return new map
+         * @throw exception if map file is wrong
+         */
+        static shared_ptr<Map> create( const string &fileName, shared_ptr<Hero> hero );
+        /**
+         * @brief getCountMaps is getter for count of prototypes loaded by this thread
+         * @return count of maps
+         */
+        static int getCountMaps();
+    private:
+        static thread_local map<string, shared_ptr<const Map> > prototypes;
+};
+/**********************************************************************************************/
+#endif // MAPLIBRARY_H
@@ -4,89 +4,282 @@
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
  */
 #include "mappart.h"
+#include "maplibrary.h"
+#include "profiler.h"
+#include "alloctracker.h"
 /**********************************************************************************************/
-MapPart::MapPart() {
+MapPart::MapPart() : manualSave( C_SAVE_FILE, 0 ) {
     activeMap = false;
     showLegend = false;
+    showSaved = false;
+    savedWorld = true;
+    startedSave = false;
+    saving = true;
     isDead = false;
     isWin = false;
+    realTimeOn = false;
+    worldOn = false;
+    dungeonOn = false;
+    worldSeed = 0;
     data = shared_ptr<MapData>(nullptr);
 }
 /*********************************************************/
+MapPart::~MapPart(){
+    if ( world != NULL && map != NULL ){
+        world->store( *map );                   // store of world writes it at its end
+    }
+}
+/*********************************************************/
 GameCondition MapPart::handleKey( const int &ch){
+    PROFILE_SCOPE( "MapPart::handleKey" );
+    ALLOC_SCOPE( "MapPart::handleKey" );
+    if ( dialogPart != NULL ){
+        dialogPart->handleKey( ch );
+        if ( !dialogPart->isOpen() ){
+            dialogPart.reset();
+            activeMap = triggerMessage.empty();
+        }
+        return getCondition();
+    }
+    // map is created at first key, then member is used directly, without copies of shared_ptr
     currPos = getMap()->getHeroPos();
     showLegend = false;
+    showSaved = false;
+    triggerMessage.clear();
     activeMap = true;
     int oldPos = currPos;
-    getMap()->setHeroDirection(ch);
-    int width = getMap()->getWidth();
-    int height = getMap()->getHeight();
-    shared_ptr<Hero> hero = getMap()->getHero();
-    int hlth = hero->getHealth();
+    map->setHeroDirection(ch);
+    int width = map->getWidth();
+    int height = map->getHeight();
+    Hero &hero = map->getHero();
+    int hlth = hero.getHealth();
+    if ( isDead == true && ( ch == 'u' || ch == 'U' ) && map->getHistory().getCountSteps() > 0 && realTime == NULL ){
+        undo();
+        return getCondition();
+    }
     if ( ( isDead == true) || (isWin == true) ) {
         return MAINMENU;
     }
-    if ( hero->getHealth() < 0 ){
+    if ( hero.getHealth() < 0 ){
         activeMap = false;
         isDead = true;
     }
-    if ( map->getCountEnemies() == 0 ){
+    if ( allKilled() ){
         activeMap = false;
         isWin = true;
     }
     if ( ch == 27){
         return MAINMENU;
     }
-    else if ( ch == KEY_UP || ch == 'w'){
-        if ( currPos >= width ){
-            currPos -= width;
+    else if ( ch == KEY_UP || ch == 'w' || ch == KEY_DOWN || ch == 's' ||
+              ch == KEY_LEFT || ch == 'a' || ch == KEY_RIGHT || ch == 'd' ){
+        currPos = neighbour( currPos, ch );
+    }
+    else if ( ch == 'q' ){
+        activeMap = false;
+    }
+    else if ( ch >= '1' && ch <= '9' ){
+        map->beginStep();
+        int item = hero.useItem( ch - '1' );
+        if ( realTime != NULL && item >= 0 && ItemRegistry::get().getType( item ).skill == DELTA_HEALTH ){
+            realTime->drankWhisky( *map );
         }
     }
-    else if ( ch == KEY_DOWN || ch == 's' ){
-        if ( (currPos + width) < ( height * width ) ){
-            currPos += width;
+    else if ( ch == 'u' || ch == 'U' ){
+        if ( realTime == NULL ){                // time of real-time mode can't go back
+            undo();
         }
+        return getCondition();
     }
-    else if ( ch == KEY_LEFT || ch == 'a' ){
-        if ( (currPos % width ) != 0 ){
-            currPos--;
+    else if ( ch == 'l' || ch == 'L' ){
+        activeMap = false;
+        showLegend = true;
+    }
+    else if ( ch == 'k' || ch == 'K' ){
+        if ( world != NULL ){
+            savedWorld = world->save( *map );
         }
+        else if ( saving == true && dungeon == NULL ){
+            // child process writes it, input goes on; update shows when it is finished
+            startedSave = manualSave.start( *map );
+        }
+        activeMap = false;
+        showSaved = true;
     }
-    else if ( ch == KEY_RIGHT || ch == 'd' ){
-        if ( ((currPos+1) % width ) != 0 ){
-            currPos++;
+    else if ( ch == 'e' || ch == 'E' || ch == 'i' || ch == 'I' ){
+        vector<int> path;
+        unsigned char target = ( ch == 'e' || ch == 'E' ) ? NAV_ENEMY : NAV_ITEM;
+        map->getPathFinder().findNearest( currPos, target, path );
+        travel( path );
+        return getCondition();
+    }
+    else if ( ch == KEY_MOUSE ){
+        MEVENT event;
+        if ( getmouse(&event) == OK ){
+            int cX = 0, cY = 0;
+            MapData ( map.get(), currPos ).getCamera( cX, cY );
+            int x = cX + event.x - C_POSX - 1;
+            int y = cY + event.y - C_POSY - 1;
+            vector<int> path;
+            if ( x >= 0 && y >= 0 && x < width && y < height &&
+                 map->findPath( currPos, x+y*width, path ) ){
+                travel( path );
+            }
         }
+        return getCondition();
     }
-    else if ( ch == 'q' ){
+    step( oldPos, hlth );
+    return getCondition();
+}
+/*********************************************************/
+bool MapPart::update(){
+    bool saved = false;
+    if ( manualSave.isRunning() ){
+        manualSave.poll();
+        saved = !manualSave.isRunning() && showSaved;     // message of saving is shown again
+    }
+    if ( realTime == NULL ){
+        return saved;
+    }
+    bool changed = realTime->update( *map, activeMap ) || saved;
+    if ( changed && map->getHero().getHealth() < 0 ){
         activeMap = false;
+        isDead = true;
     }
-    else if ( ch == '1' ){
-        hero->useWhisky();
+    return changed;
+}
+/*********************************************************/
+int MapPart::neighbour( int pos, const int &ch ){
+    int width = map->getWidth();
+    int height = map->getHeight();
+    if ( ch == KEY_UP || ch == 'w'){
+        if ( pos >= width ){
+            pos -= width;
+        }
     }
-    else if ( ch == '2' ){
-        hero->useSword();
+    else if ( ch == KEY_DOWN || ch == 's' ){
+        if ( (pos + width) < ( height * width ) ){
+            pos += width;
+        }
     }
-    else if ( ch == 'l' || ch == 'L' ){
-        activeMap = false;
-        showLegend = true;
+    else if ( ch == KEY_LEFT || ch == 'a' ){
+        if ( (pos % width ) != 0 ){
+            pos--;
+        }
     }
-    shared_ptr<MapElement> mapElem =  getMap()->getMap()->at(currPos);
-    if ( !(currPos != oldPos && hero->collide( mapElem, getMap()->getMap(), currPos) ) ){
-        if ( ( hlth > hero->getHealth() ) && (hero->getHealth() > 0) && ( mapElem->getSymbol() != '!') ){
+    else if ( ch == KEY_RIGHT || ch == 'd' ){
+        if ( ((pos+1) % width ) != 0 ){
+            pos++;
+        }
+    }
+    return pos;
+}
+/*********************************************************/
+bool MapPart::step( int oldPos, int hlth ){
+    Hero &hero = map->getHero();
+    char symbol = map->getSymbol(currPos);
+    int item = map->getTile(currPos).getItem();
+    // bump into edge or barrier isn't step, it has nothing to undo and turn doesn't go on
+    bool bumped = ( currPos == oldPos || hero.isBlocked( *map, currPos ) );
+    if ( !bumped ){
+        map->beginStep();
+    }
+    bool moved = ( !bumped && hero.collide( *map, currPos ) );
+    map->updateTile(currPos);
+    if ( !moved ){
+        if ( ( hlth > hero.getHealth() ) && (hero.getHealth() > 0) && ( symbol != '!') ){
             map->setCountEnemies();
         }
         currPos = oldPos;
 
     }else{
-        getMap()-> moveHero(currPos);
+        map->moveHero(currPos);
+        map->updateTile(oldPos);
+        if ( realTime != NULL ){
+            // item stays on map if hero can't carry more of them
+            realTime->steppedOn( *map, currPos, symbol, map->getTile(currPos).getItem() < 0 ? item : -1 );
+        }
+        if ( saving == true && world == NULL && dungeon == NULL ){
+            autoSave.moved( *map );
+        }
+    }
+    if ( map->takeMessage( triggerMessage ) ){
+        activeMap = false;
+    }
+    string npc;
+    if ( map->takeDialog( npc ) ){
+        openDialog( npc );
+    }
+    // messages of the last place are taken before map can be replaced
+    if ( moved && ( ( world != NULL && world->moved( map ) ) || ( dungeon != NULL && dungeon->moved( map ) ) ) ){
+        // hero left the middle chunk or took stairs, the same hero is on new window of world or level
+        currPos = map->getHeroPos();
+        data = shared_ptr<MapData>(nullptr);
+        if ( realTime != NULL ){
+            realTime->moved( *map );
+        }
+    }
+    return moved;
+}
+/*********************************************************/
+void MapPart::undo(){
+    Hero &hero = map->getHero();
+    map->undo(1);
+    // from death screen it goes back to the last step where hero was alive
+    while ( hero.getHealth() < 0 && map->undo(1) > 0 ){}
+    currPos = map->getHeroPos();
+    if ( hero.getHealth() >= 0 ){
+        isDead = false;
+        activeMap = true;
+    }
+}
+/*********************************************************/
+void MapPart::travel( const vector<int> &path ){
+    Hero &hero = map->getHero();
+    int width = map->getWidth();
+    const Map *current = map.get();
+    for ( int i = 0; i < (int)path.size(); ++i ){
+        int oldPos = currPos;
+        int hlth = hero.getHealth();
+        if ( path[i] == oldPos - width ){
+            map->setHeroDirection( KEY_UP );
+        } else if ( path[i] == oldPos + width ){
+            map->setHeroDirection( KEY_DOWN );
+        } else if ( path[i] == oldPos - 1 ){
+            map->setHeroDirection( KEY_LEFT );
+        } else {
+            map->setHeroDirection( KEY_RIGHT );
+        }
+        currPos = path[i];
+        // stop at fight, thorn, message, dialog, if there is nobody to kill or path isn't on map anymore
+        if ( !step( oldPos, hlth ) || hero.getHealth() < hlth || allKilled() ||
+             map.get() != current || !triggerMessage.empty() || dialogPart != NULL ){
+            break;
+        }
+    }
+}
+/*********************************************************/
+void MapPart::openDialog( const string &npc ){
+    Dialog dialog;
+    activeMap = false;
+    if ( DialogLibrary::open( C_DIALOG_FILE )->find( npc, dialog ) ){
+        dialogPart = shared_ptr<DialogPart>( new DialogPart ( npc, dialog, getCondition() ) );
+    } else {
+        triggerMessage += ( triggerMessage.empty() ? "" : "\n" ) + npc + " has nothing to say.";
     }
-    return getCondition();
+}
+/*********************************************************/
+bool MapPart::allKilled(){
+    return map->getCountEnemies() == 0 && world == NULL && ( dungeon == NULL || dungeon->getCountOthers() == 0 );
 }
 /*********************************************************/
 shared_ptr<ScreenData> MapPart::getScreenData(){
+    if ( dialogPart != NULL ){
+        return dialogPart->getScreenData();
+    }
     if ( activeMap == true){
         if ( data.get() == nullptr ){
-            MapData *mD = new MapData(getMap().get(), currPos);
+            MapData *mD = new MapData(getMap().get(), currPos, &autoSave, dungeon.get());
             data = shared_ptr<MapData>(mD);
         }
     }
@@ -100,13 +293,51 @@ shared_ptr<ScreenData> MapPart::getScreenData(){
         }
         else if ( isDead == true ){
             msg = "Sorry, you died\n";
+            if ( getMap()->getHistory().getCountSteps() > 0 && realTime == NULL ){
+                msg += "\nPress 'U' to undo your last steps.\nPress any other key to come back to main menu.\n";
+            }
             ms = shared_ptr<MessageData>(new MessageData ( msg ) );
         }
         else if ( showLegend == true ){
-            msg = "e = enemy you have to kill;\nw = whisky you can drink to augment your health;\ns = sword you can use to augment your damage;\n";
+            msg = "e = enemy you have to kill;\n";
+            const ItemRegistry &registry = ItemRegistry::get();
+            const char *skills[] = { "health", "damage", "defence" };
+            for ( int i = 0; i < registry.getCount() && i < C_LEGEND_ITEMS; ++i ){
+                const ItemType &type = registry.getType(i);
+                stringstream ss;
+                ss << type.symbol << " = " << type.name << " you can use to augment your " << skills[ type.skill - DELTA_HEALTH ] << " by " << type.value << ";\n";
+                msg += ss.str();
+            }
+            if ( registry.getCount() > C_LEGEND_ITEMS ){
+                msg += "... and other items;\n";
+            }
+            if ( dungeon != NULL ){
+                msg += "% = stairs to other level of dungeon;\n";
+            }
             msg += "! = thorn, be careful, it's pain for you;\n# = barrier you cannot pass. Really. I don't fool you.\n\n(Press any key to continue...)\n";
             ms = shared_ptr<MessageData>(new MessageData ( msg ) );
         }
+        else if ( showSaved == true ){
+            if ( world != NULL ){
+                msg = ( savedWorld == true ) ? "World was saved.\n" : "Some chunks of world couldn't be written, they are lost.\n";
+            } else if ( dungeon != NULL && saving == true ){
+                msg = "Dungeon can't be saved, its levels are kept only during game.\n";
+            } else if ( saving == false ){
+                msg = "Saving of games is turned off.\n";
+            } else if ( !startedSave ){
+                msg = "Previous saving isn't finished yet, try it again later.\n";
+            } else if ( manualSave.isRunning() ){
+                msg = "Game is being saved...\n";
+            } else {
+                msg = manualSave.isFailed() ? "Game couldn't be saved.\n" : "Game was saved.\n";
+            }
+            msg += "\n(Press any key to continue...)\n";
+            ms = shared_ptr<MessageData>(new MessageData ( msg ) );
+        }
+        else if ( !triggerMessage.empty() ){
+            msg = triggerMessage + "\n\n(Press any key to continue...)\n";
+            ms = shared_ptr<MessageData>(new MessageData ( msg ) );
+        }
        else {
             ms = shared_ptr<MessageData> (new MessageData ( arguments[1].c_str() ) );
         }
@@ -117,8 +348,41 @@ shared_ptr<ScreenData> MapPart::getScreenData(){
 /*********************************************************/
 shared_ptr<Map> MapPart::getMap(){
     if (map == NULL) {
-        map =  shared_ptr<Map>( new Map( arguments[0], this->createHero() ) );
+        map = this->createMap();
+        if ( realTimeOn == true ){
+            realTime = shared_ptr<RealTime>( new RealTime );
+            realTime->start( *map );
+        }
     }
     return map;
 }
 /*********************************************************/
+shared_ptr<Map> MapPart::createMap(){
+    if ( worldOn == true ){
+        world = shared_ptr<ChunkWorld>( new ChunkWorld ( worldSeed ) );
+        return world->create( this->createHero() );
+    }
+    if ( dungeonOn == true ){
+        dungeon = shared_ptr<Dungeon>( new Dungeon ( arguments[0] ) );
+        return dungeon->create( this->createHero() );
+    }
+    return MapLibrary::create( arguments[0], this->createHero() );
+}
+/*********************************************************/
+/*********************************************************/
+void MapPart::setSaving( bool isOn ){
+    saving = isOn;
+}
+/*********************************************************/
+void MapPart::setRealTime( bool isOn ){
+    realTimeOn = isOn;
+}
+/*********************************************************/
+void MapPart::setWorld( bool isOn, uint64_t seed ){
+    worldOn = isOn;
+    worldSeed = seed;
+}
+/*********************************************************/
+void MapPart::setDungeon( bool isOn ){
+    dungeonOn = isOn;
+}
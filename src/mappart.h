@@ -8,8 +8,15 @@
 #ifndef MAPPART_H
 #define MAPPART_H
 #include <fstream>
+#include <sstream>
 #include "part.h"
+#include "savegame.h"
+#include "autosave.h"
+#include "realtime.h"
+#include "chunkworld.h"
+#include "dungeon.h"
 using namespace std;
+#define C_LEGEND_ITEMS  10      // max count of item types in legend
 /**********************************************************************************************/
 /**
  * @brief The MapPart is abstruct class
@@ -21,6 +28,10 @@ class MapPart : public GamePart{
          * @brief MapPart is implicit constructor
          */
         MapPart();
+        /**
+         * @brief ~MapPart is destruktor, changes of procedural world are stored
+         */
+        virtual ~MapPart();
         /**
          * @brief getCondition is abstruct method
          * @return nothing
@@ -32,11 +43,21 @@ class MapPart : public GamePart{
          * @return nothing
          */
         virtual GameCondition handleKey( const int &ch);
+        /**
+         * @brief update runs timed events of real-time mode and notices finished save of game
+         * @return true if something happened on map or save was finished
+         */
+        bool update();
         /**
          * @brief createHero
          * @return
          */
         virtual shared_ptr<Hero> createHero() = 0;
+        /**
+         * @brief createMap builds map from map file (MapLibrary), window of procedural world or the first level of dungeon with hero from createHero
+         * @return pointer at map
+         */
+        virtual shared_ptr<Map> createMap();
         /**
          * @brief getScreenData is getter od currient screen data
          * @return nothing
@@ -47,16 +68,87 @@ class MapPart : public GamePart{
          * @return map
          */
         shared_ptr<Map> getMap();
+        /**
+         * @brief setSaving turns saving and autosave of game on or off
+         * @param isOn is true if game can be saved
+         */
+        void setSaving( bool isOn );
+        /**
+         * @brief setRealTime turns real-time mode on or off, it has to be set before map is created
+         * @param isOn is true if world goes on without keys
+         */
+        void setRealTime( bool isOn );
+        /**
+         * @brief setWorld turns procedural world instead of map file on or off, it has to be set before map is created
+         * @param isOn is true for procedural world
+         * @param seed is seed of world
+         */
+        void setWorld( bool isOn, uint64_t seed );
+        /**
+         * @brief setDungeon turns dungeon instead of map file on or off, it has to be set before map is created
+         * @param isOn is true if map file is manifest of dungeon
+         */
+        void setDungeon( bool isOn );
     protected:
         vector<string> arguments;
     private:
         bool activeMap;
         bool showLegend;
+        bool showSaved;
+        bool savedWorld;                        // all chunks of world were written
+        bool saving;
         bool isDead;
         bool isWin;
+        bool realTimeOn;
+        bool worldOn;
+        bool dungeonOn;
+        string triggerMessage;                      // message of triggers of last key, shown instead of map
+        shared_ptr<DialogPart> dialogPart;          // dialog with NPC begun by trigger, it gets keys until its end
+        uint64_t worldSeed;
+        shared_ptr<ChunkWorld> world;               // NULL if map is from map file
+        shared_ptr<Dungeon> dungeon;                // NULL if map isn't level of dungeon
         shared_ptr<Map> map;
+        shared_ptr<RealTime> realTime;              // NULL in turn-based game
         shared_ptr<MapData> data;
+        AutoSave autoSave;
+        AutoSave manualSave;                    // game saved by key, it is written in background too
+        bool startedSave;                       // manualSave began, otherwise previous one wasn't finished
         int currPos;
+        /**
+         * @brief neighbour counts where the hero goes by key
+         * @param pos is currient position of the hero
+         * @param ch is value of pressed key (arrows or WASD)
+         * @return new position or the same one on the border of map
+         */
+        int neighbour( int pos, const int &ch );
+        /**
+         * @brief step moves the hero from oldPos to currPos, hero collides with element on currPos
+         * @param oldPos is position where hero was
+         * @param hlth is hero's health before step
+         * @return true if hero moved, false if he stays (barrier, fight)
+         */
+        bool step( int oldPos, int hlth );
+        /**
+         * @brief undo takes back last step of hero, after death it goes back to the last step where hero lived
+         */
+        void undo();
+        /**
+         * @brief travel goes through all steps of path without render between them
+         * @detailed it stops at fight, at thorn or if game is won
+         * @param path is positions of steps from PathFinder
+         */
+        void travel( const vector<int> &path );
+        /**
+         * @brief openDialog begins dialog of NPC from dialogs file C_DIALOG_FILE
+         * @param npc is name of NPC
+         * @throw exception if dialogs can't be compiled or read
+         */
+        void openDialog( const string &npc );
+        /**
+         * @brief allKilled says if there is nobody to kill, procedural world never ends
+         * @return true if game is won
+         */
+        bool allKilled();
 };
 /**********************************************************************************************/
 /**
@@ -132,4 +224,42 @@ class HeroPart : public MapPart{
     private:
         int health, damage, defence;
 };
+/**********************************************************************************************/
+/**
+ * @brief The LoadPart class
+ * @detailed Descendant class of MapPart, game continues from the newest saved snapshot
+ */
+class LoadPart : public MapPart{
+    public:
+        /**
+         * @brief LoadPart is is constructor with parameters
+         * @param arg are arguments from command line to show quest
+         */
+        LoadPart( vector<string> &arg ){
+            MapPart::arguments = arg;
+        }
+        /**
+         * @brief getCondition is getter of currient condition
+         * @return condition of loaded Game
+         */
+        GameCondition getCondition(){
+            return LOADGAME;
+        }
+        /**
+         * @brief createHero makes hero as he was saved
+         * @return point on hero
+         */
+        shared_ptr<Hero> createHero(){
+            SaveGame save ( SaveGame::latest() );
+            return save.createHero();
+        }
+        /**
+         * @brief createMap makes map as it was saved
+         * @return point on map
+         */
+        shared_ptr<Map> createMap(){
+            SaveGame save ( SaveGame::latest() );
+            return save.createMap();
+        }
+};
 #endif // MAPPART_H
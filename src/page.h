@@ -1,6 +1,6 @@
 /** @file screencontroller.h
  * Header file and implementation family of classes:
- * ScreenPage -> MenuPage, CreateHeroPage, MapPage
+ * ScreenPage -> MenuPage, CreateHeroPage, MapPage, DialogPage
  *
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
  */
@@ -10,9 +10,8 @@
 #include <vector>
 #include <string>
 #include "data.h"
+#include "canvas.h"
 using namespace std;
-#define C_WIDTH 40                  // width size of camera, for shows part of map on screen
-#define C_HEIGHT 20                 // height
 /**********************************************************************************************/
 /**
  * @brief The ScreenPage class
@@ -26,8 +25,9 @@ class ScreenPage{
         virtual ~ScreenPage(){}
          /**
          * @brief show is abstruct method to show pages on screen by descendant classes
+         * @param canvas is surface to draw on (terminal or memory)
          */
-        virtual void show() const = 0;
+        virtual void show( Canvas &canvas ) const = 0;
 };
 /**********************************************************************************************/
 /**
@@ -44,19 +44,20 @@ class MenuPage : public  ScreenPage {
         /**
          * @brief show is method for show menu on screen
          * @detailed using nrurses functions
+         * @param canvas is surface to draw on
          */
-        void show() const {
-            attron(COLOR_PAIR(1));
-            printw("========= MENU =========\n");
+        void show( Canvas &canvas ) const {
+            canvas.attrOn(COLOR_PAIR(1));
+            canvas.print("========= MENU =========\n");
             for( int i = 0; i < (int)md.getMenuItems().size(); ++i ){
                 if ( md.getCurrentMenuItem() == i) {
-                    attron(COLOR_PAIR(2));
+                    canvas.attrOn(COLOR_PAIR(2));
                 } else {
-                    attron(COLOR_PAIR(1));
+                    canvas.attrOn(COLOR_PAIR(1));
                 }
-                printw("   %s  \n", md.getMenuItems()[i].c_str());
+                canvas.print("   %s  \n", md.getMenuItems()[i].c_str());
             }
-            attron(COLOR_PAIR(1));
+            canvas.attrOn(COLOR_PAIR(1));
             printw ("========================\n");
         }
     private:
@@ -77,11 +78,12 @@ class MessagePage : public ScreenPage {
         MessagePage( const MessageData &msd ) : msd(msd) {}
         /**
          * @brief show is method for show message on screen
+         * @param canvas is surface to draw on
          */
-        void show() const {
-            printw("============================================\n");
-            printw("%s", msd.getMessage().c_str());
-            printw("============================================\n");
+        void show( Canvas &canvas ) const {
+            canvas.print("============================================\n");
+            canvas.print("%s", msd.getMessage().c_str());
+            canvas.print("============================================\n");
         }
     private:
         MessageData msd;
@@ -100,22 +102,23 @@ class CreateHeroPage : public ScreenPage {
         CreateHeroPage ( CreateHeroData &chd ) : chd(chd){}
         /**
          * @brief show is method for show creation menu of hero on screen
+         * @param canvas is surface to draw on
          */
-        void show() const {
-            printw("===============HERO CREATION=======================\n");
+        void show( Canvas &canvas ) const {
+            canvas.print("===============HERO CREATION=======================\n");
             for ( int i = 0; i < (int)chd.getSkills().size(); ++i ){
                  if ( chd.getCurrSkill() == i ){
-                     attron(COLOR_PAIR(2));
-                     printw( "%s: %d + -\n", chd.getSkills()[i].first.c_str(), chd.getSkills()[i].second );
+                     canvas.attrOn(COLOR_PAIR(2));
+                     canvas.print( "%s: %d + -\n", chd.getSkills()[i].first.c_str(), chd.getSkills()[i].second );
                  } else{
-                    attron(COLOR_PAIR(1));
-                    printw( "%s: %d\n", chd.getSkills()[i].first.c_str(), chd.getSkills()[i].second );
+                    canvas.attrOn(COLOR_PAIR(1));
+                    canvas.print( "%s: %d\n", chd.getSkills()[i].first.c_str(), chd.getSkills()[i].second );
                  }
             }
-            attron(COLOR_PAIR(1));
-            printw("\nLeft points: %d\n", chd.getPoints());
-            printw("===================================================\n");
-            printw("Use '+' (or '>') and '-' (or '<') keys to augment or diminish the Hero skills.\nPress ENTER to continue a game or ESC to come back at the Main Menu.\n\n");
+            canvas.attrOn(COLOR_PAIR(1));
+            canvas.print("\nLeft points: %d\n", chd.getPoints());
+            canvas.print("===================================================\n");
+            canvas.print("Use '+' (or '>') and '-' (or '<') keys to augment or diminish the Hero skills.\nPress ENTER to continue a game or ESC to come back at the Main Menu.\n\n");
         }
     private:
         CreateHeroData chd;
@@ -134,32 +137,59 @@ class MapPage : public ScreenPage{
         MapPage ( const MapData &mpd) : mpd(mpd) {}
         /**
          * @brief show is method for show map and all hero's and game's states on screen
+         * @param canvas is surface to draw on
          */
-        void show() const{
+        void show( Canvas &canvas ) const{
             Map *map = mpd.getMap();
 //            int w = mpd.getHeroIndex() % map->getWidth();
 //            int h = mpd.getHeroIndex() / map->getWidth();
-//            printw("I'm on (%d, %d)\n", h, w);
-            attron(A_BOLD);
-            printw("%s\n", map->getHeroName().c_str() );
-            attroff(A_BOLD);
+//            canvas.print("I'm on (%d, %d)\n", h, w);
+            canvas.attrOn(A_BOLD);
+            canvas.print("%s\n", map->getHeroName().c_str() );
+            canvas.attrOff(A_BOLD);
             if ( map->getHeroHealth() < 0 ){
-                printw("  Health:  0\n" );
+                canvas.print("  Health:  0\n" );
             }else {
-                printw("  Health:  %d\n", map->getHeroHealth() );
+                canvas.print("  Health:  %d\n", map->getHeroHealth() );
             }
-            printw("  Damage:  %d\n", map->getHeroDamage() );
-            printw("  Defence: %d\n", map->getHeroDefence() );
-            printw("\nInventory:\n");
-            printw("  Whisky: %d\n", map->getConutWhisky());
-            printw("  Swords: %d\n", map->getCountSword());
-            printw("\n\nEnemies to kill: ");
-            attron(A_BOLD);
-            printw("%d\n\n", map->getCountEnemies() );
-            attroff(A_BOLD);
-            string howTo = "\nUse arrows or WASD to move on.\nPress 'q' to show your task.\n'1' key to drink whisky (+health).\n'2' to equip sword (+damage).\n";
-            howTo += "'L' to show map legend.\n\nPress ESC come back to main menu.\n";
-            printw("%s\n", howTo.c_str());
+            canvas.print("  Damage:  %d\n", map->getHeroDamage() );
+            canvas.print("  Defence: %d\n", map->getHeroDefence() );
+            if ( mpd.getDungeon() != NULL ){
+                canvas.print("  Level:   %s\n", mpd.getDungeon()->getLevelName().c_str() );
+            }
+            canvas.print("\nInventory:\n");
+            const Inventory &inventory = map->getInventory();
+            for ( int i = 0; i < inventory.getSize() && i < 9; ++i ){
+                const ItemType &type = ItemRegistry::get().getType( inventory.at(i).item );
+                canvas.print("  %d %s: %d\n", i + 1, type.name.c_str(), inventory.at(i).count);
+            }
+            if ( inventory.getSize() == 0 ){
+                canvas.print("  (empty)\n");
+            }
+            canvas.print("\n\nEnemies to kill: ");
+            canvas.attrOn(A_BOLD);
+            canvas.print("%d\n", map->getCountEnemies() );
+            canvas.attrOff(A_BOLD);
+            if ( map->getCountComing() > 0 ){
+                canvas.print("  (%d of them will come)\n", map->getCountComing() );
+            }
+            if ( mpd.getDungeon() != NULL && mpd.getDungeon()->getCountOthers() > 0 ){
+                canvas.print("  (%d more on other levels)\n", mpd.getDungeon()->getCountOthers() );
+            }
+            canvas.print("\n");
+            const DeltaLog &history = map->getHistory();
+            canvas.print("Undo: %d steps (%d/%d KB)\n", history.getCountSteps(),
+                   (int)( history.getMemory() / 1024 ), (int)( history.getMaxMemory() / 1024 ) );
+            const AutoSave *autoSave = mpd.getAutoSave();
+            if ( autoSave != NULL && autoSave->getCountSaves() > 0 ){
+                canvas.print("Autosave: %lld KB, stall %lld us\n", ( autoSave->getSize() + 1023 ) / 1024, autoSave->getStall() );
+            } else {
+                canvas.print("\n");
+            }
+            string howTo = "Use arrows or WASD to move on.\nPress 'q' to show your task.\n'1'-'9' to use item of inventory.\n'U' to undo last step.\n";
+            howTo += "'E' to go to nearest enemy.\n'I' to go to nearest item.\nClick on map to go there.\n";
+            howTo += "'L' to show map legend.\n'K' to save the game.\n\nPress ESC come back to main menu.\n";
+            canvas.print("%s\n", howTo.c_str());
             string border = "##";
             for (int i = 0; i < C_WIDTH && i < map->getWidth(); ++i ){
                 border += '#';
@@ -167,51 +197,81 @@ class MapPage : public ScreenPage{
             int width = map->getWidth();
             int height = map->getHeight();
             int cX = 0, cY = 0;
-            cX = mpd.getHeroIndex() % width - C_WIDTH/2;
-            cY = mpd.getHeroIndex() / width - C_HEIGHT/2;
-            if ( cX+C_WIDTH > width ){
-                cX = width - C_WIDTH;
-            }
-            if ( cY+C_HEIGHT > height ){
-                cY = height - C_HEIGHT;
-            }
-            if ( cX < 0 ) {
-                cX = 0;
-            }
-            if ( cY < 0 ){
-                cY = 0;
-            }
-            int posX = 35;
-            int posY = 0;
-            move(posY, posX);
-            printw( "%s\n", border.c_str() );
+            mpd.getCamera( cX, cY );
+            int posX = C_POSX;
+            int posY = C_POSY;
+            canvas.moveTo(posY, posX);
+            canvas.print( "%s\n", border.c_str() );
             int tmpY = 0;
             for ( int y = cY; y < cY+C_HEIGHT && y < height; ++y ){
-                move( posY+1+tmpY, posX);
-                printw("#");
+                canvas.moveTo( posY+1+tmpY, posX);
+                canvas.print("#");
                 for ( int x = cX; x < cX+C_WIDTH && x < width; x++ ){
-                    char sym = (*map->getMap())[x+y*width]->getSymbol();
+                    char sym = map->getSymbol( x+y*width );
                     if ( sym == 'v' || sym == '<' ||
                          sym == '>' || sym == '^'){
-                        attron(COLOR_PAIR(3));
+                        canvas.attrOn(COLOR_PAIR(3));
                     }
                     else if (sym == 'e' ){
-                        attron(COLOR_PAIR(4));
+                        canvas.attrOn(COLOR_PAIR(4));
                     }
-                    else if ( ( sym == 'w' ) || ( sym == 's' ) ){
-                        attron(COLOR_PAIR(5));
+                    else if ( ItemRegistry::get().isSymbol( sym ) ){
+                        canvas.attrOn(COLOR_PAIR(5));
                     }
-                    printw("%c", sym );
-                    attron(COLOR_PAIR(1));
+                    canvas.print("%c", sym );
+                    canvas.attrOn(COLOR_PAIR(1));
                 }
-                printw("#\n");
+                canvas.print("#\n");
                 tmpY++;
             }
-            move(posY+1+tmpY, posX);
-            printw( "%s\n", border.c_str() );
+            canvas.moveTo(posY+1+tmpY, posX);
+            canvas.print( "%s\n", border.c_str() );
         }
     private:
         MapData mpd;
 };
 /**********************************************************************************************/
+/**
+ * @brief The DialogPage class
+ * @detailed Descendant class of ScreenPage, shows what NPC says and answers of hero
+ */
+class DialogPage : public ScreenPage{
+    public:
+        /**
+         * @brief DialogPage is constructor with parameters
+         * @param dd is dialog data to show
+         */
+        DialogPage( const DialogData &dd ) : dd(dd) {}
+        /**
+         * @brief show is method for show dialog on screen
+         * @param canvas is surface to draw on
+         */
+        void show( Canvas &canvas ) const{
+            canvas.attrOn(COLOR_PAIR(1));
+            canvas.print("============================================\n");
+            canvas.attrOn(A_BOLD);
+            canvas.print("%s:\n", dd.getNpc().c_str());
+            canvas.attrOff(A_BOLD);
+            canvas.print("%s\n\n", dd.getText().c_str());
+            const vector<string> &choices = dd.getChoices();
+            for ( int i = 0; i < (int)choices.size(); ++i ){
+                if ( dd.getCurrChoice() == i ){
+                    canvas.attrOn(COLOR_PAIR(2));
+                } else {
+                    canvas.attrOn(COLOR_PAIR(1));
+                }
+                canvas.print("   %s  \n", choices[i].c_str());
+            }
+            canvas.attrOn(COLOR_PAIR(1));
+            canvas.print("============================================\n");
+            if ( choices.empty() ){
+                canvas.print("(Press any key to continue...)\n");
+            } else {
+                canvas.print("Use arrows to choose an answer and ENTER to say it.\nPress ESC to end the dialog.\n");
+            }
+        }
+    private:
+        DialogData dd;
+};
+/**********************************************************************************************/
 #endif // PAGE_H
@@ -1,6 +1,6 @@
 /** @file part.h
  * Header file and implementation family of classes:
- * GamePart class -> CreateHeroPart class.
+ * GamePart class -> CreateHeroPart class, DialogPart class.
  *                -> MenuPart class -> HeroesPart class, AboutPart, ExitPart, UnusablePart, MainMenu.
  *
  *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
@@ -13,6 +13,7 @@
 #include <utility>
 #include <ncurses.h>
 #include "data.h"
+#include "dialog.h"
 #define C_SKILL_POINTS 200          // skill points user can allocate
 #define C_MIN_SKILLS    50          // skills game begins with
 using namespace std;
@@ -23,6 +24,7 @@ using namespace std;
 enum GameCondition{
     GAMECHUCK,
     GAMEHERO,
+    LOADGAME,
     CUSTUMHERO,
     ABOUT,
     HEROES,
@@ -52,6 +54,13 @@ class GamePart{
          * @return screen data to show
          */
         virtual shared_ptr<ScreenData>getScreenData() = 0;
+        /**
+         * @brief update lets part go on without key (real-time mode)
+         * @return true if screen has to be drawn again
+         */
+        virtual bool update(){
+            return false;
+        }
 };
 /**********************************************************************************************/
 /**
@@ -134,6 +143,69 @@ class CreateHeroPart: public GamePart {
         vector<pair<string, int>> skills;       //health, damage, defence
 };
 /**********************************************************************************************/
+/**
+ * @brief The DialogPart class
+ * @detailed Descendant class of GamePart, uses for dialog with NPC inside of game on map
+ */
+class DialogPart : public GamePart {
+    public:
+        /**
+         * @brief DialogPart is constructor with parameters, dialog begins by its first node
+         * @param npc is name of NPC
+         * @param dialog is dialog of NPC
+         * @param condition is condition of game which dialog keeps
+         */
+        DialogPart( const string &npc, const Dialog &dialog, GameCondition condition ) :
+            npc(npc), dialog(dialog), condition(condition), node(0), currChoice(0) {}
+        /**
+         * @brief handleKey is method for control keys and choose answers
+         * @param ch is value of pressed key
+         * @return condition of game, it doesn't change
+         */
+        GameCondition handleKey ( const int &ch ){
+            int count = dialog.getCountChoices( node );
+            if ( count == 0 || ch == 27 ){
+                node = C_DIALOG_END;
+            }
+            else if ( ch == KEY_UP ){
+                currChoice = ( currChoice > 0 ) ? currChoice - 1 : count - 1;
+            }
+            else if ( ch == KEY_DOWN ){
+                currChoice = ( currChoice < count - 1 ) ? currChoice + 1 : 0;
+            }
+            else if ( ch == '\n' ){
+                node = dialog.getTarget( node, currChoice );
+                currChoice = 0;
+            }
+            return condition;
+        }
+        /**
+         * @brief getScreenData is getter of dialog data
+         * @return dialog data of currient node
+         */
+        shared_ptr<ScreenData>getScreenData() {
+            vector<string> choices;
+            for ( int i = 0; i < dialog.getCountChoices( node ); ++i ){
+                choices.push_back( dialog.getChoice( node, i ) );
+            }
+            shared_ptr<DialogData> dd ( new DialogData ( npc, dialog.getText( node ), choices, currChoice ) );
+            return dd;
+        }
+        /**
+         * @brief isOpen says if dialog goes on
+         * @return false after the end of dialog
+         */
+        bool isOpen() const{
+            return node != C_DIALOG_END;
+        }
+    private:
+        string npc;
+        Dialog dialog;
+        GameCondition condition;
+        int node;                               // currient node or C_DIALOG_END
+        int currChoice;
+};
+/**********************************************************************************************/
 /**
  * @brief The MenuPart class
  * @detailed Descendant class of GamePart, uses for forming of Game menus
@@ -338,6 +410,7 @@ class MainMenu : public MenuPart {
          */
         MainMenu()  {
             menuItems.push_back("New Game");
+            menuItems.push_back("Load Game");
             menuItems.push_back("About");
             menuItems.push_back("Exit");
             MenuPart::currentItem = 0;
@@ -351,8 +424,9 @@ class MainMenu : public MenuPart {
             if (ch == '\n'){
                 switch(currentItem){
                     case 0: return HEROES;
-                    case 1: return ABOUT;
-                    case 2: return EXIT;
+                    case 1: return LOADGAME;
+                    case 2: return ABOUT;
+                    case 3: return EXIT;
                     default: break;
                 }
             }
@@ -0,0 +1,195 @@
+/** @file pathfinder.cpp
+ * Implementation of NavGrid class and PathFinder class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <queue>
+#include <algorithm>
+#include <cstdlib>
+#include "pathfinder.h"
+#include "map.h"
+/**********************************************************************************************/
+NavGrid::NavGrid( const Map &map ) : map(map){
+    width = map.getWidth();
+    height = map.getHeight();
+    cells.resize(width*height);
+    for ( int i = 0; i < width*height; ++i ){
+        cells[i] = kindOf( map.getSymbol(i) );
+    }
+}
+/*********************************************************/
+void NavGrid::update( int index ){
+    cells[index] = kindOf( map.getSymbol(index) );
+}
+/*********************************************************/
+unsigned char NavGrid::kindOf( char symbol ){
+    if ( ItemRegistry::get().isSymbol( symbol ) ){
+        return NAV_ITEM;
+    }
+    switch ( symbol ){
+        case '!':   return NAV_THORN;
+        case 'e':   return NAV_ENEMY;
+        case '#':   return NAV_BLOCKED;
+    }
+    return NAV_FREE;                            // empty place or hero
+}
+/**********************************************************************************************/
+bool PathFinder::findPath( int from, int to, vector<int> &path ){
+    path.clear();
+    int width = grid.getWidth();
+    if ( from == to || to < 0 || to >= width*grid.getHeight() || grid.at(to) == NAV_BLOCKED ){
+        return false;
+    }
+    goal = to;
+    nodes.clear();
+    // open list is ordered by f = g + h and by longer g at the same f, so
+    // search goes straight to target on open areas; pairs are (-f, (g, index))
+    priority_queue<pair<int, pair<int,int> > > open;
+    Node start = { 0, -1, false };
+    nodes[from] = start;
+    open.push( make_pair( -distance(from, to), make_pair( 0, from ) ) );
+    bool found = false;
+    while ( !open.empty() ){
+        int curr = open.top().second.second;
+        open.pop();
+        Node &node = nodes[curr];
+        if ( node.closed ){
+            continue;                           // old record with worse f
+        }
+        node.closed = true;
+        if ( curr == to ){
+            found = true;
+            break;
+        }
+        int x = curr % width, y = curr / width;
+        int dirs[4][2];
+        int countDirs = 0;
+        if ( node.parent < 0 ){                 // start has all four directions
+            int all[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+            for ( int i = 0; i < 4; ++i ){
+                dirs[countDirs][0] = all[i][0];
+                dirs[countDirs++][1] = all[i][1];
+            }
+        } else {                                // pruned neighbours by direction of coming
+            int px = node.parent % width, py = node.parent / width;
+            int dx = ( x > px ) - ( x < px );
+            int dy = ( y > py ) - ( y < py );
+            if ( dx != 0 ){
+                int d[3][2] = { {0,-1}, {0,1}, {dx,0} };
+                for ( int i = 0; i < 3; ++i ){
+                    dirs[countDirs][0] = d[i][0];
+                    dirs[countDirs++][1] = d[i][1];
+                }
+            } else {
+                int d[3][2] = { {-1,0}, {1,0}, {0,dy} };
+                for ( int i = 0; i < 3; ++i ){
+                    dirs[countDirs][0] = d[i][0];
+                    dirs[countDirs++][1] = d[i][1];
+                }
+            }
+        }
+        int g = node.g;
+        for ( int i = 0; i < countDirs; ++i ){
+            int jp = jump( x + dirs[i][0], y + dirs[i][1], dirs[i][0], dirs[i][1] );
+            if ( jp < 0 ){
+                continue;
+            }
+            int ng = g + distance( curr, jp );
+            unordered_map<int, Node>::iterator it = nodes.find(jp);
+            if ( it == nodes.end() ){
+                Node n = { ng, curr, false };
+                nodes[jp] = n;
+            } else if ( it->second.closed || it->second.g <= ng ){
+                continue;
+            } else {
+                it->second.g = ng;
+                it->second.parent = curr;
+            }
+            open.push( make_pair( -( ng + distance(jp, to) ), make_pair( ng, jp ) ) );
+        }
+    }
+    goal = -1;
+    if ( !found ){
+        return false;
+    }
+    // jump points are on straight lines, fill all steps between them
+    for ( int curr = to; curr != from; curr = nodes[curr].parent ){
+        int prev = nodes[curr].parent;
+        int step = ( curr % width != prev % width ) ? ( curr > prev ? 1 : -1 ) : ( curr > prev ? width : -width );
+        for ( int i = curr; i != prev; i -= step ){
+            path.push_back(i);
+        }
+    }
+    reverse( path.begin(), path.end() );
+    return true;
+}
+/*********************************************************/
+int PathFinder::findNearest( int from, unsigned char kind, vector<int> &path ){
+    path.clear();
+    int width = grid.getWidth(), height = grid.getHeight();
+    parents.assign( width*height, -1 );
+    frontier.clear();
+    frontier.push_back( from );
+    parents[from] = from;
+    int best = -1;
+    // every step is one place, so the first place of kind taken from frontier is the nearest one
+    for ( int i = 0; i < (int)frontier.size() && best < 0; ++i ){
+        int curr = frontier[i];
+        int x = curr % width, y = curr / width;
+        int next[4] = { y > 0 ? curr - width : -1, y < height - 1 ? curr + width : -1,
+                        x > 0 ? curr - 1 : -1, x < width - 1 ? curr + 1 : -1 };
+        for ( int d = 0; d < 4 && best < 0; ++d ){
+            int n = next[d];
+            if ( n < 0 || parents[n] >= 0 ){
+                continue;
+            }
+            if ( grid.at(n) == kind ){
+                parents[n] = curr;
+                best = n;
+            } else if ( grid.at(n) <= NAV_ITEM ){
+                parents[n] = curr;
+                frontier.push_back( n );
+            }
+        }
+    }
+    if ( best < 0 ){
+        return -1;
+    }
+    for ( int curr = best; curr != from; curr = parents[curr] ){
+        path.push_back( curr );
+    }
+    reverse( path.begin(), path.end() );
+    return best;
+}
+/*********************************************************/
+int PathFinder::jump( int x, int y, int dx, int dy ) const{
+    int width = grid.getWidth();
+    while ( walkable(x, y) ){
+        if ( x+y*width == goal ){
+            return goal;
+        }
+        if ( dx != 0 ){
+            if ( ( walkable(x, y-1) && !walkable(x-dx, y-1) ) ||
+                 ( walkable(x, y+1) && !walkable(x-dx, y+1) ) ){
+                return x+y*width;
+            }
+        } else {
+            if ( ( walkable(x-1, y) && !walkable(x-1, y-dy) ) ||
+                 ( walkable(x+1, y) && !walkable(x+1, y-dy) ) ){
+                return x+y*width;
+            }
+            // moving vertically has to check horizontal jump points
+            if ( jump(x+1, y, 1, 0) >= 0 || jump(x-1, y, -1, 0) >= 0 ){
+                return x+y*width;
+            }
+        }
+        x += dx;
+        y += dy;
+    }
+    return -1;
+}
+/*********************************************************/
+int PathFinder::distance( int a, int b ) const{
+    int width = grid.getWidth();
+    return abs( a % width - b % width ) + abs( a / width - b / width );
+}
@@ -0,0 +1,153 @@
+/** @file pathfinder.h
+ * Header file of NavGrid class and PathFinder class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+#include <vector>
+#include <unordered_map>
+using namespace std;
+class Map;
+/**********************************************************************************************/
+/**
+ * @brief The kinds of cells on navigation grid
+ */
+enum NavCell{
+    NAV_FREE,               //<Empty place or hero, hero can go there
+    NAV_ITEM,               //<Item, hero can go there and pick it up
+    NAV_THORN,              //<Thorn, hero avoids it, but it can be a target
+    NAV_ENEMY,              //<Enemy, only a target (there is a fight)
+    NAV_BLOCKED             //<Barrier, nobody can go there
+};
+/**********************************************************************************************/
+/**
+ * @brief The NavGrid class
+ * @detailed compact copy of map (one byte for each place) for fast searching of paths;
+ *           it has to be updated by Map::updateTile, when some place on map changes
+ */
+class NavGrid{
+    public:
+        /**
+         * @brief NavGrid is constructor with parameters, reads all places of map
+         * @param map is map to navigate on
+         */
+        NavGrid( const Map &map );
+        /**
+         * @brief update reads one place of map again
+         * @param index is position on map
+         */
+        void update( int index );
+        /**
+         * @brief getWidth is getter for grid's width
+         * @return width of grid
+         */
+        int getWidth() const{
+            return width;
+        }
+        /**
+         * @brief getHeight is getter for grid's height
+         * @return height of grid
+         */
+        int getHeight() const{
+            return height;
+        }
+        /**
+         * @brief at is getter of cell kind
+         * @param index is position on map
+         * @return kind of cell (NavCell)
+         */
+        unsigned char at( int index ) const{
+            return cells[index];
+        }
+        /**
+         * @brief isWalkable says if hero can go through this place
+         * @param x is column
+         * @param y is row
+         * @return true for free places and items inside of the grid
+         */
+        bool isWalkable( int x, int y ) const{
+            return x >= 0 && y >= 0 && x < width && y < height && cells[x+y*width] <= NAV_ITEM;
+        }
+        /**
+         * @brief getMemory is getter of memory used by grid
+         * @return size in bytes
+         */
+        size_t getMemory() const{
+            return cells.capacity();
+        }
+    private:
+        const Map &map;
+        int width, height;
+        vector<unsigned char> cells;
+        /**
+         * @brief kindOf translates symbol of map element to kind of cell
+         * @param symbol is symbol of map element
+         * @return kind of cell
+         */
+        static unsigned char kindOf( char symbol );
+};
+/**********************************************************************************************/
+/**
+ * @brief The PathFinder class
+ * @detailed Jump Point Search on 4-connected grid with uniform cost of step.
+ *           It keeps only jump points in open and closed list, so long straight corridors
+ *           and empty areas cost almost nothing.
+ */
+class PathFinder{
+    public:
+        /**
+         * @brief PathFinder is constructor with parameters
+         * @param grid is navigation grid to search on
+         */
+        PathFinder( const NavGrid &grid ) : grid(grid), goal(-1) {}
+        /**
+         * @brief findPath finds the shortest path between two places
+         * @detailed target can be also an enemy or thorn, then it is the last step of path
+         * @param from is start position (hero)
+         * @param to is target position
+         * @param path is output, positions of all steps, without start and with target
+         * @return false if there isn't any path
+         */
+        bool findPath( int from, int to, vector<int> &path );
+        /**
+         * @brief findNearest finds the nearest (by length of path) place of some kind
+         * @detailed one breadth-first search from start, it stops at the first place of kind
+         * @param from is start position (hero)
+         * @param kind is kind of target place (NavCell)
+         * @param path is output, positions of all steps to nearest place
+         * @return position of nearest place or -1 if it is unreachable or there isn't any
+         */
+        int findNearest( int from, unsigned char kind, vector<int> &path );
+    private:
+        /**
+         * @brief The Node struct is jump point in open or closed list
+         */
+        struct Node{
+            int g;                  // length of path from start
+            int parent;             // previous jump point
+            bool closed;
+        };
+        const NavGrid &grid;
+        int goal;
+        unordered_map<int, Node> nodes;
+        vector<int> parents;        // previous place of every place found by findNearest, -1 is not found
+        vector<int> frontier;       // places of findNearest in order of distance
+        /**
+         * @brief walkable is NavGrid::isWalkable, but target of search is walkable too
+         */
+        bool walkable( int x, int y ) const{
+            return grid.isWalkable(x, y) || ( x >= 0 && x < grid.getWidth() && x+y*grid.getWidth() == goal );
+        }
+        /**
+         * @brief jump goes from (x, y) in direction (dx, dy) until it finds jump point
+         * @return index of jump point or -1
+         */
+        int jump( int x, int y, int dx, int dy ) const;
+        /**
+         * @brief distance is manhattan distance between two places
+         */
+        int distance( int a, int b ) const;
+};
+/**********************************************************************************************/
+#endif // PATHFINDER_H
@@ -0,0 +1,87 @@
+/** @file profiler.cpp
+ * Implementation of Profiler class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "profiler.h"
+/**********************************************************************************************/
+atomic<bool> Profiler::on ( false );
+string Profiler::fileName;
+chrono::steady_clock::time_point Profiler::begin = chrono::steady_clock::now();
+mutex Profiler::lock;
+vector<shared_ptr<Profiler::Buffer> > Profiler::buffers;
+thread_local Profiler::Buffer *Profiler::buffer = NULL;
+/*********************************************************/
+void Profiler::start( const string &fileName ){
+    Profiler::fileName = fileName;
+    begin = chrono::steady_clock::now();
+    nameThread( "main" );
+    on.store( true, memory_order_relaxed );
+    atexit( write );
+}
+/*********************************************************/
+void Profiler::add( const char *name, long long start, long long duration ){
+    Buffer &own = Profiler::own();
+    if ( own.events.size() >= C_PROFILE_EVENTS ){
+        own.countLost++;
+        return;
+    }
+    Event event = { name, start, duration };
+    own.events.push_back( event );
+}
+/*********************************************************/
+void Profiler::nameThread( const string &name ){
+    own().name = name;
+}
+/*********************************************************/
+Profiler::Buffer &Profiler::own(){
+    if ( buffer == NULL ){
+        shared_ptr<Buffer> created ( new Buffer );
+        created->countLost = 0;
+        lock_guard<mutex> guard ( lock );
+        created->id = buffers.size() + 1;
+        created->name = "thread " + to_string( created->id );
+        buffers.push_back( created );
+        buffer = created.get();
+    }
+    return *buffer;
+}
+/*********************************************************/
+void Profiler::write(){
+    if ( !on.exchange( false ) ){
+        return;
+    }
+    FILE *file = fopen( fileName.c_str(), "w" );
+    if ( file == NULL ){
+        fprintf( stderr, "Profile can't be written to %s.\n", fileName.c_str() );
+        return;
+    }
+    // threads still running are stopped by exit, their buffers aren't changed any more
+    lock_guard<mutex> guard ( lock );
+    long long count = 0, lost = 0;
+    fprintf( file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" );
+    const char *separator = "";
+    for ( size_t i = 0; i < buffers.size(); ++i ){
+        const Buffer &own = *buffers[i];
+        fprintf( file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                 separator, (int)getpid(), own.id, own.name.c_str() );
+        separator = ",\n";
+        for ( size_t j = 0; j < own.events.size(); ++j ){
+            const Event &event = own.events[j];
+            fprintf( file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     event.name, (int)getpid(), own.id, event.start / 1000.0, event.duration / 1000.0 );
+        }
+        count += own.events.size();
+        lost += own.countLost;
+    }
+    fprintf( file, "\n]}\n" );
+    fclose( file );
+    fprintf( stderr, "Profile: %lld events written to %s", count, fileName.c_str() );
+    if ( lost > 0 ){
+        fprintf( stderr, ", %lld events didn't fit", lost );
+    }
+    fprintf( stderr, ".\n" );
+}
@@ -0,0 +1,133 @@
+/** @file profiler.h
+ * Header file of Profiler class and ProfileScope class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+#define C_PROFILE_EVENTS    (1 << 20)       // max count of events of one thread, next are only counted
+/**
+ * PROFILE_SCOPE( "name" ) measures time until end of block. Name has to be string literal.
+ * With -DNO_PROFILER it isn't compiled at all, otherwise it costs one test when profiler is off.
+ */
+#ifdef NO_PROFILER
+    #define PROFILE_SCOPE( name )
+#else
+    #define PROFILE_JOIN( a, b ) a##b
+    #define PROFILE_NAME( line ) PROFILE_JOIN( profileScope, line )
+    #define PROFILE_SCOPE( name ) ProfileScope PROFILE_NAME( __LINE__ ) ( name )
+#endif
+/**********************************************************************************************/
+/**
+ * @brief The Profiler class
+ * @detailed    Collects durations of marked scopes. Every thread writes into its own buffer
+ *              without lock, lock is taken only when thread writes its first event. Buffers
+ *              live until the end of program, so events of finished threads aren't lost.
+ *              At exit all events are written as Chrome trace (chrome://tracing, Perfetto).
+ */
+class Profiler{
+    public:
+        /**
+         * @brief start turns profiler on, trace is written at exit of program
+         * @param fileName is name of JSON file for trace
+         */
+        static void start( const string &fileName );
+        /**
+         * @brief isOn says if profiler collects events
+         * @return true if it is on
+         */
+        static bool isOn(){
+            return on.load( memory_order_relaxed );
+        }
+        /**
+         * @brief nanos is time from start of profiler
+         * @return time in nanoseconds
+         */
+        static long long nanos(){
+            return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now() - begin ).count();
+        }
+        /**
+         * @brief add adds finished event of currient thread
+         * @param name is name of scope
+         * @param start is time of begin (nanos)
+         * @param duration is duration in nanoseconds
+         */
+        static void add( const char *name, long long start, long long duration );
+        /**
+         * @brief nameThread names currient thread in trace
+         * @param name is name of thread
+         */
+        static void nameThread( const string &name );
+        /**
+         * @brief write writes trace, it is called at exit
+         */
+        static void write();
+    private:
+        /**
+         * @brief The Event struct is one measured scope
+         */
+        struct Event{
+            const char *name;
+            long long start;
+            long long duration;
+        };
+        /**
+         * @brief The Buffer struct has events of one thread
+         */
+        struct Buffer{
+            int id;
+            string name;
+            vector<Event> events;
+            long long countLost;
+        };
+        static atomic<bool> on;
+        static string fileName;
+        static chrono::steady_clock::time_point begin;
+        static mutex lock;                      // only for list of buffers
+        static vector<shared_ptr<Buffer> > buffers;
+        static thread_local Buffer *buffer;
+        /**
+         * @brief own gives buffer of currient thread, creates it at first call
+         * @return buffer
+         */
+        static Buffer &own();
+};
+/**********************************************************************************************/
+/**
+ * @brief The ProfileScope class
+ * @detailed    Measures time from its construction to its destruction, use PROFILE_SCOPE.
+ */
+class ProfileScope{
+    public:
+        /**
+         * @brief ProfileScope is constructor with parameters
+         * @param name is name of scope, string literal
+         */
+        ProfileScope( const char *name ) : name( Profiler::isOn() ? name : NULL ), start(0){
+            if ( this->name != NULL ){
+                start = Profiler::nanos();
+            }
+        }
+        /**
+         * @brief ~ProfileScope is destruktor, it adds event
+         */
+        ~ProfileScope(){
+            if ( name != NULL ){
+                Profiler::add( name, start, Profiler::nanos() - start );
+            }
+        }
+    private:
+        const char *name;
+        long long start;
+        ProfileScope( const ProfileScope & );
+        ProfileScope &operator=( const ProfileScope & );
+};
+/**********************************************************************************************/
+#endif // PROFILER_H
@@ -0,0 +1,59 @@
+/** @file random.h
+ * Header file and implementation of Random class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <stdint.h>
+#include <time.h>
+/**********************************************************************************************/
+/**
+ * @brief The Random class is random generator of one game session (xorshift64*)
+ * @detailed its whole state is one number, so it can be saved with the game
+ */
+class Random{
+    public:
+        /**
+         * @brief Random is implicit constructor, seed is taken from time
+         */
+        Random(){
+            setState( (uint64_t)time(NULL) * 2654435761ULL );
+        }
+        /**
+         * @brief Random is constructor with parameters
+         * @param seed is starting state
+         */
+        Random( uint64_t seed ){
+            setState( seed );
+        }
+        /**
+         * @brief next is getter of next random number
+         * @param bound is upper bound (not included), it has to be > 0
+         * @return number from 0 to bound-1
+         */
+        int next( int bound ){
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return (int)( ( ( state * 2685821657736338717ULL ) >> 33 ) % (uint64_t)bound );
+        }
+        /**
+         * @brief getState is getter of currient state
+         * @return state
+         */
+        uint64_t getState() const{
+            return state;
+        }
+        /**
+         * @brief setState is setter of state, zero is not allowed state of xorshift
+         * @param st is state to set
+         */
+        void setState( uint64_t st ){
+            state = ( st == 0 ) ? 0x9E3779B97F4A7C15ULL : st;
+        }
+    private:
+        uint64_t state;
+};
+/**********************************************************************************************/
+#endif // RANDOM_H
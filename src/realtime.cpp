@@ -0,0 +1,140 @@
+/** @file realtime.cpp
+ * Implementation of RealTime class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include "realtime.h"
+#include "profiler.h"
+/**********************************************************************************************/
+RealTime::RealTime() : last(Clock::now()), millis(0), window(0){}
+/*********************************************************/
+void RealTime::start( Map &map ){
+    PROFILE_SCOPE( "RealTime::start" );
+    moved( map );
+    last = Clock::now();
+}
+/*********************************************************/
+void RealTime::moved( Map &map ){
+    window++;
+    World &world = map.getWorld();
+    Components<Position> &positions = world.getPositions();
+    for ( int i = 0; i < positions.getCount(); ++i ){
+        // first actions are spread over the whole period, so enemies don't act all at once
+        Timer timer = { TIMER_ENEMY, 0, 0, world.getHandle( positions.getOwner(i) ), window };
+        wheel.schedule( 1 + map.getRandom().next( C_ENEMY_PERIOD ), timer );
+    }
+}
+/*********************************************************/
+bool RealTime::update( Map &map, bool isRunning ){
+    Clock::time_point now = Clock::now();
+    if ( isRunning ){
+        millis += chrono::duration_cast<chrono::milliseconds>( now - last ).count();
+    }
+    last = now;
+    if ( !isRunning ){
+        return false;
+    }
+    PROFILE_SCOPE( "RealTime::update" );
+    expired.clear();
+    wheel.advance( millis / C_REALTIME_TICK, expired );
+    bool changed = false;
+    for ( int i = 0; i < (int)expired.size(); ++i ){
+        changed = run( map, expired[i] ) || changed;
+    }
+    return attack( map ) || changed;
+}
+/*********************************************************/
+bool RealTime::run( Map &map, const Timer &timer ){
+    Hero &hero = map.getHero();
+    switch ( timer.type ){
+        case TIMER_ENEMY:{
+            if ( timer.window != window ){
+                return false;                           // enemy of previous map
+            }
+            Position *position = map.getWorld().getPosition( timer.entity );
+            if ( position == NULL ){
+                return false;                           // enemy was killed, it doesn't act anymore
+            }
+            wheel.schedule( C_ENEMY_PERIOD, timer );
+            Stats enemy;
+            if ( hero.getHealth() < 0 || !isNext( map, position->index, map.getHeroPos() ) ||
+                 !map.getWorld().getStats( timer.entity, enemy ) ){
+                return false;
+            }
+            Stats attacked = hero.getStats();
+            attacked.health = 1;                        // fight runs only while hero has health, hit is the rest
+            attacks.add( attacked, enemy );
+            return false;
+        }
+        case TIMER_POISON:{
+            if ( timer.value > 1 ){
+                Timer next = timer;
+                next.value--;
+                wheel.schedule( C_POISON_PERIOD, next );
+            }
+            hero.changeSkill( DELTA_HEALTH, -C_POISON_DAMAGE );
+            return true;
+        }
+        case TIMER_COURAGE:
+            hero.changeSkill( DELTA_DAMAGE, -C_COURAGE_DAMAGE );
+            return true;
+        case TIMER_RESPAWN:
+            if ( timer.window != window ){
+                return false;
+            }
+            if ( map.getSymbol( timer.index ) != '.' ){
+                wheel.schedule( C_RESPAWN_RETRY, timer );
+                return false;
+            }
+            map.setItem( timer.index, timer.value );
+            return true;
+    }
+    return false;
+}
+/*********************************************************/
+bool RealTime::attack( Map &map ){
+    if ( attacks.getCount() == 0 ){
+        return false;
+    }
+    if ( map.getHero().getHealth() < 0 ){
+        attacks.clear();                        // poison of the same update killed hero
+        return false;
+    }
+    // enemy hits first in round, hit of hero back doesn't matter, enemy keeps its stats
+    attacks.roll( map.getRandom() );
+    attacks.tick();
+    int damage = 0;
+    for ( int i = 0; i < attacks.getCount(); ++i ){
+        damage += 1 - attacks.getResult(i).heroHealth;
+    }
+    attacks.clear();
+    map.getHero().changeSkill( DELTA_HEALTH, -damage );
+    return true;
+}
+/*********************************************************/
+void RealTime::steppedOn( Map &map, int index, char symbol, int item ){
+    Timer timer = { TIMER_POISON, index, C_POISON_HITS, Handle (), window };
+    if ( item >= 0 ){
+        timer.type = TIMER_RESPAWN;
+        timer.value = item;
+        wheel.schedule( C_RESPAWN_TICKS, timer );
+    } else if ( symbol == '!' ){
+        wheel.schedule( C_POISON_PERIOD, timer );
+    }
+}
+/*********************************************************/
+void RealTime::drankWhisky( Map &map ){
+    Timer timer = { TIMER_COURAGE, 0, 0, Handle (), window };
+    map.getHero().changeSkill( DELTA_DAMAGE, C_COURAGE_DAMAGE );
+    wheel.schedule( C_COURAGE_TICKS, timer );
+}
+/*********************************************************/
+int RealTime::getCountTimers() const{
+    return wheel.getCount();
+}
+/*********************************************************/
+bool RealTime::isNext( Map &map, int a, int b ){
+    int width = map.getWidth();
+    int diff = a > b ? a - b : b - a;
+    return diff == width || ( diff == 1 && a / width == b / width );
+}
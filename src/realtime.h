@@ -0,0 +1,124 @@
+/** @file realtime.h
+ * Header file of RealTime class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef REALTIME_H
+#define REALTIME_H
+#include <chrono>
+#include <vector>
+#include "map.h"
+#include "timingwheel.h"
+using namespace std;
+#define C_REALTIME_TICK     10              // length of tick in ms, getch waits at most one tick for key
+#define C_ENEMY_PERIOD      100             // ticks between two actions of enemy
+#define C_POISON_PERIOD     100             // ticks between two hits of poison of thorn
+#define C_POISON_HITS       3
+#define C_POISON_DAMAGE     5
+#define C_COURAGE_TICKS     1000            // whisky gives courage (+damage) for 10 s
+#define C_COURAGE_DAMAGE    10
+#define C_RESPAWN_TICKS     6000            // picked up item is back after 60 s
+#define C_RESPAWN_RETRY     100             // place of respawn is occupied, it is tried again
+/**
+ * @brief The possible types of timed events
+ */
+enum TimerType{
+    TIMER_ENEMY,            //<Enemy acts, it hits hero standing next to it
+    TIMER_POISON,           //<Poison of thorn hurts hero, value is count of remaining hits
+    TIMER_COURAGE,          //<Courage of whisky wears off
+    TIMER_RESPAWN           //<Item comes back on index, value is id of its type
+};
+/**
+ * @brief The Timer struct is one timed event
+ */
+struct Timer{
+    TimerType type;
+    int index;
+    int value;
+    Handle entity;
+    int window;                 // TIMER_ENEMY and TIMER_RESPAWN belong to map they were scheduled on
+};
+/**********************************************************************************************/
+/**
+ * @brief The RealTime class is optional real-time mode of one game
+ * @detailed    World goes on without keys: enemies hit hero next to them, thorn poisons,
+ *              courage of whisky wears off, picked up items come back. All of it is scheduled
+ *              in TimingWheel with ticks of C_REALTIME_TICK, time is taken from monotonic clock
+ *              and stops while map isn't shown. Changes go through Hero and Map as after key.
+ *              Enemies which act in the same update hit hero together, as one tick of CombatBatch.
+ */
+class RealTime{
+    public:
+        /**
+         * @brief RealTime is implicit constructor
+         */
+        RealTime();
+        /**
+         * @brief start schedules first action of every enemy, clock begins
+         * @param map is game map
+         */
+        void start( Map &map );
+        /**
+         * @brief moved forgets enemies and places of previous map and schedules enemies of new one
+         * @detailed    Map of procedural world is replaced when hero moves to another chunk, poison
+         *              and courage go on, enemies and respawns of old map are ignored at expiry.
+         * @param map is new map
+         */
+        void moved( Map &map );
+        /**
+         * @brief update runs all events up to now
+         * @param map is game map
+         * @param isRunning is false if map isn't shown, time stops then
+         * @return true if some event happened
+         */
+        bool update( Map &map, bool isRunning );
+        /**
+         * @brief steppedOn schedules consequences of step on thorn (poison) or item (respawn)
+         * @param map is game map
+         * @param index is position of step
+         * @param symbol is symbol of place before step
+         * @param item is id of picked up item type or -1
+         */
+        void steppedOn( Map &map, int index, char symbol, int item );
+        /**
+         * @brief drankWhisky gives courage to hero after drink (item which adds health), it wears off later
+         * @param map is game map
+         */
+        void drankWhisky( Map &map );
+        /**
+         * @brief getCountTimers is getter of count of waiting events
+         * @return count
+         */
+        int getCountTimers() const;
+    private:
+        typedef chrono::steady_clock Clock;
+        TimingWheel<Timer> wheel;
+        Clock::time_point last;                 // time of previous update
+        long long millis;                       // game time, without pauses
+        int window;                             // count of moved
+        vector<Timer> expired;
+        CombatBatch attacks;                    // hits of enemies whose timers expired in the same update
+        /**
+         * @brief run does event, hit of enemy is only added into attacks
+         * @param map is game map
+         * @param timer is event
+         * @return true if map or hero changed
+         */
+        bool run( Map &map, const Timer &timer );
+        /**
+         * @brief attack takes one round of all fights in attacks, hero gets hits of enemies
+         * @param map is game map
+         * @return true if hero changed
+         */
+        bool attack( Map &map );
+        /**
+         * @brief isNext says if two places are neighbours
+         * @param map is game map
+         * @param a is first position
+         * @param b is second position
+         * @return true for places next to each other in row or column
+         */
+        static bool isNext( Map &map, int a, int b );
+};
+/**********************************************************************************************/
+#endif // REALTIME_H
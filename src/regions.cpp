@@ -0,0 +1,154 @@
+/** @file regions.cpp
+ * Implementation of RegionMap class
+ * Implementation of RegionLinks class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include "regions.h"
+#include "map.h"
+/**********************************************************************************************/
+RegionMap::RegionMap( const Map &map ){
+    width = map.getWidth();
+    height = map.getHeight();
+    parents.resize( width * height );
+    regions.resize( width * height );
+    int countThreads = thread::hardware_concurrency();
+    countThreads = max( 1, min( countThreads, C_REGION_THREADS ) );
+    countThreads = max( 1, min( countThreads, height / C_REGION_MIN_ROWS ) );
+    vector<int> rows;                           // strip i has rows [rows[i], rows[i+1])
+    for ( int i = 0; i <= countThreads; ++i ){
+        rows.push_back( (long long)height * i / countThreads );
+    }
+    // every strip touches only its own part of forest
+    vector<thread> threads;
+    for ( int i = 1; i < countThreads; ++i ){
+        threads.push_back( thread( &RegionMap::labelStrip, this, cref(map), rows[i], rows[i+1] ) );
+    }
+    labelStrip( map, rows[0], rows[1] );
+    for ( int i = 0; i < (int)threads.size(); ++i ){
+        threads[i].join();
+    }
+    threads.clear();
+    // join strips on their borders, there are only few places
+    for ( int i = 1; i < countThreads; ++i ){
+        for ( int x = 0; x < width; ++x ){
+            int a = x + rows[i] * width;
+            if ( parents[a] >= 0 && parents[a - width] >= 0 ){
+                unite( a, a - width );
+            }
+        }
+    }
+    // forest doesn't change anymore, so strips can read it together
+    for ( int i = 1; i < countThreads; ++i ){
+        threads.push_back( thread( &RegionMap::resolveStrip, this, rows[i], rows[i+1] ) );
+    }
+    resolveStrip( rows[0], rows[1] );
+    for ( int i = 0; i < (int)threads.size(); ++i ){
+        threads[i].join();
+    }
+    countRegions = 0;
+    for ( int i = 0; i < width * height; ++i ){
+        if ( regions[i] == i ){
+            countRegions++;
+        }
+    }
+    vector<int>().swap( parents );
+}
+/*********************************************************/
+void RegionMap::labelStrip( const Map &map, int begin, int end ){
+    for ( int i = begin * width; i < end * width; ++i ){
+        parents[i] = ( map.getTile(i).getSymbol() == '#' ) ? -1 : i;
+    }
+    for ( int y = begin; y < end; ++y ){
+        for ( int x = 0; x < width; ++x ){
+            int i = x + y * width;
+            if ( parents[i] < 0 ){
+                continue;
+            }
+            if ( x > 0 && parents[i-1] >= 0 ){
+                unite( i, i-1 );
+            }
+            if ( y > begin && parents[i-width] >= 0 ){
+                unite( i, i-width );
+            }
+        }
+    }
+    // every place points straight to root of its strip
+    for ( int i = begin * width; i < end * width; ++i ){
+        if ( parents[i] >= 0 ){
+            parents[i] = find(i);
+        }
+    }
+}
+/*********************************************************/
+void RegionMap::resolveStrip( int begin, int end ){
+    for ( int i = begin * width; i < end * width; ++i ){
+        int root = parents[i];
+        if ( root >= 0 ){
+            while ( parents[root] != root ){
+                root = parents[root];
+            }
+        }
+        regions[i] = root;
+    }
+}
+/*********************************************************/
+int RegionMap::find( int index ){
+    while ( parents[index] != index ){
+        parents[index] = parents[ parents[index] ];
+        index = parents[index];
+    }
+    return index;
+}
+/*********************************************************/
+void RegionMap::unite( int a, int b ){
+    a = find(a);
+    b = find(b);
+    if ( a < b ){
+        parents[b] = a;
+    } else if ( b < a ){
+        parents[a] = b;
+    }
+}
+/**********************************************************************************************/
+int RegionLinks::open( const RegionMap &regions, int index, int width, int height ){
+    int countLinks = joined.size();
+    int neighbours[4] = { index - width, index + width,
+                          index % width > 0 ? index - 1 : -1,
+                          index % width < width - 1 ? index + 1 : -1 };
+    // barrier alone is new region, its label is its place as of every other region
+    int found[4], countFound = 0, root = index;
+    for ( int i = 0; i < 4; ++i ){
+        if ( neighbours[i] < 0 || neighbours[i] >= height * width ){
+            continue;
+        }
+        int region = getRegion( regions, neighbours[i] );
+        if ( region >= 0 ){
+            root = countFound == 0 ? region : min( root, region );
+            found[countFound++] = region;
+        }
+    }
+    for ( int i = 0; i < countFound; ++i ){
+        if ( found[i] != root && links.insert( make_pair( found[i], root ) ).second ){
+            joined.push_back( found[i] );
+        }
+    }
+    opened[index] = root;
+    return countLinks;
+}
+/*********************************************************/
+void RegionLinks::close( int index, int countLinks ){
+    opened.erase( index );
+    while ( (int)joined.size() > countLinks ){
+        links.erase( joined.back() );
+        joined.pop_back();
+    }
+}
+/*********************************************************/
+size_t RegionLinks::getMemory() const{
+    return ( opened.size() + links.size() ) * 2 * sizeof(int) + joined.capacity() * sizeof(int) +
+           ( opened.bucket_count() + links.bucket_count() ) * sizeof(void *);
+}
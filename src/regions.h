@@ -0,0 +1,161 @@
+/** @file regions.h
+ * Header file of RegionMap class.
+ * Header file of RegionLinks class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef REGIONS_H
+#define REGIONS_H
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+#define C_REGION_THREADS    8       // max count of threads for labelling of regions
+#define C_REGION_MIN_ROWS   64      // every thread has at least so many rows of map
+class Map;
+/**********************************************************************************************/
+/**
+ * @brief The RegionMap class
+ * @detailed    Labels connected regions of places where hero can go (everything except barriers,
+ *              enemies and items disappear, thorns only hurt). Map is divided into horizontal strips,
+ *              every strip is labelled by union-find in its own thread, then strips are joined on their
+ *              borders. Each place knows its region, so reachability is only comparing of two numbers.
+ *              Regions are counted once, when map is loaded, barriers opened later are in RegionLinks.
+ */
+class RegionMap{
+    public:
+        /**
+         * @brief RegionMap is constructor with parameters, it labels all regions of map
+         * @param map is map to label
+         */
+        RegionMap( const Map &map );
+        /**
+         * @brief getRegion is getter for region of place
+         * @param index is position on map
+         * @return region (index of its first place) or -1 for barrier
+         */
+        int getRegion( int index ) const{
+            return regions[index];
+        }
+        /**
+         * @brief isConnected says if it is possible to go from one place to another
+         * @param from is first position on map
+         * @param to is second position on map
+         * @return true if both places are in the same region
+         */
+        bool isConnected( int from, int to ) const{
+            return regions[from] >= 0 && regions[from] == regions[to];
+        }
+        /**
+         * @brief getCountRegions is getter for count of regions
+         * @return count of regions
+         */
+        int getCountRegions() const{
+            return countRegions;
+        }
+        /**
+         * @brief getMemory is getter of memory used by labels
+         * @return size in bytes
+         */
+        size_t getMemory() const{
+            return ( regions.capacity() + parents.capacity() ) * sizeof(int);
+        }
+    private:
+        int width, height;
+        int countRegions;
+        vector<int> regions;
+        vector<int> parents;                    // union-find forest, it is used only while labelling
+        /**
+         * @brief labelStrip unites all neighbour places inside of rows [begin, end)
+         * @param map is map to label
+         * @param begin is first row of strip
+         * @param end is row after last row of strip
+         */
+        void labelStrip( const Map &map, int begin, int end );
+        /**
+         * @brief resolveStrip writes final region of every place in rows [begin, end)
+         * @param begin is first row of strip
+         * @param end is row after last row of strip
+         */
+        void resolveStrip( int begin, int end );
+        /**
+         * @brief find finds root of place and halves the path to it
+         * @param index is position on map
+         * @return root of place
+         */
+        int find( int index );
+        /**
+         * @brief unite joins trees of two places, root with smaller index stays root
+         * @param a is first position on map
+         * @param b is second position on map
+         */
+        void unite( int a, int b );
+};
+/**********************************************************************************************/
+/**
+ * @brief The RegionLinks class keeps barriers opened during game over RegionMap
+ * @detailed    RegionMap is shared with all copies of the same map, so it never changes. Opened
+ *              barrier gets region of its neighbours and all their regions are linked to the one
+ *              with the smallest label. It costs only few records per barrier, undo removes the
+ *              newest ones again.
+ */
+class RegionLinks{
+    public:
+        /**
+         * @brief getRegion is getter for region of place with opened barriers
+         * @param regions are regions of map
+         * @param index is position on map
+         * @return region or -1 for barrier
+         */
+        int getRegion( const RegionMap &regions, int index ) const{
+            int region = regions.getRegion( index );
+            if ( opened.empty() ){
+                return region;
+            }
+            unordered_map<int, int>::const_iterator it;
+            if ( region < 0 && ( it = opened.find( index ) ) != opened.end() ){
+                region = it->second;
+            }
+            while ( region >= 0 && ( it = links.find( region ) ) != links.end() ){
+                region = it->second;
+            }
+            return region;
+        }
+        /**
+         * @brief isConnected says if it is possible to go from one place to another
+         * @param regions are regions of map
+         * @param from is first position on map
+         * @param to is second position on map
+         * @return true if both places are in the same region
+         */
+        bool isConnected( const RegionMap &regions, int from, int to ) const{
+            int region = getRegion( regions, from );
+            return region >= 0 && region == getRegion( regions, to );
+        }
+        /**
+         * @brief open joins barrier and regions of its neighbours
+         * @param regions are regions of map
+         * @param index is position of barrier
+         * @param width is map's width
+         * @param height is map's height
+         * @return count of links before opening, close needs it
+         */
+        int open( const RegionMap &regions, int index, int width, int height );
+        /**
+         * @brief close takes back the newest opening
+         * @param index is position of barrier
+         * @param countLinks is count of links before opening
+         */
+        void close( int index, int countLinks );
+        /**
+         * @brief getMemory is getter of memory used by links
+         * @return size in bytes
+         */
+        size_t getMemory() const;
+    private:
+        unordered_map<int, int> opened;         // opened barrier -> its region
+        unordered_map<int, int> links;          // region -> region it was joined to
+        vector<int> joined;                     // keys of links in order of joining
+};
+/**********************************************************************************************/
+#endif // REGIONS_H
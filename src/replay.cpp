@@ -0,0 +1,113 @@
+/** @file replay.cpp
+ * Implementation of Replay class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "replay.h"
+#include "random.h"
+#include "exception.h"
+/**********************************************************************************************/
+Replay::Replay( const string &script, const vector<string> &arguments ) : name(script), arguments(arguments){
+    ifstream in ( script.c_str() );
+    if ( !in ){
+        throw Exception ( "Script " + script + " can't be read.\n" );
+    }
+    stringstream text;
+    text << in.rdbuf();
+    parse( text.str() );
+}
+/*********************************************************/
+void Replay::parse( const string &text ){
+    for ( size_t i = 0; i < text.size(); ++i ){
+        char ch = text[i];
+        if ( ch == '#' ){
+            while ( i < text.size() && text[i] != '\n' ){
+                i++;
+            }
+            continue;
+        }
+        if ( ch == '\n' || ch == '\r' ){
+            continue;
+        }
+        if ( ch != '\\' || i + 1 >= text.size() ){
+            keys.push_back( string ( 1, ch ) );
+            continue;
+        }
+        switch ( text[++i] ){
+            case 'n':   keys.push_back( "\r" );         break;
+            case 'e':   keys.push_back( "\x1b" );       break;
+            case 'u':   keys.push_back( "\x1b[A" );     break;
+            case 'd':   keys.push_back( "\x1b[B" );     break;
+            case 'r':   keys.push_back( "\x1b[C" );     break;
+            case 'l':   keys.push_back( "\x1b[D" );     break;
+            default:    keys.push_back( string ( 1, text[i] ) );  break;
+        }
+    }
+}
+/*********************************************************/
+void Replay::run( int countSessions ){
+    typedef chrono::steady_clock Clock;
+    ScreenController screen;
+    TextCanvas canvas ( C_SERVER_ROWS, C_SERVER_COLS );
+    long long countKeys = 0;
+    Clock::time_point begin = Clock::now();
+    for ( int s = 0; s < countSessions; ++s ){
+        Session session ( s + 1, arguments );
+        session.start( screen, canvas );
+        session.getOutput().clear();
+        for ( size_t i = 0; i < keys.size() && !session.isFinished(); ++i ){
+            Clock::time_point frame = Clock::now();
+            session.receive( keys[i].data(), keys[i].size(), screen, canvas );
+            session.getOutput().clear();
+            frames.add( chrono::duration_cast<chrono::nanoseconds>( Clock::now() - frame ).count() );
+            countKeys++;
+        }
+    }
+    double millis = chrono::duration_cast<chrono::microseconds>( Clock::now() - begin ).count() / 1000.0;
+    cout << "Replay " << name << " on " << arguments[0] << ": " << countSessions << " sessions, "
+         << countKeys << " keys, " << fixed << setprecision(1) << millis << " ms, "
+         << ( millis > 0 ? countKeys * 1000.0 / millis : 0.0 ) << " keys/s, "
+         << "frame p50 " << frames.getPercentile( 0.5 ) / 1000.0 << " us, "
+         << "p99 " << frames.getPercentile( 0.99 ) / 1000.0 << " us." << endl;
+}
+/*********************************************************/
+void Replay::generate( const string &fileName, int height, int width, int seed ){
+    if ( height < 2 || width < 2 ){
+        throw Exception ( "Generated map has to be at least 2 x 2.\n" );
+    }
+    ofstream out ( fileName.c_str() );
+    if ( !out ){
+        throw Exception ( "Map " + fileName + " can't be written.\n" );
+    }
+    Random random ( seed );
+    out << "[" << height << ", " << width << "]\t\t\t//(height, width)\n";
+    out << "\"hero\" [0,0]\n";
+    for ( int y = 0; y < height; ++y ){
+        for ( int x = 0; x < width; ++x ){
+            if ( x + y == 0 ){
+                continue;
+            }
+            if ( y % 2 == 1 && x % 2 == 1 ){
+                if ( random.next( 10 ) < 6 ){
+                    out << "\"barrier\" [" << y << "," << x << "]\n";
+                }
+                continue;
+            }
+            switch ( random.next( 100 ) ){
+                case 0:     out << "\"thorn\" [" << y << "," << x << "]\n";     break;
+                case 1:     out << "\"whisky\" [" << y << "," << x << "]\n";    break;
+                case 2:     out << "\"sword\" [" << y << "," << x << "]\n";     break;
+                case 3:     out << "\"enemy\" [" << y << "," << x << "] (" << 10 + random.next( 40 ) << ", "
+                                << 10 + random.next( 40 ) << ", " << 10 + random.next( 40 ) << ")\n";   break;
+            }
+        }
+    }
+    if ( !out ){
+        throw Exception ( "Map " + fileName + " can't be written.\n" );
+    }
+}
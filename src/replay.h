@@ -0,0 +1,60 @@
+/** @file replay.h
+ * Header file of Replay class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <string>
+#include <vector>
+#include "session.h"
+#include "latency.h"
+using namespace std;
+/**********************************************************************************************/
+/**
+ * @brief The Replay class
+ * @detailed    Plays scripted keys in sessions without terminal, the same way as server does
+ *              (Session with TextCanvas), and measures it. It is used for training of PGO build
+ *              and for comparing of build profiles (make bench).
+ *              Script is text of keys, '#' starts comment until end of line, line breaks are
+ *              ignored, "\n" is Enter, "\e" is Esc, "\u", "\d", "\l", "\r" are arrows, "\\" is
+ *              backslash.
+ */
+class Replay{
+    public:
+        /**
+         * @brief Replay is constructor with parameters, it reads script
+         * @param script is name of file with keys
+         * @param arguments are map and quest of sessions
+         * @throw Exception if script can't be read
+         */
+        Replay( const string &script, const vector<string> &arguments );
+        /**
+         * @brief run plays script in sessions one after another and writes result
+         * @param countSessions is how many times script is played
+         */
+        void run( int countSessions );
+        /**
+         * @brief generate writes random map, every enemy can be reached by hero
+         * @detailed    barriers are only on places with odd row and odd column, so even rows and
+         *              columns are always open
+         * @param fileName is name of map file
+         * @param height is height of map
+         * @param width is width of map
+         * @param seed is seed of random generator
+         * @throw Exception if map can't be written
+         */
+        static void generate( const string &fileName, int height, int width, int seed );
+    private:
+        string name;
+        vector<string> arguments;
+        vector<string> keys;                    // one key (byte or escape sequence) per frame
+        LatencyHistogram frames;
+        /**
+         * @brief parse translates script into keys
+         * @param text is content of script
+         */
+        void parse( const string &text );
+};
+/**********************************************************************************************/
+#endif // REPLAY_H
@@ -0,0 +1,131 @@
+/** @file runtimestats.cpp
+ * Implementation of RuntimeStats class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <malloc.h>
+#include <unistd.h>
+#include "runtimestats.h"
+#include "maplibrary.h"
+/**********************************************************************************************/
+volatile sig_atomic_t RuntimeStats::requested = 0;
+LatencyHistogram RuntimeStats::frames;
+LatencyHistogram RuntimeStats::keys;
+LatencyHistogram RuntimeStats::combats;
+atomic<long long> RuntimeStats::countWon ( 0 );
+atomic<long long> RuntimeStats::countRounds ( 0 );
+atomic<int> RuntimeStats::maxRounds ( 0 );
+/*********************************************************/
+void RuntimeStats::install(){
+    struct sigaction action;
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = onSignal;
+    sigaction( SIGUSR1, &action, NULL );
+}
+/*********************************************************/
+void RuntimeStats::onSignal( int sig ){
+    requested = 1;
+}
+/*********************************************************/
+bool RuntimeStats::isRequested(){
+    if ( !requested ){
+        return false;
+    }
+    requested = 0;
+    return true;
+}
+/*********************************************************/
+void RuntimeStats::addFrame( long long nanos, long long keyNanos ){
+    frames.add( nanos );
+    keys.add( keyNanos );
+}
+/*********************************************************/
+void RuntimeStats::addCombat( int rounds, long long nanos, bool won ){
+    combats.add( nanos );
+    countRounds.fetch_add( rounds, memory_order_relaxed );
+    if ( won ){
+        countWon.fetch_add( 1, memory_order_relaxed );
+    }
+    if ( rounds > maxRounds.load( memory_order_relaxed ) ){
+        maxRounds.store( rounds, memory_order_relaxed );
+    }
+}
+/*********************************************************/
+string RuntimeStats::getFileName(){
+    return string ( C_STATS_FILE ) + "-" + to_string( getpid() ) + ".stats";
+}
+/*********************************************************/
+void RuntimeStats::write( ostream &os, const ScreenData *data ){
+    time_t now = time( NULL );
+    char date[32];
+    strftime( date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime( &now ) );
+    os << "=== Snapshot of process " << getpid() << " at " << date << " ===" << endl;
+
+    long pages = 0, resident = 0;
+    ifstream statm ( "/proc/self/statm" );
+    statm >> pages >> resident;
+    struct mallinfo2 heap = mallinfo2();
+    os << fixed << setprecision(1)
+       << "Process: " << resident * sysconf( _SC_PAGESIZE ) / 1048576.0 << " MB resident, "
+       << heap.uordblks / 1048576.0 << " MB of heap in use, "
+       << MapLibrary::getCountMaps() << " maps in library." << endl;
+
+    if ( data != NULL && data->type == MAP ){
+        writeMap( os, *static_cast<const MapData *>( data )->getMap() );
+    } else if ( data != NULL ){
+        os << "No map is played." << endl;
+    }
+    writeLatency( os, "Frames", frames );
+    writeLatency( os, "Game::handleKey", keys );
+    long long count = combats.getCount();
+    os << "Combats: " << count << " fights, " << countWon.load( memory_order_relaxed ) << " won, "
+       << ( count == 0 ? 0.0 : (double)countRounds.load( memory_order_relaxed ) / count ) << " rounds per fight, "
+       << maxRounds.load( memory_order_relaxed ) << " at most." << endl;
+    writeLatency( os, "Combat", combats );
+    os << endl;
+}
+/*********************************************************/
+void RuntimeStats::writeMap( ostream &os, Map &map ){
+    int countEnemies = 0, countItems = 0, countThorns = 0, countBarriers = 0;
+    for ( int i = 0; i < map.getWidth() * map.getHeight(); ++i ){
+        countItems += ( map.getTile(i).getItem() >= 0 );
+        switch ( map.getSymbol(i) ){
+            case 'e':   countEnemies++;     break;
+            case '!':   countThorns++;      break;
+            case '#':   countBarriers++;    break;
+        }
+    }
+    MapMemory memory = map.getMemory();
+    const DeltaLog &history = map.getHistory();
+    os << "Map: " << map.getWidth() << " x " << map.getHeight() << " places, hero at "
+       << map.getHeroPos() % map.getWidth() << "," << map.getHeroPos() / map.getWidth() << "." << endl;
+    os << "Memory: places " << memory.places << " B, navigation grid " << memory.navGrid << " B, cluster graph "
+       << memory.clusterGraph << " B, regions " << memory.regions << " B (shared), undo history " << memory.history
+       << " B of " << history.getMaxMemory() << " B (" << history.getCountSteps() << " steps), entities "
+       << memory.entities << " B, triggers " << memory.triggers << " B (shared)." << endl;
+    os << "Entities: " << countEnemies << " enemies, " << countItems << " items of " << ItemRegistry::get().getCount()
+       << " types, " << countThorns << " thorns, " << countBarriers << " barriers." << endl;
+    const Inventory &inventory = map.getInventory();
+    os << "Hero: health " << map.getHeroHealth() << ", damage " << map.getHeroDamage() << ", defence "
+       << map.getHeroDefence() << ", " << inventory.getTotal() << " items of " << inventory.getSize() << " types." << endl;
+}
+/*********************************************************/
+void RuntimeStats::writeLatency( ostream &os, const string &name, const LatencyHistogram &latency ){
+    os << name << ": " << latency.getCount() << " times, " << fixed << setprecision(1)
+       << "p50 " << latency.getPercentile( 0.5 ) / 1000.0 << " us, "
+       << "p90 " << latency.getPercentile( 0.9 ) / 1000.0 << " us, "
+       << "p99 " << latency.getPercentile( 0.99 ) / 1000.0 << " us, "
+       << "max " << latency.getMax() / 1000.0 << " us." << endl;
+}
+/*********************************************************/
+void RuntimeStats::dump( const ScreenData *data ){
+    ofstream file ( getFileName().c_str(), ios::app );
+    if ( file ){
+        write( file, data );
+    }
+}
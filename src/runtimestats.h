@@ -0,0 +1,100 @@
+/** @file runtimestats.h
+ * Header file of RuntimeStats class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef RUNTIMESTATS_H
+#define RUNTIMESTATS_H
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <ostream>
+#include <string>
+#include "latency.h"
+#include "data.h"
+using namespace std;
+#define C_STATS_FILE        "ostroiul"      // snapshots are appended to ostroiul-PID.stats
+/**********************************************************************************************/
+/**
+ * @brief The RuntimeStats class
+ * @detailed    Snapshot of running game for debugging without debugger: kill -USR1 PID.
+ *              Signal handler only sets flag, main loop takes snapshot between two keys,
+ *              so no update is interrupted. Histograms are filled all the time, it costs
+ *              two readings of clock per key and per fight.
+ */
+class RuntimeStats{
+    public:
+        /**
+         * @brief install sets handler of SIGUSR1 (without SA_RESTART, so getch is interrupted)
+         */
+        static void install();
+        /**
+         * @brief isRequested says if snapshot was requested by signal, request is reset
+         * @return true if snapshot should be taken
+         */
+        static bool isRequested();
+        /**
+         * @brief nanos is time for measuring of durations
+         * @return monotonic time in nanoseconds
+         */
+        static long long nanos(){
+            return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now().time_since_epoch() ).count();
+        }
+        /**
+         * @brief addFrame counts one frame (from key to refresh of screen)
+         * @param nanos is duration
+         * @param keyNanos is duration of Game::handleKey inside of frame
+         */
+        static void addFrame( long long nanos, long long keyNanos );
+        /**
+         * @brief addCombat counts one fight of hero with enemy
+         * @param rounds is count of rounds
+         * @param nanos is duration
+         * @param won is true if hero survived
+         */
+        static void addCombat( int rounds, long long nanos, bool won );
+        /**
+         * @brief getFileName is name of file for snapshots of this process
+         * @return name of file
+         */
+        static string getFileName();
+        /**
+         * @brief write writes snapshot of process, map and histograms
+         * @param os is output
+         * @param data are data of currient screen, map is described only for MapData, can be NULL
+         */
+        static void write( ostream &os, const ScreenData *data );
+        /**
+         * @brief dump appends snapshot to file of this process
+         * @param data are data of currient screen, can be NULL
+         */
+        static void dump( const ScreenData *data );
+    private:
+        static volatile sig_atomic_t requested;
+        static LatencyHistogram frames;
+        static LatencyHistogram keys;
+        static LatencyHistogram combats;
+        static atomic<long long> countWon;
+        static atomic<long long> countRounds;
+        static atomic<int> maxRounds;
+        /**
+         * @brief onSignal is handler of SIGUSR1
+         * @param sig is number of signal
+         */
+        static void onSignal( int sig );
+        /**
+         * @brief writeMap writes size, memory and entities of map
+         * @param os is output
+         * @param map is map of currient game
+         */
+        static void writeMap( ostream &os, Map &map );
+        /**
+         * @brief writeLatency writes one histogram
+         * @param os is output
+         * @param name is name of histogram
+         * @param latency is histogram
+         */
+        static void writeLatency( ostream &os, const string &name, const LatencyHistogram &latency );
+};
+/**********************************************************************************************/
+#endif // RUNTIMESTATS_H
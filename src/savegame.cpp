@@ -0,0 +1,540 @@
+/** @file savegame.cpp
+ * Implementation of SaveGame class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "savegame.h"
+#include "profiler.h"
+/**********************************************************************************************/
+/**
+ * @brief The SaveWriter class collects small pieces of snapshot to big blocks for write()
+ */
+class SaveWriter{
+    public:
+        SaveWriter( int fd, long long rate ) : fd(fd), used(0), failed(false), rate(rate), total(0) {
+            // with limited rate blocks are smaller, so pauses between them are short
+            buffer.resize( rate > 0 ? min( (long long)C_SAVE_BUFFER, max( 4096LL, rate / 16 ) ) : C_SAVE_BUFFER );
+            begin = chrono::steady_clock::now();
+        }
+        void write( const void *src, size_t length ){
+            const char *bytes = (const char *)src;
+            while ( length > 0 ){
+                size_t part = min( length, buffer.size() - used );
+                memcpy( &buffer[used], bytes, part );
+                used += part;
+                bytes += part;
+                length -= part;
+                if ( used == buffer.size() ){
+                    flush();
+                }
+            }
+        }
+        void put( unsigned char byte ){
+            buffer[used++] = byte;
+            if ( used == buffer.size() ){
+                flush();
+            }
+        }
+        void flush(){
+            size_t done = 0;
+            while ( done < used && !failed ){
+                ssize_t written = ::write( fd, &buffer[done], used - done );
+                if ( written <= 0 ){
+                    failed = true;
+                    break;
+                }
+                done += written;
+            }
+            total += done;
+            used = 0;
+            if ( rate > 0 && !failed ){
+                // sleep until written bytes fit into rate
+                chrono::steady_clock::time_point until = begin + chrono::microseconds( total * 1000000 / rate );
+                this_thread::sleep_until( until );
+            }
+        }
+        bool isFailed() const{
+            return failed;
+        }
+        long long getTotal() const{
+            return total;
+        }
+        long long getOffset() const{
+            return total + used;
+        }
+    private:
+        int fd;
+        vector<char> buffer;
+        size_t used;
+        bool failed;
+        long long rate;
+        long long total;
+        chrono::steady_clock::time_point begin;
+};
+/**********************************************************************************************/
+long long SaveGame::save( const string &fileName, Map &map, long long rate ){
+    PROFILE_SCOPE( "SaveGame::save" );
+    string tmpName = fileName + ".tmp";
+    int fd = open( tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ){
+        throw Exception ( "Game can't be saved to " + fileName + "\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    Hero &hero = map.getHero();
+    string name = hero.getName();
+    SaveHeader header;
+    memset( &header, 0, sizeof(header) );
+    header.magic = C_SAVE_MAGIC;
+    header.version = C_SAVE_VERSION;
+    header.height = map.getHeight();
+    header.width = map.getWidth();
+    header.heroPos = map.getHeroPos();
+    header.countEnemies = map.getCountEnemies();
+    header.heroType = dynamic_cast<Chuck*>(&hero) ? CHUCK : NEWHERO;
+    header.direction = hero.getDirection();
+    header.health = hero.getHealth();
+    header.damage = hero.getDamage();
+    header.defence = hero.getDefence();
+    header.nameLength = name.size();
+    header.random = map.getRandom().getState();
+    SaveWriter out ( fd, rate );
+    out.write( &header, sizeof(header) );
+    out.write( name.data(), name.size() );
+    int countCells = header.height * header.width;
+    vector<int> enemies;
+    vector<int32_t> places;                     // pairs (position, number of name)
+    vector<int> names;                          // ids of item types
+    std::map<int, int> numbers;                 // number of name of every id
+    Stats stats;
+    for ( int i = 0; i < countCells; ++i ){
+        unsigned char type = (unsigned char)HERO;
+        if ( i != header.heroPos ){
+            type = map.getEnemyStats( i, stats ) ? (unsigned char)ENEMY : typeOf( map.getTile(i) );
+        }
+        if ( type == ENEMY ){
+            enemies.push_back(i);
+        }
+        if ( type == ITEM ){
+            int item = map.getTile(i).getItem();
+            if ( numbers.insert( make_pair( item, (int)names.size() ) ).second ){
+                names.push_back( item );
+            }
+            places.push_back( i );
+            places.push_back( numbers[item] );
+        }
+        out.put( type );
+    }
+    int32_t count = enemies.size();
+    out.write( &count, sizeof(count) );
+    vector<int> lootNames;                      // ids of loot tables
+    std::map<int, int> lootNumbers;             // number of name of every id
+    for ( int i = 0; i < count; ++i ){
+        map.getEnemyStats( enemies[i], stats );
+        const Loot *loot = map.world.getLoot( map.occupants[ enemies[i] ] );
+        int32_t record[5] = { enemies[i], stats.health, stats.damage, stats.defence, -1 };
+        if ( loot != NULL ){
+            if ( lootNumbers.insert( make_pair( loot->table, (int)lootNames.size() ) ).second ){
+                lootNames.push_back( loot->table );
+            }
+            record[4] = lootNumbers[ loot->table ];
+        }
+        out.write( record, sizeof(record) );
+    }
+    const TriggerIndex *triggers = map.triggers.get();
+    int32_t countTriggers = ( triggers == NULL ) ? 0 : triggers->getCount();
+    int32_t countMessages = ( triggers == NULL ) ? 0 : triggers->getCountMessages();
+    out.write( &countTriggers, sizeof(countTriggers) );
+    for ( int i = 0; i < countTriggers; ++i ){
+        int32_t isFired = map.fired[i];
+        out.write( &triggers->getTrigger(i), sizeof(Trigger) );
+        out.write( &isFired, sizeof(isFired) );
+    }
+    out.write( &countMessages, sizeof(countMessages) );
+    for ( int i = 0; i < countMessages; ++i ){
+        const string &text = triggers->getMessage(i);
+        int32_t length = text.size();
+        out.write( &length, sizeof(length) );
+        out.write( text.data(), text.size() );
+    }
+    // pools of spawners aren't saved, their killed enemies aren't in file
+    const SpawnerSet &spawners = map.spawners;
+    int32_t countSpawners = spawners.getCount();
+    out.write( &countSpawners, sizeof(countSpawners) );
+    for ( int i = 0; i < countSpawners; ++i ){
+        const Spawner &spawner = spawners.at(i);
+        int32_t record[9] = { spawner.place, spawner.stats.health, spawner.stats.damage, spawner.stats.defence, -1,
+                              spawner.every, spawner.near, spawner.total, spawner.spawned };
+        if ( spawner.loot >= 0 ){
+            if ( lootNumbers.insert( make_pair( spawner.loot, (int)lootNames.size() ) ).second ){
+                lootNames.push_back( spawner.loot );
+            }
+            record[4] = lootNumbers[ spawner.loot ];
+        }
+        out.write( record, sizeof(record) );
+    }
+    int32_t countBudgets = spawners.getBudgets().size();
+    out.write( &countBudgets, sizeof(countBudgets) );
+    for ( int i = 0; i < countBudgets; ++i ){
+        int32_t record[2] = { spawners.getBudgets()[i].first, spawners.getBudgets()[i].second };
+        out.write( record, sizeof(record) );
+    }
+    int32_t turn = map.turn;
+    out.write( &turn, sizeof(turn) );
+    const Inventory &inventory = hero.getInventory();
+    vector<int32_t> stacks;                     // pairs (number of name, count)
+    for ( int i = 0; i < inventory.getSize(); ++i ){
+        int item = inventory.at(i).item;
+        if ( numbers.insert( make_pair( item, (int)names.size() ) ).second ){
+            names.push_back( item );
+        }
+        stacks.push_back( numbers[item] );
+        stacks.push_back( inventory.at(i).count );
+    }
+    header.items = out.getOffset();
+    int32_t countNames = names.size(), countPlaces = places.size() / 2, countStacks = stacks.size() / 2;
+    out.write( &countNames, sizeof(countNames) );
+    for ( int i = 0; i < countNames; ++i ){
+        const string &name = ItemRegistry::get().getType( names[i] ).name;
+        int32_t length = name.size();
+        out.write( &length, sizeof(length) );
+        out.write( name.data(), name.size() );
+    }
+    int32_t countLoots = lootNames.size();
+    out.write( &countLoots, sizeof(countLoots) );
+    for ( int i = 0; i < countLoots; ++i ){
+        const string &name = ItemRegistry::get().getLoot( lootNames[i] ).getName();
+        int32_t length = name.size();
+        out.write( &length, sizeof(length) );
+        out.write( name.data(), name.size() );
+    }
+    out.write( &countPlaces, sizeof(countPlaces) );
+    out.write( places.data(), places.size() * sizeof(int32_t) );
+    out.write( &countStacks, sizeof(countStacks) );
+    out.write( stacks.data(), stacks.size() * sizeof(int32_t) );
+    out.flush();
+    bool failed = out.isFailed();
+    // offset of items is known only now
+    failed = failed || pwrite( fd, &header, sizeof(header), 0 ) != (ssize_t)sizeof(header);
+    failed = ( close(fd) != 0 ) || failed;
+    if ( failed || rename( tmpName.c_str(), fileName.c_str() ) != 0 ){
+        unlink( tmpName.c_str() );
+        throw Exception ( "Game can't be saved to " + fileName + "\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    return out.getTotal();
+}
+/*********************************************************/
+string SaveGame::latest(){
+    struct stat manual, autosave;
+    memset( &manual, 0, sizeof(manual) );
+    memset( &autosave, 0, sizeof(autosave) );
+    bool isManual = ( stat( C_SAVE_FILE, &manual ) == 0 );
+    bool isAuto = ( stat( C_AUTOSAVE_FILE, &autosave ) == 0 );
+    bool isNewer = autosave.st_mtim.tv_sec > manual.st_mtim.tv_sec ||
+                   ( autosave.st_mtim.tv_sec == manual.st_mtim.tv_sec && autosave.st_mtim.tv_nsec > manual.st_mtim.tv_nsec );
+    if ( isAuto && ( !isManual || isNewer ) ){
+        return C_AUTOSAVE_FILE;
+    }
+    return C_SAVE_FILE;
+}
+/*********************************************************/
+SaveGame::SaveGame( const string &fileName ) : data(NULL), size(0), header(NULL){
+    string aboutKeyMess = "\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+    int fd = open( fileName.c_str(), O_RDONLY );
+    if ( fd < 0 ){
+        throw Exception ( "There isn't any saved game." + aboutKeyMess );
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || st.st_size < (off_t)sizeof(SaveHeader) ){
+        close(fd);
+        throw Exception ( "Saved game is damaged." + aboutKeyMess );
+    }
+    size = st.st_size;
+    void *mapped = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close(fd);
+    if ( mapped == MAP_FAILED ){
+        throw Exception ( "Saved game can't be read." + aboutKeyMess );
+    }
+    data = (const char *)mapped;
+    header = (const SaveHeader *)data;
+    // header, name, places and count of enemies have to be in file
+    long long cells = (long long)header->height * header->width;
+    long long needed = (long long)sizeof(SaveHeader) + header->nameLength + cells + sizeof(int32_t);
+    int32_t count = 0;
+    if ( header->magic == C_SAVE_MAGIC && header->version == C_SAVE_VERSION && header->height > 0 &&
+         header->width > 0 && header->nameLength >= 0 && needed <= (long long)size ){
+        memcpy( &count, data + needed - sizeof(int32_t), sizeof(count) );
+    }
+    if ( header->magic != C_SAVE_MAGIC || header->version != C_SAVE_VERSION || header->height <= 0 ||
+         header->width <= 0 || header->nameLength < 0 || needed > (long long)size || count < 0 ||
+         needed + ( count * 5LL + 2 ) * (long long)sizeof(int32_t) > (long long)size ||
+         header->heroPos < 0 || header->heroPos >= cells || header->items < needed + count * 5LL * (long long)sizeof(int32_t) ||
+         header->items > (long long)size - 4 * (long long)sizeof(int32_t) ){
+        munmap( (void *)data, size );
+        throw Exception ( "Saved game is damaged." + aboutKeyMess );
+    }
+}
+/*********************************************************/
+SaveGame::~SaveGame(){
+    munmap( (void *)data, size );
+}
+/*********************************************************/
+shared_ptr<Hero> SaveGame::createHero() const{
+    shared_ptr<Hero> hero;
+    if ( header->heroType == CHUCK ){
+        hero = shared_ptr<Hero>( new Chuck );
+    } else {
+        string name ( data + sizeof(SaveHeader), header->nameLength );
+        hero = shared_ptr<Hero>( new Hero ( name, header->health, header->damage, header->defence ) );
+    }
+    hero->setSkills( header->health, header->damage, header->defence );
+    hero->setDirection( header->direction );
+    vector<int> items, loots;
+    const char *end = data + size;
+    const char *record = readItems( items, loots );
+    int32_t count = 0;
+    memcpy( &count, record, sizeof(count) );
+    record += sizeof(count);
+    if ( count < 0 || end - record < count * 2LL * (long long)sizeof(int32_t) + (long long)sizeof(int32_t) ){
+        throw Exception ( "Saved game is damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    record += count * 2 * sizeof(int32_t);
+    memcpy( &count, record, sizeof(count) );
+    record += sizeof(count);
+    if ( count < 0 || end - record != count * 2LL * (long long)sizeof(int32_t) ){
+        throw Exception ( "Saved game is damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+    }
+    for ( int i = 0; i < count; ++i ){
+        int32_t stack[2];
+        memcpy( stack, record + i * sizeof(stack), sizeof(stack) );
+        if ( stack[0] < 0 || stack[0] >= (int)items.size() || stack[1] <= 0 ){
+            throw Exception ( "Saved game is damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+        }
+        hero->setItem( items[ stack[0] ], stack[1] );
+    }
+    return hero;
+}
+/*********************************************************/
+const char *SaveGame::readItems( vector<int> &items, vector<int> &loots ) const{
+    string errorMess = "Saved game is damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+    const char *end = data + size;
+    const char *name = data + header->items;
+    items.clear();
+    loots.clear();
+    // names of item types, then names of loot tables
+    for ( int list = 0; list < 2; ++list ){
+        int32_t count = 0;
+        if ( end - name < (long long)sizeof(count) ){
+            throw Exception ( errorMess );
+        }
+        memcpy( &count, name, sizeof(count) );
+        name += sizeof(count);
+        if ( count < 0 ){
+            throw Exception ( errorMess );
+        }
+        for ( int i = 0; i < count; ++i ){
+            int32_t length = 0;
+            if ( end - name < (long long)sizeof(length) ){
+                throw Exception ( errorMess );
+            }
+            memcpy( &length, name, sizeof(length) );
+            name += sizeof(length);
+            if ( length < 0 || end - name < length ){
+                throw Exception ( errorMess );
+            }
+            string text ( name, length );
+            int id = ( list == 0 ) ? ItemRegistry::get().find( text ) : ItemRegistry::get().findLoot( text );
+            if ( id < 0 ){
+                throw Exception ( ( list == 0 ? "Item " : "Loot " ) + text + " of saved game isn't in items file anymore.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n" );
+            }
+            ( list == 0 ? items : loots ).push_back( id );
+            name += length;
+        }
+    }
+    if ( end - name < (long long)sizeof(int32_t) ){
+        throw Exception ( errorMess );
+    }
+    return name;
+}
+/*********************************************************/
+shared_ptr<Map> SaveGame::createMap() const{
+    string errorMess = "Saved game is damaged.\n\nPress ENTER to come back to Main Menu.\nPress any key to EXIT the Game.\n";
+    shared_ptr<Map> map ( new Map ( header->height, header->width ) );
+    shared_ptr<Hero> hero = createHero();
+    const unsigned char *cells = (const unsigned char *)( data + sizeof(SaveHeader) + header->nameLength );
+    int countCells = header->height * header->width;
+    int countEnemyCells = 0, countItemCells = 0;
+    for ( int i = 0; i < countCells; ++i ){
+        unsigned char type = cells[i];
+        if ( type > STAIRS || ( type == HERO ) != ( i == header->heroPos ) ){
+            throw Exception ( errorMess );
+        }
+        if ( type == ENEMY ){
+            countEnemyCells++;
+        }
+        if ( type == ITEM ){
+            countItemCells++;
+        }
+        if ( type != ENEMY && type != EMPTY && type != ITEM ){
+            map->createMapObject( (typeMapObj)type, i, hero );
+        }
+    }
+    // names of items and loot tables, hero has already got his inventory in createHero
+    vector<int> items, loots;
+    const char *place = readItems( items, loots );
+    const char *records = (const char *)( cells + countCells );
+    int32_t count = 0;
+    memcpy( &count, records, sizeof(count) );
+    records += sizeof(count);
+    if ( count != countEnemyCells ){
+        throw Exception ( errorMess );
+    }
+    for ( int i = 0; i < count; ++i ){
+        int32_t record[5];
+        memcpy( record, records + i * sizeof(record), sizeof(record) );
+        if ( record[0] < 0 || record[0] >= countCells || cells[ record[0] ] != ENEMY || record[4] < -1 || record[4] >= (int)loots.size() ){
+            throw Exception ( errorMess );
+        }
+        Stats stats = { record[1], record[2], record[3] };
+        map->placeEnemy( record[0], stats, record[4] < 0 ? -1 : loots[ record[4] ] );
+    }
+    int32_t countItems = 0;
+    memcpy( &countItems, place, sizeof(countItems) );
+    place += sizeof(countItems);
+    if ( countItems != countItemCells || data + size - place < countItems * 2LL * (long long)sizeof(int32_t) ){
+        throw Exception ( errorMess );
+    }
+    for ( int i = 0; i < countItems; ++i ){
+        int32_t record[2];
+        memcpy( record, place + i * sizeof(record), sizeof(record) );
+        if ( record[0] < 0 || record[0] >= countCells || cells[ record[0] ] != ITEM || record[1] < 0 || record[1] >= (int)items.size() ){
+            throw Exception ( errorMess );
+        }
+        map->placeItem( record[0], items[ record[1] ] );
+    }
+    map->countEnemies = header->countEnemies;
+    map->random.setState( header->random );
+    map->regions = shared_ptr<RegionMap>( new RegionMap ( *map ) );
+    // triggers, sizes are checked against end of file before every read
+    const char *end = data + size;
+    const char *trigger = records + count * 5 * sizeof(int32_t);
+    shared_ptr<TriggerIndex> triggers ( new TriggerIndex );
+    int32_t countTriggers = 0, countMessages = 0;
+    memcpy( &countTriggers, trigger, sizeof(countTriggers) );
+    trigger += sizeof(countTriggers);
+    if ( countTriggers < 0 || end - trigger < countTriggers * (long long)( sizeof(Trigger) + sizeof(int32_t) ) + (long long)sizeof(int32_t) ){
+        throw Exception ( errorMess );
+    }
+    map->fired.assign( countTriggers, false );
+    for ( int i = 0; i < countTriggers; ++i ){
+        Trigger saved;
+        int32_t isFired = 0;
+        memcpy( &saved, trigger, sizeof(Trigger) );
+        memcpy( &isFired, trigger + sizeof(Trigger), sizeof(isFired) );
+        trigger += sizeof(Trigger) + sizeof(isFired);
+        triggers->add( saved );
+        map->fired[i] = ( isFired != 0 );
+    }
+    memcpy( &countMessages, trigger, sizeof(countMessages) );
+    trigger += sizeof(countMessages);
+    for ( int i = 0; i < countMessages; ++i ){
+        int32_t length = 0;
+        if ( end - trigger < (long long)sizeof(length) ){
+            throw Exception ( errorMess );
+        }
+        memcpy( &length, trigger, sizeof(length) );
+        trigger += sizeof(length);
+        if ( length < 0 || end - trigger < length ){
+            throw Exception ( errorMess );
+        }
+        triggers->addMessage( string ( trigger, length ) );
+        trigger += length;
+    }
+    for ( int i = 0; i < countTriggers; ++i ){
+        const Trigger &saved = triggers->getTrigger(i);
+        bool isPlace = ( saved.event != TRIGGER_LEFT );
+        bool isTarget = ( saved.action == ACTION_SPAWN || saved.action == ACTION_OPEN );
+        if ( saved.event < TRIGGER_ENTER || saved.event > TRIGGER_LEFT || saved.action < ACTION_MESSAGE || saved.action > ACTION_DIALOG ||
+             saved.key < 0 || ( isPlace && saved.key >= countCells ) || ( isTarget && ( saved.target < 0 || saved.target >= countCells ) ) ||
+             ( ( saved.action == ACTION_MESSAGE || saved.action == ACTION_DIALOG ) && ( saved.target < 0 || saved.target >= countMessages ) ) ){
+            throw Exception ( errorMess );
+        }
+    }
+    // spawners, budgets of regions and count of steps
+    const char *spawner = trigger;
+    int32_t countSpawners = 0, countBudgets = 0;
+    if ( end - spawner < (long long)sizeof(countSpawners) ){
+        throw Exception ( errorMess );
+    }
+    memcpy( &countSpawners, spawner, sizeof(countSpawners) );
+    spawner += sizeof(countSpawners);
+    if ( countSpawners < 0 || end - spawner < countSpawners * 9LL * (long long)sizeof(int32_t) + (long long)sizeof(int32_t) ){
+        throw Exception ( errorMess );
+    }
+    for ( int i = 0; i < countSpawners; ++i ){
+        int32_t record[9];
+        memcpy( record, spawner, sizeof(record) );
+        spawner += sizeof(record);
+        Spawner saved;
+        saved.place = record[0];
+        saved.stats.health = record[1];
+        saved.stats.damage = record[2];
+        saved.stats.defence = record[3];
+        saved.loot = record[4] < 0 ? -1 : 0;
+        saved.every = record[5];
+        saved.near = record[6];
+        saved.total = record[7];
+        saved.spawned = record[8];
+        saved.budget = 0;
+        if ( saved.place < 0 || saved.place >= countCells || record[4] < -1 || record[4] >= (int)loots.size() || saved.every < 0 ||
+             saved.near < 0 || saved.total <= 0 || saved.spawned < 0 || saved.spawned > saved.total ){
+            throw Exception ( errorMess );
+        }
+        if ( record[4] >= 0 ){
+            saved.loot = loots[ record[4] ];
+        }
+        map->spawners.add( saved );
+    }
+    memcpy( &countBudgets, spawner, sizeof(countBudgets) );
+    spawner += sizeof(countBudgets);
+    if ( countBudgets < 0 || data + header->items - spawner != countBudgets * 2LL * (long long)sizeof(int32_t) + (long long)sizeof(int32_t) ){
+        throw Exception ( errorMess );
+    }
+    for ( int i = 0; i < countBudgets; ++i ){
+        int32_t record[2];
+        memcpy( record, spawner, sizeof(record) );
+        spawner += sizeof(record);
+        if ( record[0] < 0 || record[0] >= countCells || record[1] <= 0 ){
+            throw Exception ( errorMess );
+        }
+        map->spawners.addBudget( record[0], record[1] );
+    }
+    int32_t turn = 0;
+    memcpy( &turn, spawner, sizeof(turn) );
+    map->turn = turn;
+    map->spawners.relabel( *map->regions, map->links, map->world );
+    // triggers were saved in order of index, build keeps it
+    triggers->build();
+    map->triggers = triggers;
+    return map;
+}
+/*********************************************************/
+unsigned char SaveGame::typeOf( const MapElement &elem ){
+    if ( elem.getItem() >= 0 ){
+        return ITEM;
+    }
+    switch ( elem.getSymbol() ){
+        case '#':   return BARRIER;
+        case '!':   return THORN;
+        case '%':   return STAIRS;
+        case 'e':   return ENEMY;
+    }
+    return EMPTY;
+}
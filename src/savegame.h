@@ -0,0 +1,112 @@
+/** @file savegame.h
+ * Header file of SaveGame class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef SAVEGAME_H
+#define SAVEGAME_H
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include "map.h"
+using namespace std;
+#define C_SAVE_FILE     "savegame.sav"      // file of saved game
+#define C_AUTOSAVE_FILE "autosave.sav"      // file of game saved by AutoSave
+#define C_SAVE_MAGIC    0x53475052          // "RPGS"
+#define C_SAVE_VERSION  5
+#define C_SAVE_BUFFER   (1 << 20)           // size of buffer for writing
+/**********************************************************************************************/
+/**
+ * @brief The SaveGame class
+ * @detailed    Binary snapshot of game world:
+ *              header (SaveHeader) | hero's name | one byte (typeMapObj) for every place of map |
+ *              count of enemies | (position, health, damage, defence, loot) for every enemy |
+ *              count of triggers | (Trigger, fired) for every trigger | count of messages |
+ *              (length, text) for every message of triggers | count of spawners | (position, health,
+ *              damage, defence, loot, every, near, total, spawned) for every spawner | count of
+ *              budgets | (position, budget) for every budget | count of steps | count of item types |
+ *              (length, name) for every item type | count of loot tables | (length, name) for every
+ *              loot table | count of items on map | (position, item) for every item on map |
+ *              count of stacks | (item, count) for every stack of inventory.
+ *              Items and loot tables are numbers of names in file (loot -1 is enemy without table),
+ *              so saved game doesn't depend on order of items file. Header is written again at
+ *              the end, when offset of items is known.
+ *              All numbers are 32-bit in native byte order. File is written in one sequential pass
+ *              to temporary file, which replaces the old one at the end. It is read through mmap.
+ */
+class SaveGame{
+    public:
+        /**
+         * @brief save writes snapshot of map and hero to file
+         * @param fileName is name of file
+         * @param map is map to save
+         * @param rate is max count of bytes written per second, 0 means without limit
+         * @return size of file in bytes
+         * @throw exception if file can't be written
+         */
+        static long long save( const string &fileName, Map &map, long long rate = 0 );
+        /**
+         * @brief latest chooses the newer one of manually saved and autosaved game
+         * @return name of file to load
+         */
+        static string latest();
+        /**
+         * @brief SaveGame is constructor with parameters, it maps file to memory and checks it
+         * @param fileName is name of file with saved game
+         * @throw exception if there isn't file or it is damaged
+         */
+        SaveGame( const string &fileName );
+        /**
+         * @brief ~SaveGame is destruktor, it unmaps file
+         */
+        ~SaveGame();
+        /**
+         * @brief createHero makes hero with saved name, skills, inventory and direction
+         * @return pointer at hero
+         */
+        shared_ptr<Hero> createHero() const;
+        /**
+         * @brief createMap makes map with all saved objects and hero
+         * @return pointer at map
+         * @throw exception if file is damaged
+         */
+        shared_ptr<Map> createMap() const;
+        /**
+         * @brief typeOf translates map element to type of object
+         * @param elem is map element
+         * @return type of object (typeMapObj)
+         */
+        static unsigned char typeOf( const MapElement &elem );
+    private:
+        /**
+         * @brief readItems reads names of item types and loot tables of section of items
+         * @param items is output, id in ItemRegistry for every number of name of item type
+         * @param loots is output, id in ItemRegistry for every number of name of loot table
+         * @return position after names
+         * @throw exception if file is damaged or item type or loot table isn't known anymore
+         */
+        const char *readItems( vector<int> &items, vector<int> &loots ) const;
+        /**
+         * @brief The SaveHeader struct is the beginning of file
+         */
+        struct SaveHeader{
+            uint32_t magic;
+            uint32_t version;
+            int32_t height, width;
+            int32_t heroPos;
+            int32_t countEnemies;               // enemies to kill
+            int32_t heroType;                   // HeroType
+            int32_t direction;
+            int32_t health, damage, defence;
+            int32_t items;                      // offset of section of items
+            int32_t nameLength;
+            uint64_t random;                    // state of random generator
+        };
+        const char *data;
+        size_t size;
+        const SaveHeader *header;
+        SaveGame( const SaveGame & );
+        SaveGame &operator=( const SaveGame & );
+};
+/**********************************************************************************************/
+#endif // SAVEGAME_H
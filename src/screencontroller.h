@@ -9,6 +9,8 @@
 #include <ncurses.h>
 #include "data.h"
 #include "page.h"
+#include "profiler.h"
+#include "alloctracker.h"
 using namespace std;
 /**********************************************************************************************/
 /**
@@ -23,8 +25,22 @@ class ScreenController{
          * @param sd is screen data
          */
         void processData( shared_ptr<ScreenData> sd ){
-            shared_ptr<ScreenPage> sp = getScreenPage(sd);
-            sp->show();
+            processData( sd, terminal );
+        }
+        /**
+         * @brief processData acceptes currient page and draws it on canvas
+         * @param sd is screen data
+         * @param canvas is surface to draw on
+         */
+        void processData( shared_ptr<ScreenData> sd, Canvas &canvas ){
+            PROFILE_SCOPE( "ScreenController::processData" );
+            shared_ptr<ScreenPage> sp;
+            {
+                ALLOC_SCOPE( "ScreenController::getScreenPage" );
+                sp = getScreenPage(sd);
+            }
+            ALLOC_SCOPE( "ScreenPage::show" );
+            sp->show( canvas );
         }
         /**
          * @brief graphicDriverOn is turn on and open all ncurses' functions
@@ -35,6 +51,7 @@ class ScreenController{
             keypad(stdscr,TRUE);                        // turn on catch from keyboard
             start_color();                              // turn on colors
             curs_set(0);                                // turn off
+            mousemask(BUTTON1_CLICKED | BUTTON1_PRESSED, NULL);    // click on map to travel
             init_pair(1, COLOR_CYAN, COLOR_BLACK );     // numb of color pair, text, background
             init_pair(2, COLOR_BLACK, COLOR_CYAN);
             init_pair(3, COLOR_WHITE, COLOR_BLACK );
@@ -54,6 +71,7 @@ class ScreenController{
             endwin();
         }
     private:
+        CursesCanvas terminal;
         /**
          * @brief getScreenPage is getter for currient page that has to show on the screen
          * @param sd is data to show on screeen
@@ -77,6 +95,10 @@ class ScreenController{
                     shared_ptr<CreateHeroPage> cp( new CreateHeroPage (static_cast<CreateHeroData&>(*sd) ) );
                     return cp;
                 }
+                case DIALOG:{
+                    shared_ptr<DialogPage> dp( new DialogPage (static_cast<DialogData&>(*sd) ) );
+                    return dp;
+                }
                 default:{
                     break;
                 }
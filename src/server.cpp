@@ -0,0 +1,720 @@
+/** @file server.cpp
+ * Implementation of Server class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "server.h"
+#include "runtimestats.h"
+#define C_SERVER_LISTEN_ID  0               // epoll ids of server's own descriptors
+#define C_SERVER_WAKE_ID    1
+#define C_SERVER_WATCH_ID   2
+/**********************************************************************************************/
+volatile sig_atomic_t Server::stopped = 0;
+/*********************************************************/
+Server::Server( const string &address, const vector<string> &arguments, int countShards ) : arguments(arguments), listenFd(-1), watchFd(-1), epollFd(-1), wakeFd(-1),
+                                                                          nextId( C_SERVER_WATCH_ID + 1 ), migrating(false), started(false),
+                                                                          countServed(0), maxSessions(0), countWatched(0), countDropped(0){
+    // wrong files are found now, not at first client
+    Session check ( 0, arguments );
+    listenFd = openListener( address );
+    // spectators: SOCKET.watch for Unix socket, PORT+1 for TCP
+    if ( address.compare( 0, 4, "tcp:" ) == 0 ){
+        watchFd = openListener( "tcp:" + to_string( atoi( address.c_str() + 4 ) + 1 ) );
+    } else {
+        watchFd = openListener( address + ".watch" );
+    }
+    epollFd = epoll_create1( EPOLL_CLOEXEC );
+    wakeFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    struct epoll_event event;
+    memset( &event, 0, sizeof(event) );
+    event.events = EPOLLIN;
+    event.data.u64 = C_SERVER_LISTEN_ID;
+    if ( listen( listenFd, C_SERVER_BACKLOG ) != 0 || epollFd < 0 || wakeFd < 0 ||
+         epoll_ctl( epollFd, EPOLL_CTL_ADD, listenFd, &event ) != 0 ){
+        throw Exception ( "Server can't listen on " + address + ": " + strerror(errno) + "\n" );
+    }
+    event.data.u64 = C_SERVER_WAKE_ID;
+    epoll_ctl( epollFd, EPOLL_CTL_ADD, wakeFd, &event );
+    event.data.u64 = C_SERVER_WATCH_ID;
+    if ( listen( watchFd, C_SERVER_BACKLOG ) != 0 || epoll_ctl( epollFd, EPOLL_CTL_ADD, watchFd, &event ) != 0 ){
+        throw Exception ( "Server can't listen for spectators: " + string ( strerror(errno) ) + "\n" );
+    }
+    int count = countShards > 0 ? countShards : thread::hardware_concurrency();
+    count = min( max( count, 1 ), C_SHARD_MAX );
+    for ( int i = 0; i < count; ++i ){
+        shards.push_back( shared_ptr<Shard>( new Shard ( arguments, wakeFd ) ) );
+    }
+    pending.resize( count );
+    countOnShard.resize( count, 0 );
+    lastBusy.resize( count, 0 );
+    countMigrated.resize( count, 0 );
+}
+/*********************************************************/
+Server::~Server(){
+    stopShards();
+    for ( map<long long, Connection>::iterator it = connections.begin(); it != connections.end(); ++it ){
+        if ( it->second.fd >= 0 ){
+            close( it->second.fd );
+        }
+    }
+    for ( map<long long, Spectator>::iterator it = spectators.begin(); it != spectators.end(); ++it ){
+        close( it->second.fd );
+    }
+    if ( listenFd >= 0 ){
+        close( listenFd );
+    }
+    if ( watchFd >= 0 ){
+        close( watchFd );
+    }
+    if ( epollFd >= 0 ){
+        close( epollFd );
+    }
+    if ( wakeFd >= 0 ){
+        close( wakeFd );
+    }
+    for ( size_t i = 0; i < socketPaths.size(); ++i ){
+        unlink( socketPaths[i].c_str() );
+    }
+}
+/*********************************************************/
+int Server::openListener( const string &address ){
+    int fd;
+    if ( address.compare( 0, 4, "tcp:" ) == 0 ){
+        fd = socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+        int on = 1;
+        setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on) );
+        struct sockaddr_in addr;
+        memset( &addr, 0, sizeof(addr) );
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons( atoi( address.c_str() + 4 ) );
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        if ( fd < 0 || bind( fd, (struct sockaddr *)&addr, sizeof(addr) ) != 0 ){
+            throw Exception ( "Server can't listen on " + address + ": " + strerror(errno) + "\n" );
+        }
+    } else {
+        fd = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+        struct sockaddr_un addr;
+        memset( &addr, 0, sizeof(addr) );
+        addr.sun_family = AF_UNIX;
+        if ( address.size() >= sizeof(addr.sun_path) ){
+            throw Exception ( "Path of socket is too long.\n" );
+        }
+        strcpy( addr.sun_path, address.c_str() );
+        unlink( address.c_str() );
+        if ( fd < 0 || bind( fd, (struct sockaddr *)&addr, sizeof(addr) ) != 0 ){
+            throw Exception ( "Server can't listen on " + address + ": " + strerror(errno) + "\n" );
+        }
+        socketPaths.push_back( address );
+    }
+    return fd;
+}
+/*********************************************************/
+void Server::run(){
+    struct sigaction action;
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = onSignal;               // without SA_RESTART, so epoll_wait is interrupted
+    sigaction( SIGINT, &action, NULL );
+    sigaction( SIGTERM, &action, NULL );
+    signal( SIGPIPE, SIG_IGN );
+    RuntimeStats::install();
+    // workers inherit blocked signals, so only this thread is interrupted
+    sigset_t blocked, previous;
+    sigemptyset( &blocked );
+    sigaddset( &blocked, SIGINT );
+    sigaddset( &blocked, SIGTERM );
+    sigaddset( &blocked, SIGUSR1 );
+    pthread_sigmask( SIG_BLOCK, &blocked, &previous );
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        shards[i]->start();
+    }
+    started = true;
+    pthread_sigmask( SIG_SETMASK, &previous, NULL );
+
+    typedef chrono::steady_clock Clock;
+    Clock::time_point nextBalance = Clock::now() + chrono::milliseconds( C_SERVER_BALANCE );
+    Clock::time_point nextReport = Clock::now() + chrono::seconds( C_SERVER_REPORT );
+    long long reported = 0;
+    bool waiting = false;
+    struct epoll_event events[C_SERVER_EVENTS];
+    while ( !stopped ){
+        int timeout = waiting ? 1 : max( 0, (int)chrono::duration_cast<chrono::milliseconds>( nextBalance - Clock::now() ).count() );
+        int count = epoll_wait( epollFd, events, C_SERVER_EVENTS, timeout );
+        for ( int i = 0; i < count; ++i ){
+            long long id = events[i].data.u64;
+            if ( id == C_SERVER_LISTEN_ID ){
+                acceptClients();
+                continue;
+            }
+            if ( id == C_SERVER_WAKE_ID ){
+                uint64_t value;
+                if ( read( wakeFd, &value, sizeof(value) ) < 0 ){
+                    // the other shard has already reset it
+                }
+                fromShards();
+                continue;
+            }
+            if ( id == C_SERVER_WATCH_ID ){
+                acceptSpectators();
+                continue;
+            }
+            if ( spectators.count( id ) ){
+                if ( events[i].events & ( EPOLLERR | EPOLLHUP ) ){
+                    closeSpectator( id );
+                    continue;
+                }
+                if ( events[i].events & EPOLLOUT ){
+                    flushSpectator( id );
+                }
+                if ( ( events[i].events & EPOLLIN ) && spectators.count( id ) ){
+                    receiveSpectator( id );
+                }
+                continue;
+            }
+            if ( !connections.count( id ) ){
+                continue;
+            }
+            if ( events[i].events & ( EPOLLERR | EPOLLHUP ) ){
+                closeConnection( id );
+                continue;
+            }
+            if ( events[i].events & EPOLLOUT ){
+                flush( id );
+            }
+            if ( events[i].events & EPOLLIN ){
+                receive( id );
+            }
+        }
+        waiting = sendPending();
+        if ( RuntimeStats::isRequested() ){
+            // maps belong to shards, so snapshot has only process, combats and shards
+            ofstream file ( RuntimeStats::getFileName().c_str(), ios::app );
+            RuntimeStats::write( file, NULL );
+            report( file );
+            file << endl;
+        }
+        if ( Clock::now() >= nextBalance ){
+            balance();
+            nextBalance = Clock::now() + chrono::milliseconds( C_SERVER_BALANCE );
+        }
+        if ( Clock::now() >= nextReport ){
+            long long ticks = 0;
+            for ( size_t i = 0; i < shards.size(); ++i ){
+                ticks += shards[i]->getLatency().getCount();
+            }
+            if ( ticks != reported ){
+                report( cout );
+                reported = ticks;
+            }
+            nextReport = Clock::now() + chrono::seconds( C_SERVER_REPORT );
+        }
+    }
+    stopShards();
+    report( cout );
+    cout << "Server stopped, " << countServed << " sessions served, at most " << maxSessions << " at once." << endl;
+}
+/*********************************************************/
+void Server::report( ostream &os ) const{
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        const LatencyHistogram &latency = shards[i]->getLatency();
+        os << "Shard " << i << ": " << countOnShard[i] << " sessions, " << latency.getCount() << " ticks, "
+           << fixed << setprecision(1)
+           << "p50 " << latency.getPercentile( 0.5 ) / 1000.0 << " us, "
+           << "p90 " << latency.getPercentile( 0.9 ) / 1000.0 << " us, "
+           << "p99 " << latency.getPercentile( 0.99 ) / 1000.0 << " us, "
+           << "max " << latency.getMax() / 1000.0 << " us, "
+           << countMigrated[i] << " sessions moved away." << endl;
+    }
+    os << "Spectators: " << spectators.size() << " watching " << channels.size() << " sessions, "
+       << countWatched << " served, " << countDropped << " dropped to keyframe." << endl;
+}
+/*********************************************************/
+void Server::acceptClients(){
+    while ( true ){
+        int fd = accept4( listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC );
+        if ( fd < 0 ){
+            if ( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR ){
+                cerr << "accept: " << strerror(errno) << endl;
+            }
+            return;
+        }
+        long long id = nextId++;
+        struct epoll_event event;
+        memset( &event, 0, sizeof(event) );
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        if ( epoll_ctl( epollFd, EPOLL_CTL_ADD, fd, &event ) != 0 ){
+            close( fd );
+            continue;
+        }
+        int shard = min_element( countOnShard.begin(), countOnShard.end() ) - countOnShard.begin();
+        Connection &connection = connections[id];
+        connection.fd = fd;
+        connection.shard = shard;
+        connection.waiting = false;
+        connection.finished = false;
+        connection.migrating = false;
+        countOnShard[shard]++;
+        countServed++;
+        maxSessions = max( maxSessions, connections.size() );
+        ShardMessage message ( SHARD_OPEN, id );
+        toShard( shard, message );
+    }
+}
+/*********************************************************/
+void Server::receive( long long id ){
+    Connection &connection = connections[id];
+    if ( connection.fd < 0 ){
+        return;
+    }
+    char buffer[C_SERVER_READ];
+    ssize_t length = recv( connection.fd, buffer, sizeof(buffer), 0 );
+    if ( length == 0 || ( length < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR ) ){
+        closeConnection( id );
+        return;
+    }
+    if ( length <= 0 ){
+        return;
+    }
+    if ( connection.migrating ){
+        connection.held.append( buffer, length );
+        return;
+    }
+    ShardMessage message ( SHARD_KEYS, id );
+    message.bytes.assign( buffer, length );
+    toShard( connection.shard, message );
+}
+/*********************************************************/
+void Server::flush( long long id ){
+    Connection &connection = connections[id];
+    if ( connection.fd < 0 ){
+        return;
+    }
+    string &output = connection.output;
+    size_t sent = 0;
+    while ( sent < output.size() ){
+        ssize_t part = send( connection.fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL );
+        if ( part <= 0 ){
+            break;
+        }
+        sent += part;
+    }
+    output.erase( 0, sent );
+    if ( output.empty() ){
+        string().swap( output );                // idle session doesn't keep big buffer
+    }
+    if ( output.empty() && connection.finished ){
+        closeConnection( id );
+        return;
+    }
+    if ( output.size() > C_SERVER_MAX_OUTPUT ){
+        closeConnection( id );
+        return;
+    }
+    // wait for free place in socket only when something is left
+    if ( connection.waiting != !output.empty() ){
+        connection.waiting = !output.empty();
+        struct epoll_event event;
+        memset( &event, 0, sizeof(event) );
+        event.events = output.empty() ? EPOLLIN : ( EPOLLIN | EPOLLOUT );
+        event.data.u64 = id;
+        epoll_ctl( epollFd, EPOLL_CTL_MOD, connection.fd, &event );
+    }
+}
+/*********************************************************/
+void Server::closeConnection( long long id ){
+    Connection &connection = connections[id];
+    if ( connection.fd < 0 ){
+        return;
+    }
+    epoll_ctl( epollFd, EPOLL_CTL_DEL, connection.fd, NULL );
+    close( connection.fd );
+    connection.fd = -1;
+    string().swap( connection.output );
+    string().swap( connection.held );
+    // connection is forgotten when shard confirms that session is deleted
+    ShardMessage message ( SHARD_CLOSE, id );
+    toShard( connection.shard, message );
+}
+/*********************************************************/
+void Server::toShard( int shard, ShardMessage &message ){
+    deque<ShardMessage> &queue = pending[shard];
+    if ( message.type == SHARD_KEYS && !queue.empty() && queue.back().type == SHARD_KEYS && queue.back().id == message.id ){
+        queue.back().bytes += message.bytes;
+        return;
+    }
+    queue.push_back( ShardMessage () );
+    swap( queue.back(), message );
+}
+/*********************************************************/
+bool Server::sendPending(){
+    bool waiting = false;
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        deque<ShardMessage> &queue = pending[i];
+        if ( queue.empty() ){
+            continue;
+        }
+        while ( !queue.empty() && shards[i]->send( queue.front() ) ){
+            queue.pop_front();
+        }
+        shards[i]->wake();
+        waiting = waiting || !queue.empty();
+    }
+    return waiting;
+}
+/*********************************************************/
+void Server::fromShards(){
+    ShardMessage message;
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        while ( shards[i]->receive( message ) ){
+            fromShard( i, message );
+        }
+    }
+}
+/*********************************************************/
+void Server::fromShard( int shard, ShardMessage &message ){
+    map<long long, Connection>::iterator it = connections.find( message.id );
+    if ( message.type == SHARD_MIGRATED ){
+        migrating = false;
+        if ( message.session == NULL || it == connections.end() ){
+            return;
+        }
+        countOnShard[shard]--;
+        countOnShard[message.target]++;
+        countMigrated[shard]++;
+        Connection &connection = it->second;
+        connection.shard = message.target;
+        connection.migrating = true;
+        ShardMessage open ( SHARD_OPEN, message.id );
+        open.session = message.session;
+        toShard( message.target, open );
+        ShardMessage fence ( SHARD_FENCE, message.id );
+        toShard( shard, fence );
+        return;
+    }
+    if ( message.type == SHARD_FEED ){
+        publish( message.id, message.frame );
+        return;
+    }
+    if ( it == connections.end() ){
+        return;
+    }
+    Connection &connection = it->second;
+    switch ( message.type ){
+        case SHARD_FRAME:
+            if ( connection.fd < 0 ){
+                return;
+            }
+            connection.output += message.bytes;
+            connection.finished = connection.finished || message.finished;
+            flush( message.id );
+            return;
+        case SHARD_FENCED:{
+            connection.migrating = false;
+            if ( connection.held.empty() ){
+                return;
+            }
+            ShardMessage keys ( SHARD_KEYS, message.id );
+            keys.bytes.swap( connection.held );
+            toShard( connection.shard, keys );
+            return;
+        }
+        case SHARD_KEYS:
+        case SHARD_CLOSE:
+        case SHARD_WATCH:
+            // session moved away before message came, send it after session
+            if ( connection.shard != shard ){
+                toShard( connection.shard, message );
+            } else if ( message.type == SHARD_CLOSE ){
+                countOnShard[shard]--;                  // session wasn't created
+                connections.erase( it );
+                endChannel( message.id );
+            }
+            return;
+        case SHARD_CLOSED:
+            countOnShard[shard]--;
+            connections.erase( it );
+            endChannel( message.id );
+            return;
+        default:
+            return;
+    }
+}
+/*********************************************************/
+void Server::balance(){
+    vector<long long> load ( shards.size() );
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        long long busy = shards[i]->getBusy();
+        load[i] = busy - lastBusy[i];
+        lastBusy[i] = busy;
+    }
+    if ( migrating || shards.size() < 2 ){
+        return;
+    }
+    int busiest = max_element( load.begin(), load.end() ) - load.begin();
+    int idlest = min_element( load.begin(), load.end() ) - load.begin();
+    if ( countOnShard[busiest] < 2 || load[busiest] < C_SERVER_IMBALANCE * load[idlest] + C_SERVER_MIN_LOAD ){
+        return;
+    }
+    ShardMessage message ( SHARD_MIGRATE );
+    message.target = idlest;
+    toShard( busiest, message );
+    migrating = true;
+}
+/*********************************************************/
+void Server::stopShards(){
+    if ( !started ){
+        return;
+    }
+    started = false;
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        ShardMessage message ( SHARD_STOP );
+        toShard( i, message );
+    }
+    // shard can wait for free place in outbox, so outboxes are emptied meanwhile
+    ShardMessage message;
+    while ( sendPending() ){
+        for ( size_t i = 0; i < shards.size(); ++i ){
+            while ( shards[i]->receive( message ) ){
+            }
+        }
+        this_thread::yield();
+    }
+    for ( size_t i = 0; i < shards.size(); ++i ){
+        while ( true ){
+            while ( shards[i]->receive( message ) ){
+            }
+            // thread may still wait on full outbox
+            if ( !shards[i]->isRunning() ){
+                break;
+            }
+            this_thread::yield();
+        }
+        shards[i]->join();
+    }
+}
+/*********************************************************/
+void Server::acceptSpectators(){
+    while ( true ){
+        int fd = accept4( watchFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC );
+        if ( fd < 0 ){
+            return;
+        }
+        long long id = nextId++;
+        struct epoll_event event;
+        memset( &event, 0, sizeof(event) );
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        if ( epoll_ctl( epollFd, EPOLL_CTL_ADD, fd, &event ) != 0 ){
+            close( fd );
+            continue;
+        }
+        Spectator &spectator = spectators[id];
+        spectator.fd = fd;
+        spectator.session = 0;
+        spectator.offset = 0;
+        spectator.queued = 0;
+        spectator.waiting = false;
+        spectator.finished = false;
+        countWatched++;
+    }
+}
+/*********************************************************/
+void Server::receiveSpectator( long long id ){
+    Spectator &spectator = spectators[id];
+    char buffer[C_SERVER_READ];
+    ssize_t length = recv( spectator.fd, buffer, sizeof(buffer), 0 );
+    if ( length == 0 || ( length < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR ) ){
+        closeSpectator( id );
+        return;
+    }
+    if ( length <= 0 || spectator.session != 0 ){
+        return;                                 // only the first line is request
+    }
+    spectator.request.append( buffer, length );
+    size_t end = spectator.request.find( '\n' );
+    if ( end == string::npos ){
+        if ( spectator.request.size() > C_SERVER_READ ){
+            closeSpectator( id );
+        }
+        return;
+    }
+    // number of session, or empty line for the newest game
+    long long session = atoll( spectator.request.c_str() );
+    string().swap( spectator.request );
+    if ( session == 0 ){
+        for ( map<long long, Connection>::reverse_iterator it = connections.rbegin(); it != connections.rend(); ++it ){
+            if ( it->second.fd >= 0 ){
+                session = it->first;
+                break;
+            }
+        }
+    }
+    map<long long, Connection>::iterator connection = connections.find( session );
+    if ( connection == connections.end() || connection->second.fd < 0 ){
+        closeSpectator( id );
+        return;
+    }
+    spectator.session = session;
+    map<long long, Channel>::iterator channel = channels.find( session );
+    if ( channel == channels.end() ){
+        // the first spectator, session starts to make frames from keyframe
+        channels[session].spectators.push_back( id );
+        ShardMessage message ( SHARD_WATCH, session );
+        message.target = 1;
+        toShard( connection->second.shard, message );
+        return;
+    }
+    channel->second.spectators.push_back( id );
+    for ( size_t i = 0; i < channel->second.recent.size(); ++i ){
+        enqueue( spectator, channel->second, channel->second.recent[i] );
+    }
+    flushSpectator( id );
+}
+/*********************************************************/
+void Server::publish( long long session, const shared_ptr<const string> &frame ){
+    map<long long, Channel>::iterator it = channels.find( session );
+    if ( it == channels.end() ){
+        return;                                 // the last spectator has left
+    }
+    Channel &channel = it->second;
+    if ( (*frame)[4] == FRAME_KEY ){
+        channel.recent.clear();
+    } else if ( channel.recent.empty() ){
+        return;                                 // delta from before the first keyframe
+    }
+    channel.recent.push_back( frame );
+    for ( size_t i = 0; i < channel.spectators.size(); ++i ){
+        long long id = channel.spectators[i];
+        enqueue( spectators[id], channel, frame );
+        flushSpectator( id );
+    }
+}
+/*********************************************************/
+void Server::enqueue( Spectator &spectator, const Channel &channel, const shared_ptr<const string> &frame ){
+    if ( spectator.queued + frame->size() <= C_FEED_BACKLOG ){
+        spectator.queue.push_back( frame );
+        spectator.queued += frame->size();
+        return;
+    }
+    // spectator is too slow, old frames are replaced by the last keyframe and deltas after it,
+    // only partly sent frame has to be finished
+    countDropped++;
+    deque<shared_ptr<const string> > queue;
+    spectator.queued = 0;
+    if ( spectator.offset > 0 ){
+        queue.push_back( spectator.queue.front() );
+        spectator.queued = spectator.queue.front()->size() - spectator.offset;
+    }
+    for ( size_t i = 0; i < channel.recent.size(); ++i ){
+        queue.push_back( channel.recent[i] );
+        spectator.queued += channel.recent[i]->size();
+    }
+    spectator.queue.swap( queue );
+}
+/*********************************************************/
+void Server::flushSpectator( long long id ){
+    Spectator &spectator = spectators[id];
+    while ( !spectator.queue.empty() ){
+        // frames are sent right from shared buffers
+        struct iovec parts[C_SERVER_IOV];
+        int count = 0;
+        for ( deque<shared_ptr<const string> >::iterator it = spectator.queue.begin(); it != spectator.queue.end() && count < C_SERVER_IOV; ++it ){
+            size_t skip = count == 0 ? spectator.offset : 0;
+            parts[count].iov_base = (void *)( (*it)->data() + skip );
+            parts[count].iov_len = (*it)->size() - skip;
+            count++;
+        }
+        struct msghdr header;
+        memset( &header, 0, sizeof(header) );
+        header.msg_iov = parts;
+        header.msg_iovlen = count;
+        ssize_t sent = sendmsg( spectator.fd, &header, MSG_NOSIGNAL | MSG_DONTWAIT );
+        if ( sent <= 0 ){
+            break;
+        }
+        spectator.queued -= sent;
+        while ( sent > 0 ){
+            size_t left = spectator.queue.front()->size() - spectator.offset;
+            if ( (size_t)sent < left ){
+                spectator.offset += sent;
+                break;
+            }
+            sent -= left;
+            spectator.offset = 0;
+            spectator.queue.pop_front();
+        }
+    }
+    if ( spectator.queue.empty() && spectator.finished ){
+        closeSpectator( id );
+        return;
+    }
+    if ( spectator.waiting != !spectator.queue.empty() ){
+        spectator.waiting = !spectator.queue.empty();
+        struct epoll_event event;
+        memset( &event, 0, sizeof(event) );
+        event.events = spectator.waiting ? ( EPOLLIN | EPOLLOUT ) : EPOLLIN;
+        event.data.u64 = id;
+        epoll_ctl( epollFd, EPOLL_CTL_MOD, spectator.fd, &event );
+    }
+}
+/*********************************************************/
+void Server::closeSpectator( long long id ){
+    map<long long, Spectator>::iterator it = spectators.find( id );
+    epoll_ctl( epollFd, EPOLL_CTL_DEL, it->second.fd, NULL );
+    close( it->second.fd );
+    long long session = it->second.session;
+    spectators.erase( it );
+    map<long long, Channel>::iterator channel = channels.find( session );
+    if ( channel == channels.end() ){
+        return;
+    }
+    vector<long long> &watching = channel->second.spectators;
+    watching.erase( find( watching.begin(), watching.end(), id ) );
+    if ( !watching.empty() ){
+        return;
+    }
+    channels.erase( channel );
+    map<long long, Connection>::iterator connection = connections.find( session );
+    if ( connection != connections.end() ){
+        ShardMessage message ( SHARD_WATCH, session );
+        message.target = 0;
+        toShard( connection->second.shard, message );
+    }
+}
+/*********************************************************/
+void Server::endChannel( long long session ){
+    map<long long, Channel>::iterator channel = channels.find( session );
+    if ( channel == channels.end() ){
+        return;
+    }
+    vector<long long> watching;
+    watching.swap( channel->second.spectators );
+    channels.erase( channel );
+    // spectators get the rest of game, then they are disconnected
+    for ( size_t i = 0; i < watching.size(); ++i ){
+        spectators[ watching[i] ].finished = true;
+        flushSpectator( watching[i] );
+    }
+}
+/*********************************************************/
+void Server::onSignal( int sig ){
+    stopped = 1;
+}
@@ -0,0 +1,233 @@
+/** @file server.h
+ * Header file of Server class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef SERVER_H
+#define SERVER_H
+#include <map>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <signal.h>
+#include "shard.h"
+#include "feed.h"
+using namespace std;
+#define C_SERVER_EVENTS     256             // max count of events from one epoll_wait
+#define C_SERVER_BACKLOG    1024            // queue of not accepted connections
+#define C_SERVER_READ       4096            // size of buffer for reading from client
+#define C_SERVER_MAX_OUTPUT (1 << 20)       // client which doesn't read so many bytes is disconnected
+#define C_SERVER_BALANCE    500             // ms between two checks of load of shards
+#define C_SERVER_IMBALANCE  2               // session moves if one shard is so many times busier...
+#define C_SERVER_MIN_LOAD   1000000         // ...and busier by at least so many ns per check
+#define C_SERVER_REPORT     10              // s between two reports of latency of shards
+#define C_SERVER_IOV        64              // max count of frames in one sendmsg to spectator
+/**********************************************************************************************/
+/**
+ * @brief The Server class
+ * @detailed    Hosts many games in one process. Server thread waits on epoll for all sockets,
+ *              it only reads and writes bytes. Games are played by shards (one worker thread
+ *              for every core), every session belongs to one shard, so its game is never
+ *              touched by two threads. Keys go to shard through its lock-free inbox, frames
+ *              come back through outbox. When one shard is much busier than another one, its
+ *              hottest session moves. Until the old shard confirms that it handled all older
+ *              keys of session (fence), new keys wait on server, so they can't overtake them.
+ *              Map files are loaded only once per shard (MapLibrary). Games on server can't be saved.
+ *              Spectators connect to the second socket and send number of session (or empty line
+ *              for the newest one) on one line. Then they get binary frames (Feed), every frame
+ *              is in memory only once for all spectators of session. Spectator who doesn't read
+ *              gets the last keyframe instead of old frames.
+ */
+class Server{
+    public:
+        /**
+         * @brief Server is constructor with parameters, it starts to listen
+         * @param address is path of Unix domain socket or "tcp:PORT" for loopback TCP
+         * @param arguments are map file and quest file
+         * @param countShards is count of worker threads, 0 for one per core
+         * @throw exception if socket can't be opened or files are wrong
+         */
+        Server( const string &address, const vector<string> &arguments, int countShards = 0 );
+        /**
+         * @brief ~Server is destruktor, it stops shards and closes all sockets
+         */
+        ~Server();
+        /**
+         * @brief run serves clients until SIGINT or SIGTERM comes
+         */
+        void run();
+        /**
+         * @brief getCountSessions is getter for count of connected players
+         * @return count of sessions
+         */
+        int getCountSessions() const{
+            return connections.size();
+        }
+        /**
+         * @brief report writes count of sessions and percentiles of tick latency of every shard
+         * @param os is output stream
+         */
+        void report( ostream &os ) const;
+    private:
+        /**
+         * @brief The Connection struct
+         * @detailed    Socket of one session, as server thread sees it.
+         */
+        struct Connection{
+            int fd;                             // -1 when socket is closed, session is still on shard
+            int shard;
+            string output;                      // bytes waiting for socket
+            string held;                        // keys waiting for end of migration
+            bool waiting;                       // waits for EPOLLOUT
+            bool finished;
+            bool migrating;
+        };
+        /**
+         * @brief The Spectator struct
+         * @detailed    Socket of one spectator and frames which wait for it.
+         */
+        struct Spectator{
+            int fd;
+            long long session;                  // 0 until spectator chooses session
+            string request;
+            deque<shared_ptr<const string> > queue;
+            size_t offset;                      // sent bytes of the first frame
+            size_t queued;                      // bytes in queue without sent ones
+            bool waiting;                       // waits for EPOLLOUT
+            bool finished;                      // game ended, spectator leaves after queue
+        };
+        /**
+         * @brief The Channel struct
+         * @detailed    Spectators of one session and frames since the last keyframe, which
+         *              are enough for anyone to see currient screen.
+         */
+        struct Channel{
+            vector<long long> spectators;
+            vector<shared_ptr<const string> > recent;
+        };
+        vector<string> socketPaths;             // Unix sockets to delete
+        vector<string> arguments;
+        int listenFd;
+        int watchFd;                            // socket for spectators
+        int epollFd;
+        int wakeFd;                             // eventfd signalled by shards
+        long long nextId;
+        map<long long, Connection> connections;
+        map<long long, Spectator> spectators;
+        map<long long, Channel> channels;       // watched sessions
+        vector<shared_ptr<Shard> > shards;
+        vector<deque<ShardMessage> > pending;   // messages which didn't fit into inbox
+        vector<int> countOnShard;
+        vector<long long> lastBusy;
+        vector<long long> countMigrated;
+        bool migrating;                         // one session is moving
+        bool started;
+        int countServed;
+        size_t maxSessions;
+        long long countWatched;
+        long long countDropped;
+        static volatile sig_atomic_t stopped;
+        /**
+         * @brief openListener opens socket for listening
+         * @param address is path of Unix domain socket or "tcp:PORT"
+         * @return socket
+         * @throw exception if socket can't be opened
+         */
+        int openListener( const string &address );
+        /**
+         * @brief acceptClients accepts all waiting connections
+         */
+        void acceptClients();
+        /**
+         * @brief receive reads bytes from client
+         * @param id is number of session
+         */
+        void receive( long long id );
+        /**
+         * @brief flush sends as much of output as socket takes, waits for EPOLLOUT for the rest
+         * @param id is number of session
+         */
+        void flush( long long id );
+        /**
+         * @brief closeConnection closes socket and asks shard to delete session
+         * @param id is number of session
+         */
+        void closeConnection( long long id );
+        /**
+         * @brief toShard queues message for shard
+         * @param shard is index of shard
+         * @param message is message, it is moved
+         */
+        void toShard( int shard, ShardMessage &message );
+        /**
+         * @brief sendPending moves queued messages into inboxes and wakes shards
+         * @return true if some message is still waiting
+         */
+        bool sendPending();
+        /**
+         * @brief fromShards handles all messages in outboxes
+         */
+        void fromShards();
+        /**
+         * @brief fromShard handles one message from shard
+         * @param shard is index of shard
+         * @param message is message
+         */
+        void fromShard( int shard, ShardMessage &message );
+        /**
+         * @brief balance moves the hottest session from the busiest shard to the idlest one
+         */
+        void balance();
+        /**
+         * @brief acceptSpectators accepts all waiting spectators
+         */
+        void acceptSpectators();
+        /**
+         * @brief receiveSpectator reads request of spectator
+         * @param id is number of spectator
+         */
+        void receiveSpectator( long long id );
+        /**
+         * @brief publish gives frame of session to all its spectators
+         * @param session is number of session
+         * @param frame is frame
+         */
+        void publish( long long session, const shared_ptr<const string> &frame );
+        /**
+         * @brief enqueue adds frame for spectator, drops to keyframe if spectator is too slow
+         * @param spectator is spectator
+         * @param channel is channel of spectator, its recent frames already have frame
+         * @param frame is frame
+         */
+        void enqueue( Spectator &spectator, const Channel &channel, const shared_ptr<const string> &frame );
+        /**
+         * @brief flushSpectator sends as much of frames as socket takes
+         * @param id is number of spectator
+         */
+        void flushSpectator( long long id );
+        /**
+         * @brief closeSpectator disconnects spectator, session stops making frames after the last one
+         * @param id is number of spectator
+         */
+        void closeSpectator( long long id );
+        /**
+         * @brief endChannel disconnects spectators of ended session after they get all frames
+         * @param session is number of session
+         */
+        void endChannel( long long session );
+        /**
+         * @brief stopShards stops all worker threads
+         */
+        void stopShards();
+        /**
+         * @brief onSignal stops server
+         * @param sig is number of signal
+         */
+        static void onSignal( int sig );
+        Server( const Server & );
+        Server &operator=( const Server & );
+};
+/**********************************************************************************************/
+#endif // SERVER_H
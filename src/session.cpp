@@ -0,0 +1,81 @@
+/** @file session.cpp
+ * Implementation of Session class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include "session.h"
+#include "profiler.h"
+#include "alloctracker.h"
+/**********************************************************************************************/
+Session::Session( long long id, const vector<string> &arguments ) : id(id), shown( C_SERVER_ROWS, C_SERVER_COLS ), finished(false),
+                                                                     watched(false), countFrames(0){
+    char *argv[3] = { (char *)"ostroiul", (char *)arguments[0].c_str(), (char *)arguments[1].c_str() };
+    game = shared_ptr<Game>( new Game ( 3, argv ) );
+    game->setSaving( false );
+}
+/*********************************************************/
+void Session::start( ScreenController &screen, TextCanvas &canvas ){
+    output += "\x1b[2J\x1b[?25l";               // clear terminal, hide cursor
+    data = game->start();
+    draw( screen, canvas );
+}
+/*********************************************************/
+void Session::receive( const char *bytes, int length, ScreenController &screen, TextCanvas &canvas ){
+    PROFILE_SCOPE( "Session::receive" );
+    AllocTracker::beginFrame();
+    for ( int i = 0; i < length && !finished; ++i ){
+        int key = (unsigned char)bytes[i];
+        if ( key == '\r' ){
+            key = '\n';
+            if ( i + 1 < length && bytes[i+1] == '\n' ){
+                i++;
+            }
+        } else if ( key == 27 && i + 2 < length && ( bytes[i+1] == '[' || bytes[i+1] == 'O' ) ){
+            // arrows, other sequences are ignored
+            switch ( bytes[i+2] ){
+                case 'A':   key = KEY_UP;       break;
+                case 'B':   key = KEY_DOWN;     break;
+                case 'C':   key = KEY_RIGHT;    break;
+                case 'D':   key = KEY_LEFT;     break;
+                default:    key = 0;            break;
+            }
+            i += 2;
+            if ( key == 0 ){
+                continue;
+            }
+        }
+        data = game->handleKey( key );
+        finished = game->gameStopped();
+    }
+    draw( screen, canvas );
+    if ( finished ){
+        output += "\x1b[0m\x1b[?25h\r\n";
+    }
+    AllocTracker::endFrame( data->type );
+}
+/*********************************************************/
+void Session::draw( ScreenController &screen, TextCanvas &canvas ){
+    PROFILE_SCOPE( "Session::draw" );
+    ALLOC_SCOPE( "Session::draw" );
+    canvas.clean();
+    screen.processData( data, canvas );
+    for ( int y = 0; y < canvas.getHeight(); ++y ){
+        if ( !canvas.isRowEqual( shown, y ) ){
+            canvas.appendRowAnsi( y, output );
+        }
+    }
+    if ( watched ){
+        bool isKey = countFrames % C_FEED_KEYFRAME == 0;
+        frames.push_back( Feed::encode( isKey ? NULL : &shown, canvas, *data, countFrames++ ) );
+    }
+    shown = canvas;
+}
+/*********************************************************/
+void Session::watch( bool isOn ){
+    watched = isOn;
+    if ( isOn && data != NULL ){
+        // frames of new spectators begin from what player has on screen now
+        countFrames += C_FEED_KEYFRAME - countFrames % C_FEED_KEYFRAME;
+        frames.push_back( Feed::encode( NULL, shown, *data, countFrames++ ) );
+    }
+}
@@ -0,0 +1,101 @@
+/** @file session.h
+ * Header file of Session class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef SESSION_H
+#define SESSION_H
+#include <memory>
+#include <string>
+#include <vector>
+#include "game.h"
+#include "canvas.h"
+#include "feed.h"
+#include "screencontroller.h"
+using namespace std;
+#define C_SERVER_ROWS       40              // size of screen of one session
+#define C_SERVER_COLS       100
+/**********************************************************************************************/
+/**
+ * @brief The Session class
+ * @detailed    One player connected to server. It has its own Game, keys come from client as
+ *              terminal bytes (arrows as escape sequences) and screen goes back as ANSI sequences.
+ *              Only rows which changed since the last frame are sent. Session doesn't touch
+ *              socket, so it can be played on any thread. When somebody watches the game,
+ *              every frame is also encoded for spectators (Feed).
+ */
+class Session{
+    public:
+        /**
+         * @brief Session is constructor with parameters
+         * @param id is number of client on server
+         * @param arguments are map file and quest file
+         */
+        Session( long long id, const vector<string> &arguments );
+        /**
+         * @brief getId is getter for number of client
+         * @return id
+         */
+        long long getId() const{
+            return id;
+        }
+        /**
+         * @brief start draws the first frame
+         * @param screen draws pages on canvas
+         * @param canvas is free canvas for drawing of frame
+         */
+        void start( ScreenController &screen, TextCanvas &canvas );
+        /**
+         * @brief receive handles all keys in bytes from client and draws new frame
+         * @param data are bytes from client
+         * @param length is count of bytes
+         * @param screen draws pages on canvas
+         * @param canvas is free canvas for drawing of frame
+         */
+        void receive( const char *data, int length, ScreenController &screen, TextCanvas &canvas );
+        /**
+         * @brief getOutput is getter for bytes waiting for sending to client
+         * @return output buffer, sent bytes have to be erased from it
+         */
+        string &getOutput(){
+            return output;
+        }
+        /**
+         * @brief isFinished says if player left the game
+         * @return true if session should be closed after sending of output
+         */
+        bool isFinished() const{
+            return finished;
+        }
+        /**
+         * @brief watch turns on or off frames for spectators
+         * @param isOn is true if somebody watches, then keyframe of currient screen is made
+         */
+        void watch( bool isOn );
+        /**
+         * @brief takeFrames gives frames for spectators made since the last call
+         * @param out is output, frames are appended
+         */
+        void takeFrames( vector<shared_ptr<const string> > &out ){
+            out.insert( out.end(), frames.begin(), frames.end() );
+            frames.clear();
+        }
+    private:
+        long long id;
+        shared_ptr<Game> game;
+        shared_ptr<ScreenData> data;            // the last screen of game
+        TextCanvas shown;                       // what client has on screen
+        string output;
+        bool finished;
+        bool watched;
+        uint32_t countFrames;                   // frames for spectators
+        vector<shared_ptr<const string> > frames;
+        /**
+         * @brief draw draws currient screen and adds changed rows to output
+         * @param screen draws pages on canvas
+         * @param canvas is free canvas for drawing of frame
+         */
+        void draw( ScreenController &screen, TextCanvas &canvas );
+};
+/**********************************************************************************************/
+#endif // SESSION_H
@@ -0,0 +1,200 @@
+/** @file shard.cpp
+ * Implementation of Shard class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <chrono>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "shard.h"
+#include "profiler.h"
+/**********************************************************************************************/
+Shard::Shard( const vector<string> &arguments, int wakeServer ) : arguments(arguments), inbox( C_SHARD_QUEUE ), outbox( C_SHARD_QUEUE ),
+                                                                  wakeFd(-1), wakeServer(wakeServer), replied(false),
+                                                                  canvas( C_SERVER_ROWS, C_SERVER_COLS ), running(false), busy(0), countSessions(0){
+    wakeFd = eventfd( 0, EFD_CLOEXEC );
+    if ( wakeFd < 0 ){
+        throw Exception ( "Server can't create worker thread.\n" );
+    }
+}
+/*********************************************************/
+Shard::~Shard(){
+    close( wakeFd );
+}
+/*********************************************************/
+void Shard::start(){
+    running.store( true, memory_order_release );
+    worker = thread( &Shard::run, this );
+}
+/*********************************************************/
+void Shard::join(){
+    if ( worker.joinable() ){
+        worker.join();
+    }
+}
+/*********************************************************/
+void Shard::wake(){
+    uint64_t one = 1;
+    if ( write( wakeFd, &one, sizeof(one) ) < 0 ){
+        // counter is already full, thread will wake anyway
+    }
+}
+/*********************************************************/
+void Shard::run(){
+    Profiler::nameThread( "shard" );
+    ShardMessage message;
+    while ( true ){
+        bool handled = false;
+        while ( inbox.pop( message ) ){
+            handled = true;
+            if ( !handle( message ) ){
+                notify();
+                running.store( false, memory_order_release );
+                return;
+            }
+        }
+        notify();
+        if ( !handled ){
+            // server writes eventfd after push, so message which came after pop isn't missed
+            uint64_t count;
+            if ( read( wakeFd, &count, sizeof(count) ) < 0 ){
+                continue;
+            }
+        }
+    }
+}
+/*********************************************************/
+bool Shard::handle( ShardMessage &message ){
+    map<long long, Slot>::iterator it = sessions.find( message.id );
+    switch ( message.type ){
+        case SHARD_OPEN:{
+            Slot slot;
+            slot.load = 0;
+            slot.session = message.session;
+            if ( slot.session == NULL ){
+                try{
+                    slot.session = shared_ptr<Session>( new Session ( message.id, arguments ) );
+                } catch ( Exception &exc ){
+                    ShardMessage answer ( SHARD_FRAME, message.id );
+                    answer.bytes = exc.getMessage();
+                    answer.finished = true;
+                    reply( answer );
+                    return true;
+                }
+            }
+            Slot &added = sessions[message.id] = slot;
+            countSessions.store( sessions.size(), memory_order_relaxed );
+            if ( message.session == NULL ){
+                play( added, message );
+            }
+            return true;
+        }
+        case SHARD_KEYS:
+            if ( it == sessions.end() ){
+                reply( message );
+                return true;
+            }
+            play( it->second, message );
+            return true;
+        case SHARD_CLOSE:
+            if ( it == sessions.end() ){
+                reply( message );
+                return true;
+            }
+            sessions.erase( it );
+            countSessions.store( sessions.size(), memory_order_relaxed );
+            message.type = SHARD_CLOSED;
+            reply( message );
+            return true;
+        case SHARD_WATCH:
+            if ( it == sessions.end() ){
+                reply( message );
+                return true;
+            }
+            it->second.session->watch( message.target != 0 );
+            sendFrames( *it->second.session );
+            return true;
+        case SHARD_MIGRATE:
+            migrate( message.target );
+            return true;
+        case SHARD_FENCE:
+            message.type = SHARD_FENCED;
+            reply( message );
+            return true;
+        default:
+            return false;
+    }
+}
+/*********************************************************/
+void Shard::play( Slot &slot, ShardMessage &message ){
+    PROFILE_SCOPE( "Shard::play" );
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    Session &session = *slot.session;
+    if ( message.type == SHARD_OPEN ){
+        session.start( screen, canvas );
+    } else {
+        session.receive( message.bytes.data(), message.bytes.size(), screen, canvas );
+    }
+    long long nanos = chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now() - begin ).count();
+    latency.add( nanos );
+    busy.fetch_add( nanos, memory_order_relaxed );
+    slot.load += nanos;
+    sendFrames( session );
+    if ( session.getOutput().empty() && !session.isFinished() ){
+        return;
+    }
+    ShardMessage answer ( SHARD_FRAME, message.id );
+    answer.bytes.swap( session.getOutput() );
+    answer.finished = session.isFinished();
+    reply( answer );
+}
+/*********************************************************/
+void Shard::sendFrames( Session &session ){
+    session.takeFrames( frames );
+    for ( size_t i = 0; i < frames.size(); ++i ){
+        ShardMessage answer ( SHARD_FEED, session.getId() );
+        answer.frame = frames[i];
+        reply( answer );
+    }
+    frames.clear();
+}
+/*********************************************************/
+void Shard::migrate( int target ){
+    ShardMessage answer ( SHARD_MIGRATED );
+    answer.target = target;
+    map<long long, Slot>::iterator hottest = sessions.end();
+    for ( map<long long, Slot>::iterator it = sessions.begin(); it != sessions.end(); ++it ){
+        if ( it->second.load > 0 && ( hottest == sessions.end() || it->second.load > hottest->second.load ) ){
+            hottest = it;
+        }
+        it->second.load /= 2;
+    }
+    // the only busy session would make the other shard busy in the same way
+    if ( sessions.size() >= 2 && hottest != sessions.end() ){
+        answer.id = hottest->first;
+        answer.session = hottest->second.session;
+        sessions.erase( hottest );
+        countSessions.store( sessions.size(), memory_order_relaxed );
+    }
+    reply( answer );
+}
+/*********************************************************/
+void Shard::reply( ShardMessage &message ){
+    while ( !outbox.push( message ) ){
+        notify();
+        this_thread::yield();
+    }
+    replied = true;
+}
+/*********************************************************/
+void Shard::notify(){
+    if ( !replied ){
+        return;
+    }
+    replied = false;
+    uint64_t one = 1;
+    if ( write( wakeServer, &one, sizeof(one) ) < 0 ){
+        // counter is already full, server will wake anyway
+    }
+}
@@ -0,0 +1,199 @@
+/** @file shard.h
+ * Header file of Shard class and ShardMessage structure.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef SHARD_H
+#define SHARD_H
+#include <map>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "session.h"
+#include "latency.h"
+#include "spscqueue.h"
+using namespace std;
+#define C_SHARD_QUEUE       4096            // capacity of inbox and outbox of one shard
+#define C_SHARD_MAX         16              // max count of worker threads
+/**********************************************************************************************/
+/**
+ * @brief The ShardMessageType enum
+ * @detailed    The first part goes from server to shard, the second part back. Message for
+ *              session which isn't on shard (it has just moved away) is returned unchanged.
+ */
+enum ShardMessageType{ SHARD_OPEN,          // new session, or moved session if it is in message
+                       SHARD_KEYS,          // bytes from client
+                       SHARD_CLOSE,         // client is disconnected
+                       SHARD_MIGRATE,       // give the hottest session to shard target
+                       SHARD_FENCE,         // all older messages of session are handled
+                       SHARD_WATCH,         // spectators came (target 1) or left (target 0)
+                       SHARD_STOP,          // end of thread
+                       SHARD_FRAME,         // bytes for client
+                       SHARD_MIGRATED,      // session for shard target, empty if shard has only one
+                       SHARD_FENCED,        // answer to SHARD_FENCE
+                       SHARD_FEED,          // frame for spectators
+                       SHARD_CLOSED };      // session is deleted
+/**********************************************************************************************/
+/**
+ * @brief The ShardMessage struct
+ * @detailed    Item of inbox and outbox of shard.
+ */
+struct ShardMessage{
+    ShardMessageType type;
+    long long id;                           // number of session
+    int target;                             // shard for migration
+    bool finished;                          // session ends after this frame
+    string bytes;
+    shared_ptr<Session> session;            // session which moves between shards
+    shared_ptr<const string> frame;         // frame for spectators
+    /**
+     * @brief ShardMessage is constructor with parameters
+     * @param type is type of message
+     * @param id is number of session
+     */
+    ShardMessage( ShardMessageType type = SHARD_STOP, long long id = 0 ) : type(type), id(id), target(-1), finished(false){}
+};
+/**********************************************************************************************/
+/**
+ * @brief The Shard class
+ * @detailed    Worker thread with its own part of sessions. Only this thread touches games of
+ *              its sessions, so nothing in game needs a lock. Server thread is the only producer
+ *              of inbox and the only consumer of outbox, both are lock-free SPSC queues.
+ *              Thread sleeps on eventfd when inbox is empty and wakes server by its eventfd.
+ *              Every handled message is one tick, its duration goes into latency histogram
+ *              and into load of session, which says what session should move when shard is busy.
+ */
+class Shard{
+    public:
+        /**
+         * @brief Shard is constructor with parameters
+         * @param arguments are map file and quest file
+         * @param wakeServer is eventfd of server, it is signalled when outbox gets message
+         */
+        Shard( const vector<string> &arguments, int wakeServer );
+        /**
+         * @brief ~Shard is destruktor, thread has to be stopped before
+         */
+        ~Shard();
+        /**
+         * @brief start starts thread
+         */
+        void start();
+        /**
+         * @brief join waits for end of thread after SHARD_STOP
+         */
+        void join();
+        /**
+         * @brief send gives message to shard, only server thread can call it
+         * @param message is message, it is moved into inbox
+         * @return false if inbox is full
+         */
+        bool send( ShardMessage &message ){
+            return inbox.push( message );
+        }
+        /**
+         * @brief isRunning says if thread hasn't ended yet
+         * @return true until thread handles SHARD_STOP
+         */
+        bool isRunning() const{
+            return running.load( memory_order_acquire );
+        }
+        /**
+         * @brief wake wakes thread after some messages are sent
+         */
+        void wake();
+        /**
+         * @brief receive takes message from shard, only server thread can call it
+         * @param message is output
+         * @return false if outbox is empty
+         */
+        bool receive( ShardMessage &message ){
+            return outbox.pop( message );
+        }
+        /**
+         * @brief getBusy is getter for time spent by ticks
+         * @return time in nanoseconds from start
+         */
+        long long getBusy() const{
+            return busy.load( memory_order_relaxed );
+        }
+        /**
+         * @brief getCountSessions is getter for count of sessions played on shard
+         * @return count of sessions
+         */
+        int getCountSessions() const{
+            return countSessions.load( memory_order_relaxed );
+        }
+        /**
+         * @brief getLatency is getter for durations of ticks
+         * @return histogram
+         */
+        const LatencyHistogram &getLatency() const{
+            return latency;
+        }
+    private:
+        /**
+         * @brief The Slot struct
+         * @detailed    Session with its load, load is halved at every migration request.
+         */
+        struct Slot{
+            shared_ptr<Session> session;
+            long long load;
+        };
+        vector<string> arguments;
+        SpscQueue<ShardMessage> inbox;
+        SpscQueue<ShardMessage> outbox;
+        int wakeFd;                             // eventfd of this thread
+        int wakeServer;
+        bool replied;                           // outbox got message since server was woken
+        thread worker;
+        map<long long, Slot> sessions;
+        ScreenController screen;
+        TextCanvas canvas;                      // all sessions of shard draw their frames here
+        vector<shared_ptr<const string> > frames;
+        atomic<bool> running;
+        atomic<long long> busy;
+        atomic<int> countSessions;
+        LatencyHistogram latency;
+        /**
+         * @brief run is loop of thread
+         */
+        void run();
+        /**
+         * @brief handle handles one message from inbox
+         * @param message is message
+         * @return false for SHARD_STOP
+         */
+        bool handle( ShardMessage &message );
+        /**
+         * @brief play gives keys to session or starts it and sends its frame
+         * @param slot is session
+         * @param message is SHARD_OPEN or SHARD_KEYS
+         */
+        void play( Slot &slot, ShardMessage &message );
+        /**
+         * @brief sendFrames sends frames for spectators of session
+         * @param session is session
+         */
+        void sendFrames( Session &session );
+        /**
+         * @brief migrate takes the hottest session away, if there are at least two
+         * @param target is shard which gets session
+         */
+        void migrate( int target );
+        /**
+         * @brief reply puts message into outbox, waits while outbox is full
+         * @param message is message
+         */
+        void reply( ShardMessage &message );
+        /**
+         * @brief notify wakes server if outbox got something
+         */
+        void notify();
+        Shard( const Shard & );
+        Shard &operator=( const Shard & );
+};
+/**********************************************************************************************/
+#endif // SHARD_H
@@ -0,0 +1,90 @@
+/** @file spawners.cpp
+ * Implementation of SpawnerSet class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include "spawners.h"
+#include "regions.h"
+/**********************************************************************************************/
+void SpawnerSet::add( const Spawner &spawner ){
+    spawners.push_back( spawner );
+}
+/*********************************************************/
+void SpawnerSet::addBudget( int place, int budget ){
+    places.push_back( make_pair( place, budget ) );
+}
+/*********************************************************/
+void SpawnerSet::relabel( const RegionMap &regions, const RegionLinks &links, World &world ){
+    budgets.clear();
+    numbers.clear();
+    for ( int i = 0; i < (int)spawners.size(); ++i ){
+        int region = links.getRegion( regions, spawners[i].place );
+        if ( numbers.insert( make_pair( region, (int)budgets.size() ) ).second ){
+            RegionBudget budget = { C_SPAWN_BUDGET, 0 };
+            budgets.push_back( budget );
+        }
+        spawners[i].budget = numbers[region];
+    }
+    if ( budgets.empty() ){
+        return;
+    }
+    for ( int i = 0; i < (int)places.size(); ++i ){
+        unordered_map<int, int>::const_iterator it = numbers.find( links.getRegion( regions, places[i].first ) );
+        if ( it != numbers.end() ){
+            budgets[it->second].budget = places[i].second;
+        }
+    }
+    Components<Position> &positions = world.getPositions();
+    for ( int i = 0; i < positions.getCount(); ++i ){
+        changePopulation( links.getRegion( regions, positions.at(i).index ), 1 );
+    }
+}
+/*********************************************************/
+void SpawnerSet::changePopulation( int region, int diff ){
+    if ( numbers.empty() ){
+        return;
+    }
+    unordered_map<int, int>::const_iterator it = numbers.find( region );
+    if ( it != numbers.end() ){
+        budgets[it->second].population += diff;
+    }
+}
+/*********************************************************/
+bool SpawnerSet::isFull( int spawner ) const{
+    const RegionBudget &budget = budgets[ spawners[spawner].budget ];
+    return budget.population >= budget.budget;
+}
+/*********************************************************/
+Spawner &SpawnerSet::at( int spawner ){
+    return spawners[spawner];
+}
+/*********************************************************/
+const Spawner &SpawnerSet::at( int spawner ) const{
+    return spawners[spawner];
+}
+/*********************************************************/
+int SpawnerSet::getCount() const{
+    return spawners.size();
+}
+/*********************************************************/
+const vector<pair<int, int> > &SpawnerSet::getBudgets() const{
+    return places;
+}
+/*********************************************************/
+int SpawnerSet::getRemaining() const{
+    int remaining = 0;
+    for ( int i = 0; i < (int)spawners.size(); ++i ){
+        remaining += spawners[i].total - spawners[i].spawned;
+    }
+    return remaining;
+}
+/*********************************************************/
+size_t SpawnerSet::getMemory() const{
+    size_t memory = spawners.capacity() * sizeof(Spawner) + places.capacity() * sizeof(pair<int, int>) +
+                    budgets.capacity() * sizeof(RegionBudget) + numbers.size() * 2 * sizeof(int) +
+                    numbers.bucket_count() * sizeof(void *);
+    for ( int i = 0; i < (int)spawners.size(); ++i ){
+        memory += spawners[i].pool.capacity() * sizeof(Handle);
+    }
+    return memory;
+}
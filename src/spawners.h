@@ -0,0 +1,121 @@
+/** @file spawners.h
+ * Header file of SpawnerSet class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef SPAWNERS_H
+#define SPAWNERS_H
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "world.h"
+using namespace std;
+#define C_SPAWN_BUDGET  8       // max count of living enemies in region of spawner if map doesn't say
+class RegionMap;
+class RegionLinks;
+/**
+ * @brief The Spawner struct is place where enemies appear during game
+ */
+struct Spawner{
+    int place;                  // index of place, enemy appears on it or on its free neighbour
+    Stats stats;                // of every enemy
+    int loot;                   // id of loot table, -1 if enemies drop nothing
+    int every;                  // count of steps between enemies, 0 means only when hero comes near
+    int near;                   // distance of hero, 0 means that hero can be anywhere
+    int total;                  // count of enemies spawner makes during game
+    int spawned;                // count of enemies spawner already made
+    int budget;                 // number of RegionBudget of its region
+    vector<Handle> pool;        // killed enemies of spawner, they come back instead of new entities
+};
+/**
+ * @brief The RegionBudget struct is population of region with spawners
+ */
+struct RegionBudget{
+    int budget;                 // max count of living enemies
+    int population;             // count of living enemies
+};
+/**********************************************************************************************/
+/**
+ * @brief The SpawnerSet class keeps spawners of map and populations of their regions
+ * @detailed    Spawners are read from map file:
+ *                  "spawner" [y,x] (health, damage, defence) total T [every N] [near R] [loot NAME]
+ *                  "budget" [y,x] N
+ *              budget (> 0) is max count of living enemies in region (RegionMap) with place [y,x].
+ *              Only regions with spawners are counted, every of them has its RegionBudget and
+ *              hash table finds it by region, so kill or spawn anywhere costs one lookup.
+ *              Killed enemies of spawner wait in its pool and spawner gives them new place instead
+ *              of creating entities, so long game doesn't fill World by dead enemies.
+ */
+class SpawnerSet{
+    public:
+        /**
+         * @brief add adds spawner
+         * @param spawner is spawner
+         */
+        void add( const Spawner &spawner );
+        /**
+         * @brief addBudget sets budget of region with place
+         * @param place is index of place
+         * @param budget is max count of living enemies
+         */
+        void addBudget( int place, int budget );
+        /**
+         * @brief relabel finds regions of spawners and counts living enemies in them again
+         * @detailed    it has to be called whenever RegionMap of map is made or barrier is opened
+         * @param regions are regions of map
+         * @param links are barriers opened over regions
+         * @param world are entities of map
+         */
+        void relabel( const RegionMap &regions, const RegionLinks &links, World &world );
+        /**
+         * @brief changePopulation adds living enemies to region, regions without spawners are ignored
+         * @param region is region (RegionLinks::getRegion)
+         * @param diff is difference
+         */
+        void changePopulation( int region, int diff );
+        /**
+         * @brief isFull says if region of spawner has all enemies which its budget allows
+         * @param spawner is number of spawner
+         * @return true if spawner has to wait
+         */
+        bool isFull( int spawner ) const;
+        /**
+         * @brief at is getter of spawner
+         * @param spawner is number of spawner
+         * @return spawner
+         */
+        Spawner &at( int spawner );
+        /**
+         * @brief at is getter of spawner
+         * @param spawner is number of spawner
+         * @return spawner
+         */
+        const Spawner &at( int spawner ) const;
+        /**
+         * @brief getCount is getter of count of spawners
+         * @return count
+         */
+        int getCount() const;
+        /**
+         * @brief getBudgets is getter of budgets from map file
+         * @return pairs (place, budget)
+         */
+        const vector<pair<int, int> > &getBudgets() const;
+        /**
+         * @brief getRemaining counts enemies which spawners still have to make
+         * @return count
+         */
+        int getRemaining() const;
+        /**
+         * @brief getMemory is getter of memory used by spawners
+         * @return size in bytes
+         */
+        size_t getMemory() const;
+    private:
+        vector<Spawner> spawners;
+        vector<pair<int, int> > places;         // (place, budget) from map file
+        vector<RegionBudget> budgets;           // of regions with spawners
+        unordered_map<int, int> numbers;        // number of RegionBudget of every region with spawners
+};
+/**********************************************************************************************/
+#endif // SPAWNERS_H
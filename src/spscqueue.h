@@ -0,0 +1,86 @@
+/** @file spscqueue.h
+ * Header file and implementation of SpscQueue class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+#include <atomic>
+#include <vector>
+#include <cstddef>
+using namespace std;
+#define C_CACHE_LINE 64                     // size of cache line, indexes of threads don't share it
+/**********************************************************************************************/
+/**
+ * @brief The SpscQueue class
+ * @detailed    Bounded queue for one producer thread and one consumer thread without locks.
+ *              Producer writes only tail, consumer writes only head, each of them keeps a copy
+ *              of the other index and reloads it only when queue seems full or empty.
+ *              Capacity is rounded up to power of two.
+ */
+template <typename T>
+class SpscQueue{
+    public:
+        /**
+         * @brief SpscQueue is constructor with parameters
+         * @param capacity is max count of items
+         */
+        SpscQueue( size_t capacity ) : head(0), cachedTail(0), tail(0), cachedHead(0){
+            size_t size = 1;
+            while ( size < capacity ){
+                size *= 2;
+            }
+            items.resize( size );
+            mask = size - 1;
+        }
+        /**
+         * @brief push adds item at the end, only producer can call it
+         * @param item is item to add, it is moved into queue
+         * @return false if queue is full, item stays unchanged
+         */
+        bool push( T &item ){
+            size_t t = tail.load( memory_order_relaxed );
+            if ( t - cachedHead > mask ){
+                cachedHead = head.load( memory_order_acquire );
+                if ( t - cachedHead > mask ){
+                    return false;
+                }
+            }
+            items[ t & mask ] = move( item );
+            tail.store( t + 1, memory_order_release );
+            return true;
+        }
+        /**
+         * @brief pop takes the first item, only consumer can call it
+         * @param item is output, the first item
+         * @return false if queue is empty
+         */
+        bool pop( T &item ){
+            size_t h = head.load( memory_order_relaxed );
+            if ( h == cachedTail ){
+                cachedTail = tail.load( memory_order_acquire );
+                if ( h == cachedTail ){
+                    return false;
+                }
+            }
+            item = move( items[ h & mask ] );
+            items[ h & mask ] = T();
+            head.store( h + 1, memory_order_release );
+            return true;
+        }
+    private:
+        // padding instead of alignas, new of C++11 doesn't keep bigger alignment
+        vector<T> items;
+        size_t mask;
+        char padding1[C_CACHE_LINE];
+        atomic<size_t> head;                    // written by consumer
+        size_t cachedTail;                      // consumer's copy of tail
+        char padding2[C_CACHE_LINE];
+        atomic<size_t> tail;                    // written by producer
+        size_t cachedHead;                      // producer's copy of head
+        char padding3[C_CACHE_LINE];
+        SpscQueue( const SpscQueue & );
+        SpscQueue &operator=( const SpscQueue & );
+};
+/**********************************************************************************************/
+#endif // SPSCQUEUE_H
@@ -0,0 +1,158 @@
+/** @file timingwheel.h
+ * Header file and implementation of TimingWheel class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+#define C_WHEEL_BITS        6                       // one level has 64 slots
+#define C_WHEEL_LEVELS      4                       // levels cover 2^24 ticks, farther timers wait in the last one
+#define C_WHEEL_NONE        0xffffffffu             // end of list of slot
+/**********************************************************************************************/
+/**
+ * @brief The TimingWheel class is hierarchical timing wheel of events
+ * @detailed    Level 0 has slot for every one of next 64 ticks, level 1 for every 64 ticks of next
+ *              4096 and so on. Timer is put into one slot in O(1), when lower level goes around,
+ *              one slot of higher level is moved (cascaded) down. Every timer is moved at most
+ *              C_WHEEL_LEVELS-1 times, so cost of tick doesn't depend on count of timers.
+ *              Timers are nodes of one vector with list of free nodes, after warm up nothing is
+ *              allocated. Time is counted in ticks, length of tick is up to owner.
+ */
+template <class T>
+class TimingWheel{
+    public:
+        /**
+         * @brief TimingWheel is implicit constructor, wheel begins at tick 0
+         */
+        TimingWheel() : now(0), countTimers(0), freeNodes(C_WHEEL_NONE){
+            slots.assign( C_WHEEL_LEVELS << C_WHEEL_BITS, C_WHEEL_NONE );
+        }
+        /**
+         * @brief schedule puts event into wheel
+         * @param delay is count of ticks from now, at least 1
+         * @param value is event
+         */
+        void schedule( long long delay, const T &value ){
+            uint32_t node = freeNodes;
+            if ( node == C_WHEEL_NONE ){
+                node = nodes.size();
+                nodes.push_back( Node () );
+            } else {
+                freeNodes = nodes[node].next;
+            }
+            nodes[node].value = value;
+            nodes[node].expiry = now + ( delay < 1 ? 1 : delay );
+            place( node );
+            countTimers++;
+        }
+        /**
+         * @brief advance moves time forward, events of all passed ticks are expired
+         * @param to is new time (tick), earlier time is ignored
+         * @param expired is output, events in order of ticks
+         */
+        void advance( long long to, vector<T> &expired ){
+            while ( now < to ){
+                if ( countTimers == 0 ){
+                    now = to;                           // empty wheel hasn't anything to move
+                    return;
+                }
+                now++;
+                for ( int level = 1; level < C_WHEEL_LEVELS; ++level ){
+                    if ( ( now & ( ( 1LL << ( C_WHEEL_BITS * level ) ) - 1 ) ) != 0 ){
+                        break;
+                    }
+                    cascade( level );
+                }
+                uint32_t &head = slot( 0, now );
+                uint32_t node = head;
+                head = C_WHEEL_NONE;
+                while ( node != C_WHEEL_NONE ){
+                    uint32_t next = nodes[node].next;
+                    expired.push_back( nodes[node].value );
+                    nodes[node].next = freeNodes;
+                    freeNodes = node;
+                    countTimers--;
+                    node = next;
+                }
+            }
+        }
+        /**
+         * @brief getNow is getter of current tick
+         * @return tick
+         */
+        long long getNow() const{
+            return now;
+        }
+        /**
+         * @brief getCount is getter of count of waiting timers
+         * @return count
+         */
+        int getCount() const{
+            return countTimers;
+        }
+        /**
+         * @brief getMemory is getter of memory used by wheel
+         * @return size in bytes
+         */
+        size_t getMemory() const{
+            return nodes.capacity() * sizeof(Node) + slots.capacity() * sizeof(uint32_t);
+        }
+    private:
+        /**
+         * @brief The Node struct is one timer
+         */
+        struct Node{
+            T value;
+            long long expiry;
+            uint32_t next;                      // next node in slot or in list of free nodes
+        };
+        long long now;
+        int countTimers;
+        vector<Node> nodes;
+        vector<uint32_t> slots;                 // heads of lists, C_WHEEL_LEVELS times 64
+        uint32_t freeNodes;
+        /**
+         * @brief slot is getter of head of list of slot, where tick belongs on level
+         * @param level is level of wheel
+         * @param tick is tick
+         * @return head of list
+         */
+        uint32_t &slot( int level, long long tick ){
+            int index = ( tick >> ( C_WHEEL_BITS * level ) ) & ( ( 1 << C_WHEEL_BITS ) - 1 );
+            return slots[ ( level << C_WHEEL_BITS ) + index ];
+        }
+        /**
+         * @brief place links node into slot by its distance from now
+         * @param node is index of node
+         */
+        void place( uint32_t node ){
+            long long distance = nodes[node].expiry - now;
+            int level = 0;
+            while ( level < C_WHEEL_LEVELS - 1 && distance >= ( 1LL << ( C_WHEEL_BITS * ( level + 1 ) ) ) ){
+                level++;
+            }
+            uint32_t &head = slot( level, nodes[node].expiry );
+            nodes[node].next = head;
+            head = node;
+        }
+        /**
+         * @brief cascade moves all nodes of current slot of level into lower levels
+         * @param level is level of wheel, at least 1
+         */
+        void cascade( int level ){
+            uint32_t &head = slot( level, now );
+            uint32_t node = head;
+            head = C_WHEEL_NONE;
+            while ( node != C_WHEEL_NONE ){
+                uint32_t next = nodes[node].next;
+                place( node );
+                node = next;
+            }
+        }
+};
+/**********************************************************************************************/
+#endif // TIMINGWHEEL_H
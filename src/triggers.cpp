@@ -0,0 +1,66 @@
+/** @file triggers.cpp
+ * Implementation of TriggerIndex class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include "triggers.h"
+/**********************************************************************************************/
+/**
+ * @brief isBefore orders triggers by event and key, triggers of the same key keep order of file
+ * @param a is first trigger
+ * @param b is second trigger
+ * @return true if a goes before b
+ */
+static bool isBefore( const Trigger &a, const Trigger &b ){
+    if ( a.event != b.event ){
+        return a.event < b.event;
+    }
+    return a.key < b.key;
+}
+/**********************************************************************************************/
+void TriggerIndex::add( const Trigger &trigger ){
+    triggers.push_back( trigger );
+}
+/*********************************************************/
+int TriggerIndex::addMessage( const string &text ){
+    messages.push_back( text );
+    return messages.size() - 1;
+}
+/*********************************************************/
+void TriggerIndex::build(){
+    table.clear();
+    if ( triggers.empty() ){
+        return;
+    }
+    stable_sort( triggers.begin(), triggers.end(), isBefore );
+    int bits = 1;
+    while ( ( 1ULL << bits ) < 2 * triggers.size() ){
+        bits++;
+    }
+    Slot empty = { 0, 0, 0 };
+    table.assign( 1ULL << bits, empty );
+    mask = ( 1ULL << bits ) - 1;
+    shift = 64 - bits;
+    for ( uint32_t begin = 0, end = 0; begin < triggers.size(); begin = end ){
+        end = begin + 1;
+        while ( end < triggers.size() && triggers[end].event == triggers[begin].event && triggers[end].key == triggers[begin].key ){
+            end++;
+        }
+        uint64_t k = keyOf( triggers[begin].event, triggers[begin].key );
+        uint64_t i = hashOf( k );
+        while ( table[i].key != 0 ){
+            i = ( i + 1 ) & mask;
+        }
+        Slot slot = { k, begin, end };
+        table[i] = slot;
+    }
+}
+/*********************************************************/
+size_t TriggerIndex::getMemory() const{
+    size_t memory = triggers.capacity() * sizeof(Trigger) + table.capacity() * sizeof(Slot);
+    for ( int i = 0; i < (int)messages.size(); ++i ){
+        memory += sizeof(string) + messages[i].capacity();
+    }
+    return memory;
+}
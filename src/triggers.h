@@ -0,0 +1,160 @@
+/** @file triggers.h
+ * Header file of TriggerIndex class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef TRIGGERS_H
+#define TRIGGERS_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+/**
+ * @brief The possible events which fire triggers
+ */
+enum TriggerEvent{
+    TRIGGER_ENTER,          //<Hero entered place key
+    TRIGGER_KILL,           //<Enemy on place key was killed
+    TRIGGER_PICKUP,         //<Hero picked up item on place key
+    TRIGGER_LEFT            //<Count of enemies to kill went down to key
+};
+/**
+ * @brief The possible actions of triggers
+ */
+enum TriggerAction{
+    ACTION_MESSAGE,         //<Message number target is shown
+    ACTION_SPAWN,           //<Enemy with values (health, damage, defence) appears on place target
+    ACTION_OPEN,            //<Barrier on place target disappears
+    ACTION_STAT,            //<Skill of hero target (DeltaType) changes by values[0]
+    ACTION_DIALOG           //<Dialog of NPC with name in message number target begins
+};
+/**
+ * @brief The Trigger struct is one trigger, it fires only once
+ */
+struct Trigger{
+    int32_t event;          // TriggerEvent
+    int32_t key;            // index of place or count of enemies
+    int32_t action;         // TriggerAction
+    int32_t target;
+    int32_t values[3];
+};
+/**********************************************************************************************/
+/**
+ * @brief The TriggerIndex class keeps all triggers of map and finds them by event and key
+ * @detailed    Triggers are added while map is loaded, build sorts them by event and key, so
+ *              triggers of one key lie next to each other, and makes hash table with linear
+ *              probing from (event, key) to their range. Check on every step is one or two
+ *              looks into table, it doesn't depend on count of triggers. Index doesn't change
+ *              after build, it is shared by all copies of map, they only mark fired triggers.
+ */
+class TriggerIndex{
+    public:
+        /**
+         * @brief add adds trigger, before build
+         * @param trigger is trigger
+         */
+        void add( const Trigger &trigger );
+        /**
+         * @brief addMessage adds text for ACTION_MESSAGE or name of NPC for ACTION_DIALOG
+         * @param text is text of message
+         * @return number of message
+         */
+        int addMessage( const string &text );
+        /**
+         * @brief build sorts triggers and makes hash table, ids of triggers are fixed after it
+         */
+        void build();
+        /**
+         * @brief find finds triggers of event and key
+         * @param event is event
+         * @param key is index of place or count of enemies
+         * @param begin is output, id of the first trigger
+         * @param end is output, id after the last trigger
+         * @return false if there isn't any trigger
+         */
+        bool find( TriggerEvent event, int key, int &begin, int &end ) const{
+            if ( table.empty() ){
+                return false;
+            }
+            uint64_t k = keyOf( event, key );
+            for ( uint64_t i = hashOf( k ); ; i = ( i + 1 ) & mask ){
+                if ( table[i].key == k ){
+                    begin = table[i].begin;
+                    end = table[i].end;
+                    return true;
+                }
+                if ( table[i].key == 0 ){
+                    return false;
+                }
+            }
+        }
+        /**
+         * @brief getTrigger is getter of trigger
+         * @param id is id of trigger
+         * @return trigger
+         */
+        const Trigger &getTrigger( int id ) const{
+            return triggers[id];
+        }
+        /**
+         * @brief getMessage is getter of text of message
+         * @param number is number of message
+         * @return text
+         */
+        const string &getMessage( int number ) const{
+            return messages[number];
+        }
+        /**
+         * @brief getCount is getter of count of triggers
+         * @return count
+         */
+        int getCount() const{
+            return triggers.size();
+        }
+        /**
+         * @brief getCountMessages is getter of count of messages
+         * @return count
+         */
+        int getCountMessages() const{
+            return messages.size();
+        }
+        /**
+         * @brief getMemory is getter of memory used by index
+         * @return size in bytes
+         */
+        size_t getMemory() const;
+    private:
+        /**
+         * @brief The Slot struct is place of hash table, key 0 is free slot
+         */
+        struct Slot{
+            uint64_t key;
+            uint32_t begin;
+            uint32_t end;
+        };
+        vector<Trigger> triggers;
+        vector<string> messages;
+        vector<Slot> table;                     // size is power of two, at most half full
+        uint64_t mask;
+        int shift;
+        /**
+         * @brief keyOf packs event and key of trigger, result isn't 0
+         * @param event is event
+         * @param key is key
+         * @return packed key
+         */
+        static uint64_t keyOf( int event, int key ){
+            return ( (uint64_t)(uint32_t)key << 2 | (uint64_t)event ) + 1;
+        }
+        /**
+         * @brief hashOf is slot where search for packed key begins (Fibonacci hashing)
+         * @param k is packed key
+         * @return index of slot
+         */
+        uint64_t hashOf( uint64_t k ) const{
+            return ( k * 0x9E3779B97F4A7C15ULL ) >> shift;
+        }
+};
+/**********************************************************************************************/
+#endif // TRIGGERS_H
@@ -0,0 +1,107 @@
+/** @file watcher.cpp
+ * Implementation of Watcher class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "watcher.h"
+/**********************************************************************************************/
+Watcher::Watcher( const string &address, long long session ) : fd(-1), canvas( C_SERVER_ROWS, C_SERVER_COLS ),
+                                                               shown( C_SERVER_ROWS, C_SERVER_COLS ), countBytes(0){
+    int result = -1;
+    if ( address.compare( 0, 4, "tcp:" ) == 0 ){
+        fd = socket( AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+        struct sockaddr_in addr;
+        memset( &addr, 0, sizeof(addr) );
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons( atoi( address.c_str() + 4 ) );
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        result = connect( fd, (struct sockaddr *)&addr, sizeof(addr) );
+    } else {
+        fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+        struct sockaddr_un addr;
+        memset( &addr, 0, sizeof(addr) );
+        addr.sun_family = AF_UNIX;
+        strncpy( addr.sun_path, address.c_str(), sizeof(addr.sun_path) - 1 );
+        result = connect( fd, (struct sockaddr *)&addr, sizeof(addr) );
+    }
+    string request = ( session > 0 ? to_string( session ) : string () ) + "\n";
+    if ( fd < 0 || result != 0 || send( fd, request.data(), request.size(), MSG_NOSIGNAL ) != (ssize_t)request.size() ){
+        string reason = strerror(errno);
+        if ( fd >= 0 ){
+            close( fd );
+        }
+        throw Exception ( "Can't watch game on " + address + ": " + reason + "\n" );
+    }
+}
+/*********************************************************/
+Watcher::~Watcher(){
+    close( fd );
+}
+/*********************************************************/
+void Watcher::run(){
+    string stream;
+    char buffer[C_FEED_BACKLOG / 4];
+    bool started = false;
+    while ( true ){
+        ssize_t length = recv( fd, buffer, sizeof(buffer), 0 );
+        if ( length < 0 && errno == EINTR ){
+            continue;
+        }
+        if ( length <= 0 ){
+            break;
+        }
+        countBytes += length;
+        stream.append( buffer, length );
+        size_t at = 0;
+        FrameHeader header;
+        bool changed = false;
+        while ( Feed::readHeader( stream.data() + at, stream.size() - at, header ) ){
+            header = Feed::apply( stream.data() + at, canvas );
+            at += header.size;
+            changed = true;
+        }
+        stream.erase( 0, at );
+        if ( changed ){
+            if ( !started ){
+                fputs( "\x1b[2J\x1b[?25l", stdout );
+                started = true;
+            }
+            show( header );
+        }
+    }
+    if ( !started ){
+        throw Exception ( "Game isn't on server or it has ended.\n" );
+    }
+    fputs( "\x1b[0m\x1b[?25h\r\n", stdout );
+    fflush( stdout );
+}
+/*********************************************************/
+void Watcher::show( const FrameHeader &header ){
+    string out;
+    for ( int y = 0; y < canvas.getHeight(); ++y ){
+        if ( !canvas.isRowEqual( shown, y ) ){
+            canvas.appendRowAnsi( y, out );
+        }
+    }
+    shown = canvas;
+    char status[256];
+    if ( header.page == MAP ){
+        snprintf( status, sizeof(status), "\x1b[%d;1H\x1b[0;7m Frame %u  camera %d,%d  health %d  enemies %d  received %lld KB \x1b[0m\x1b[K",
+                  canvas.getHeight() + 1, header.number, header.cameraX, header.cameraY, header.stats[0], header.stats[5], countBytes / 1024 );
+    } else {
+        snprintf( status, sizeof(status), "\x1b[%d;1H\x1b[0;7m Frame %u  received %lld KB \x1b[0m\x1b[K",
+                  canvas.getHeight() + 1, header.number, countBytes / 1024 );
+    }
+    out += status;
+    fwrite( out.data(), 1, out.size(), stdout );
+    fflush( stdout );
+}
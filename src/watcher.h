@@ -0,0 +1,51 @@
+/** @file watcher.h
+ * Header file of Watcher class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef WATCHER_H
+#define WATCHER_H
+#include <string>
+#include "feed.h"
+#include "canvas.h"
+#include "session.h"
+using namespace std;
+/**********************************************************************************************/
+/**
+ * @brief The Watcher class
+ * @detailed    Spectator of game on server. It doesn't run any game, it only decodes frames
+ *              of spectator feed and draws them on terminal by ANSI escape sequences.
+ */
+class Watcher{
+    public:
+        /**
+         * @brief Watcher is constructor with parameters, it connects to server
+         * @param address is spectator socket of server (SOCKET.watch or "tcp:PORT")
+         * @param session is number of session, 0 for the newest one
+         * @throw exception if server isn't available
+         */
+        Watcher( const string &address, long long session );
+        /**
+         * @brief ~Watcher is destruktor, it closes socket
+         */
+        ~Watcher();
+        /**
+         * @brief run shows game until it ends
+         * @throw exception if stream is damaged
+         */
+        void run();
+    private:
+        int fd;
+        TextCanvas canvas;                      // screen of game
+        TextCanvas shown;                       // what is on terminal
+        long long countBytes;
+        /**
+         * @brief show draws changed rows and status line
+         * @param header is header of the last frame
+         */
+        void show( const FrameHeader &header );
+        Watcher( const Watcher & );
+        Watcher &operator=( const Watcher & );
+};
+/**********************************************************************************************/
+#endif // WATCHER_H
@@ -0,0 +1,335 @@
+/** @file world.cpp
+ * Implementation of StatsComponents class, World class, CombatSystem class and CombatBatch class
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+ */
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "world.h"
+/**********************************************************************************************/
+bool StatsComponents::get( uint32_t entity, Stats &stats ) const{
+    int i = find( entity );
+    if ( i < 0 ){
+        return false;
+    }
+    stats.health = health[i];
+    stats.damage = damage[i];
+    stats.defence = defence[i];
+    return true;
+}
+/*********************************************************/
+void StatsComponents::add( uint32_t entity, const Stats &stats ){
+    int i = find( entity );
+    if ( i < 0 ){
+        i = insert( entity );
+        health.push_back( 0 );
+        damage.push_back( 0 );
+        defence.push_back( 0 );
+    }
+    health[i] = stats.health;
+    damage[i] = stats.damage;
+    defence[i] = stats.defence;
+}
+/*********************************************************/
+bool StatsComponents::remove( uint32_t entity ){
+    int hole = erase( entity );
+    if ( hole < 0 ){
+        return false;
+    }
+    health[hole] = health.back();
+    damage[hole] = damage.back();
+    defence[hole] = defence.back();
+    health.pop_back();
+    damage.pop_back();
+    defence.pop_back();
+    return true;
+}
+/*********************************************************/
+int *StatsComponents::getHealth(){
+    return health.data();
+}
+/*********************************************************/
+int *StatsComponents::getDamage(){
+    return damage.data();
+}
+/*********************************************************/
+int *StatsComponents::getDefence(){
+    return defence.data();
+}
+/*********************************************************/
+size_t StatsComponents::getMemory() const{
+    return ( health.capacity() + damage.capacity() + defence.capacity() ) * sizeof(int) + getIndexMemory();
+}
+/**********************************************************************************************/
+Handle World::create( Archetype archetype ){
+    return entities.create( archetype );
+}
+/*********************************************************/
+Handle World::createEnemy( int index, const Stats &stats, int loot, int spawner ){
+    Handle entity = create( ARCHETYPE_ENEMY );
+    Position position = { index };
+    Glyph glyph = { 'e' };
+    positions.add( entity.index, position );
+    this->stats.add( entity.index, stats );
+    glyphs.add( entity.index, glyph );
+    if ( loot >= 0 ){
+        Loot component = { loot };
+        loots.add( entity.index, component );
+    }
+    if ( spawner >= 0 ){
+        Origin origin = { spawner };
+        origins.add( entity.index, origin );
+    }
+    return entity;
+}
+/*********************************************************/
+bool World::revive( Handle entity, int index ){
+    if ( !isAlive( entity ) || positions.get( entity.index ) != NULL ){
+        return false;
+    }
+    Position position = { index };
+    positions.add( entity.index, position );
+    return true;
+}
+/*********************************************************/
+bool World::destroy( Handle entity ){
+    if ( !entities.destroy( entity ) ){
+        return false;
+    }
+    positions.remove( entity.index );
+    stats.remove( entity.index );
+    glyphs.remove( entity.index );
+    loots.remove( entity.index );
+    origins.remove( entity.index );
+    return true;
+}
+/*********************************************************/
+bool World::isAlive( Handle entity ) const{
+    return entities.isValid( entity );
+}
+/*********************************************************/
+Handle World::getHandle( uint32_t index ) const{
+    return entities.getHandle( index );
+}
+/*********************************************************/
+Archetype World::getArchetype( Handle entity ) const{
+    return *entities.get( entity );
+}
+/*********************************************************/
+int World::getCount() const{
+    return entities.getCount();
+}
+/*********************************************************/
+Position *World::getPosition( Handle entity ){
+    return isAlive( entity ) ? positions.get( entity.index ) : NULL;
+}
+/*********************************************************/
+bool World::getStats( Handle entity, Stats &stats ) const{
+    return isAlive( entity ) && this->stats.get( entity.index, stats );
+}
+/*********************************************************/
+const Glyph *World::getGlyph( Handle entity ) const{
+    return isAlive( entity ) ? glyphs.get( entity.index ) : NULL;
+}
+/*********************************************************/
+const Loot *World::getLoot( Handle entity ) const{
+    return isAlive( entity ) ? loots.get( entity.index ) : NULL;
+}
+/*********************************************************/
+const Origin *World::getOrigin( Handle entity ) const{
+    return isAlive( entity ) ? origins.get( entity.index ) : NULL;
+}
+/*********************************************************/
+Components<Position> &World::getPositions(){
+    return positions;
+}
+/*********************************************************/
+StatsComponents &World::getStats(){
+    return stats;
+}
+/*********************************************************/
+Components<Glyph> &World::getGlyphs(){
+    return glyphs;
+}
+/*********************************************************/
+size_t World::getMemory() const{
+    return entities.getMemory() + positions.getMemory() + stats.getMemory() + glyphs.getMemory() + loots.getMemory() + origins.getMemory();
+}
+/**********************************************************************************************/
+CombatResult CombatSystem::fight( const Stats &hero, const Stats &enemy, Random &random ){
+    CombatResult result = { hero.health, enemy.health, 0 };
+    while ( result.heroHealth > 0 && result.enemyHealth > 0 ){    //damage +  random - defence
+        result.rounds++;
+        result.heroHealth -= enemyHit( hero, enemy, random );
+        int heroFight = hero.damage + random.next(hero.damage) - enemy.defence;
+        if ( heroFight < 0 ){
+            heroFight = MIN_DAMAGE - 10;
+        }
+        result.enemyHealth -= heroFight;
+    }
+    return result;
+}
+/*********************************************************/
+int CombatSystem::enemyHit( const Stats &hero, const Stats &enemy, Random &random ){
+    int enemyFight = enemy.damage + 2*random.next(enemy.damage) - hero.defence;
+    if ( enemyFight < 0 ){
+        enemyFight = MIN_DAMAGE;
+    }
+    return enemyFight;
+}
+/**********************************************************************************************/
+CombatBatch::CombatBatch() : count(0){}
+/*********************************************************/
+int CombatBatch::add( const Stats &hero, const Stats &enemy ){
+    if ( count == (int)rounds.size() ){
+        int size = count + C_COMBAT_LANES;      // empty places have no health, they never fight
+        heroHealth.resize( size, 0 );
+        heroDamage.resize( size, 0 );
+        heroDefence.resize( size, 0 );
+        enemyHealth.resize( size, 0 );
+        enemyDamage.resize( size, 0 );
+        enemyDefence.resize( size, 0 );
+        heroRoll.resize( size, 0 );
+        enemyRoll.resize( size, 0 );
+        rounds.resize( size, 0 );
+        blockRunning.push_back( 0 );
+    }
+    blockRunning[ count / C_COMBAT_LANES ] = C_COMBAT_LANES;     // only "maybe running", tick counts it
+    heroHealth[count] = hero.health;
+    heroDamage[count] = hero.damage;
+    heroDefence[count] = hero.defence;
+    enemyHealth[count] = enemy.health;
+    enemyDamage[count] = enemy.damage;
+    enemyDefence[count] = enemy.defence;
+    rounds[count] = 0;
+    return count++;
+}
+/*********************************************************/
+void CombatBatch::roll( Random &random ){
+    for ( int i = 0; i < count; ++i ){
+        if ( i % C_COMBAT_LANES == 0 && blockRunning[ i / C_COMBAT_LANES ] == 0 ){
+            i += C_COMBAT_LANES - 1;
+            continue;
+        }
+        if ( heroHealth[i] > 0 && enemyHealth[i] > 0 ){     // the same order as CombatSystem::fight
+            enemyRoll[i] = random.next( enemyDamage[i] );
+            heroRoll[i] = random.next( heroDamage[i] );
+        }
+    }
+}
+/*********************************************************/
+// one round of block of C_COMBAT_LANES fights, restrict parameters let compiler vectorize it
+static int tickLanes( int * __restrict heroHealth, int * __restrict enemyHealth, int * __restrict rounds,
+                      const int * __restrict heroDamage, const int * __restrict heroDefence,
+                      const int * __restrict enemyDamage, const int * __restrict enemyDefence,
+                      const int * __restrict heroRoll, const int * __restrict enemyRoll ){
+    int running = 0;
+    for ( int l = 0; l < C_COMBAT_LANES; ++l ){
+        int live = -( ( heroHealth[l] > 0 ) & ( enemyHealth[l] > 0 ) );    // all bits set for running fight
+        int enemyFight = enemyDamage[l] + 2*enemyRoll[l] - heroDefence[l];
+        enemyFight = enemyFight < 0 ? MIN_DAMAGE : enemyFight;
+        int heroFight = heroDamage[l] + heroRoll[l] - enemyDefence[l];
+        heroFight = heroFight < 0 ? MIN_DAMAGE - 10 : heroFight;
+        heroHealth[l] -= enemyFight & live;
+        enemyHealth[l] -= heroFight & live;
+        rounds[l] -= live;
+        running += ( heroHealth[l] > 0 ) & ( enemyHealth[l] > 0 );
+    }
+    return running;
+}
+/*********************************************************/
+int CombatBatch::tick(){
+    int running = 0;
+    for ( int block = 0; block < (int)rounds.size(); block += C_COMBAT_LANES ){
+        if ( blockRunning[ block / C_COMBAT_LANES ] == 0 ){
+            continue;
+        }
+        blockRunning[ block / C_COMBAT_LANES ] = tickLanes( &heroHealth[block], &enemyHealth[block], &rounds[block], &heroDamage[block],
+                              &heroDefence[block], &enemyDamage[block], &enemyDefence[block],
+                              &heroRoll[block], &enemyRoll[block] );
+        running += blockRunning[ block / C_COMBAT_LANES ];
+    }
+    return running;
+}
+/*********************************************************/
+int CombatBatch::tickScalar(){
+    int running = 0;
+    for ( int i = 0; i < count; ++i ){
+        if ( heroHealth[i] <= 0 || enemyHealth[i] <= 0 ){
+            continue;
+        }
+        rounds[i]++;
+        int enemyFight = enemyDamage[i] + 2*enemyRoll[i] - heroDefence[i];
+        if ( enemyFight < 0 ){
+            enemyFight = MIN_DAMAGE;
+        }
+        heroHealth[i] -= enemyFight;
+        int heroFight = heroDamage[i] + heroRoll[i] - enemyDefence[i];
+        if ( heroFight < 0 ){
+            heroFight = MIN_DAMAGE - 10;
+        }
+        enemyHealth[i] -= heroFight;
+        if ( heroHealth[i] > 0 && enemyHealth[i] > 0 ){
+            running++;
+        }
+    }
+    return running;
+}
+/*********************************************************/
+int CombatBatch::getCount() const{
+    return count;
+}
+/*********************************************************/
+CombatResult CombatBatch::getResult( int i ) const{
+    CombatResult result = { heroHealth[i], enemyHealth[i], rounds[i] };
+    return result;
+}
+/*********************************************************/
+void CombatBatch::clear(){
+    count = 0;
+    fill( heroHealth.begin(), heroHealth.end(), 0 );
+    fill( enemyHealth.begin(), enemyHealth.end(), 0 );
+    fill( blockRunning.begin(), blockRunning.end(), 0 );
+}
+/*********************************************************/
+bool CombatBatch::benchmark( int countFights, int seed ){
+    typedef chrono::steady_clock Clock;
+    Random random ( seed );
+    CombatBatch vectorized, scalar;
+    for ( int i = 0; i < countFights; ++i ){     // stats as in generated maps, hero is stronger
+        Stats hero = { 200 + random.next( 800 ), 10 + random.next( 40 ), 10 + random.next( 40 ) };
+        Stats enemy = { 10 + random.next( 40 ), 10 + random.next( 40 ), 10 + random.next( 40 ) };
+        vectorized.add( hero, enemy );
+        scalar.add( hero, enemy );
+    }
+    Random randomVectorized ( seed ), randomScalar ( seed );
+    long long nanosVectorized = 0, nanosScalar = 0, nanosRoll = 0;
+    int countRounds = 0, runningVectorized = countFights, runningScalar = countFights;
+    while ( runningVectorized > 0 || runningScalar > 0 ){
+        Clock::time_point begin = Clock::now();
+        vectorized.roll( randomVectorized );
+        Clock::time_point rolled = Clock::now();
+        runningVectorized = vectorized.tick();
+        Clock::time_point ticked = Clock::now();
+        scalar.roll( randomScalar );
+        Clock::time_point rolledScalar = Clock::now();
+        runningScalar = scalar.tickScalar();
+        Clock::time_point end = Clock::now();
+        nanosRoll += chrono::duration_cast<chrono::nanoseconds>( rolled - begin ).count();
+        nanosVectorized += chrono::duration_cast<chrono::nanoseconds>( ticked - rolled ).count();
+        nanosScalar += chrono::duration_cast<chrono::nanoseconds>( end - rolledScalar ).count();
+        countRounds++;
+    }
+    bool same = true;
+    for ( int i = 0; i < countFights && same; ++i ){
+        CombatResult a = vectorized.getResult( i ), b = scalar.getResult( i );
+        same = a.heroHealth == b.heroHealth && a.enemyHealth == b.enemyHealth && a.rounds == b.rounds;
+    }
+    cout << "Combat of " << countFights << " fights, " << countRounds << " ticks: " << fixed << setprecision(2)
+         << "scalar " << nanosScalar / 1e6 << " ms, vectorized " << nanosVectorized / 1e6 << " ms, speed-up "
+         << ( nanosVectorized > 0 ? (double)nanosScalar / nanosVectorized : 0.0 ) << "x, rolls "
+         << nanosRoll / 1e6 << " ms, results " << ( same ? "equal" : "DIFFERENT" ) << "." << endl;
+    return same;
+}
@@ -0,0 +1,482 @@
+/** @file world.h
+ * Header file of World class, CombatSystem class and CombatBatch class.
+ * Header and implementation of components, SparseSet class and Components class.
+ *
+ *  @author Julia Ostrokomorets <ostroiul@fit.cvut.cz>
+*/
+#ifndef WORLD_H
+#define WORLD_H
+#include <cstdint>
+#include <vector>
+#include "handlepool.h"
+#include "random.h"
+using namespace std;
+#define C_COMPONENT_NONE    0xffffffffu     // entity doesn't have component
+#define MIN_DAMAGE 20
+#define C_COMBAT_LANES      16              // fights in one block of CombatBatch
+/**
+ * @brief The Position struct is component of entity standing on map
+ */
+struct Position{
+    int index;                                  // index of place
+};
+/**
+ * @brief The Stats struct is component of entity which can fight
+ */
+struct Stats{
+    int health;
+    int damage;
+    int defence;
+};
+/**
+ * @brief The Glyph struct is component of entity which is drawn on map
+ */
+struct Glyph{
+    char symbol;
+};
+/**
+ * @brief The Loot struct is component of entity which drops item when it dies
+ */
+struct Loot{
+    int table;                                  // id of LootTable in ItemRegistry
+};
+/**
+ * @brief The Origin struct is component of entity which was made by spawner
+ */
+struct Origin{
+    int spawner;                                // number of spawner in SpawnerSet of map
+};
+/**
+ * @brief The possible archetypes of entities (which components they get at creation)
+ */
+enum Archetype{
+    ARCHETYPE_ENEMY                             //<Position, Stats, Glyph, Loot if enemy has loot table, Origin if spawner made it
+};
+/**********************************************************************************************/
+/**
+ * @brief The SparseSet class is index of one type of component of all entities
+ * @detailed    Components lie densely without holes, so systems go through them linearly,
+ *              sparse vector finds place of component of entity by its index. Removed component
+ *              is replaced by the last one, order isn't kept. Descendants keep components
+ *              at places given by insert and erase.
+ */
+class SparseSet{
+    public:
+        /**
+         * @brief find finds place of component of entity
+         * @param entity is index of entity (Handle::index)
+         * @return place in dense vectors, -1 if entity doesn't have component
+         */
+        int find( uint32_t entity ) const{
+            return entity < sparse.size() && sparse[entity] != C_COMPONENT_NONE ? (int)sparse[entity] : -1;
+        }
+        /**
+         * @brief getCount is getter of count of components
+         * @return count
+         */
+        int getCount() const{
+            return owners.size();
+        }
+        /**
+         * @brief getOwner is getter of entity of component
+         * @param i is place from 0 to getCount()-1
+         * @return index of entity (Handle::index)
+         */
+        uint32_t getOwner( int i ) const{
+            return owners[i];
+        }
+    protected:
+        /**
+         * @brief insert gives place at the end to entity which doesn't have component
+         * @param entity is index of entity (Handle::index)
+         * @return new place
+         */
+        int insert( uint32_t entity ){
+            if ( entity >= sparse.size() ){
+                sparse.resize( entity + 1, C_COMPONENT_NONE );
+            }
+            sparse[entity] = owners.size();
+            owners.push_back( entity );
+            return sparse[entity];
+        }
+        /**
+         * @brief erase takes place from entity, the last component has to be moved into it
+         * @param entity is index of entity (Handle::index)
+         * @return freed place, -1 if entity didn't have component
+         */
+        int erase( uint32_t entity ){
+            int hole = find( entity );
+            if ( hole < 0 ){
+                return -1;
+            }
+            owners[hole] = owners.back();
+            sparse[ owners[hole] ] = hole;
+            owners.pop_back();
+            sparse[entity] = C_COMPONENT_NONE;
+            return hole;
+        }
+        /**
+         * @brief getIndexMemory is getter of memory used by index
+         * @return size in bytes
+         */
+        size_t getIndexMemory() const{
+            return ( owners.capacity() + sparse.capacity() ) * sizeof(uint32_t);
+        }
+    private:
+        vector<uint32_t> owners;                // entity of each place
+        vector<uint32_t> sparse;                // place of each entity
+};
+/**********************************************************************************************/
+/**
+ * @brief The Components class is one type of component of all entities, stored as structures
+ */
+template <class T>
+class Components : public SparseSet{
+    public:
+        /**
+         * @brief get finds component of entity
+         * @param entity is index of entity (Handle::index)
+         * @return component, NULL if entity doesn't have it
+         */
+        T *get( uint32_t entity ){
+            int i = find( entity );
+            return i < 0 ? NULL : &dense[i];
+        }
+        /**
+         * @brief get finds component of entity
+         * @param entity is index of entity (Handle::index)
+         * @return component, NULL if entity doesn't have it
+         */
+        const T *get( uint32_t entity ) const{
+            int i = find( entity );
+            return i < 0 ? NULL : &dense[i];
+        }
+        /**
+         * @brief add gives component to entity, component which entity already has is replaced
+         * @param entity is index of entity (Handle::index)
+         * @param value is component
+         */
+        void add( uint32_t entity, const T &value ){
+            int i = find( entity );
+            if ( i >= 0 ){
+                dense[i] = value;
+                return;
+            }
+            insert( entity );
+            dense.push_back( value );
+        }
+        /**
+         * @brief remove takes component from entity
+         * @param entity is index of entity (Handle::index)
+         * @return false if entity didn't have component
+         */
+        bool remove( uint32_t entity ){
+            int hole = erase( entity );
+            if ( hole < 0 ){
+                return false;
+            }
+            dense[hole] = dense.back();
+            dense.pop_back();
+            return true;
+        }
+        /**
+         * @brief at is getter of component by its place in dense vector (for systems)
+         * @param i is place from 0 to getCount()-1
+         * @return component
+         */
+        T &at( int i ){
+            return dense[i];
+        }
+        /**
+         * @brief at is getter of component by its place in dense vector (for systems)
+         * @param i is place from 0 to getCount()-1
+         * @return component
+         */
+        const T &at( int i ) const{
+            return dense[i];
+        }
+        /**
+         * @brief getMemory is getter of memory used by components
+         * @return size in bytes
+         */
+        size_t getMemory() const{
+            return dense.capacity() * sizeof(T) + getIndexMemory();
+        }
+    private:
+        vector<T> dense;
+};
+/**********************************************************************************************/
+/**
+ * @brief The StatsComponents class is Stats of all entities, stored as arrays
+ * @detailed    Health, damage and defence are three columns, so system which needs only one or
+ *              two of them (combat, area effect) reads nothing else and compiler can vectorize it.
+ */
+class StatsComponents : public SparseSet{
+    public:
+        /**
+         * @brief get finds stats of entity
+         * @param entity is index of entity (Handle::index)
+         * @param stats is output
+         * @return false if entity doesn't have stats
+         */
+        bool get( uint32_t entity, Stats &stats ) const;
+        /**
+         * @brief add gives stats to entity, stats which entity already has are replaced
+         * @param entity is index of entity (Handle::index)
+         * @param stats are health, damage and defence
+         */
+        void add( uint32_t entity, const Stats &stats );
+        /**
+         * @brief remove takes stats from entity
+         * @param entity is index of entity (Handle::index)
+         * @return false if entity didn't have stats
+         */
+        bool remove( uint32_t entity );
+        /**
+         * @brief getHealth is getter of column of health (for systems)
+         * @return health of places 0 to getCount()-1
+         */
+        int *getHealth();
+        /**
+         * @brief getDamage is getter of column of damage (for systems)
+         * @return damage of places 0 to getCount()-1
+         */
+        int *getDamage();
+        /**
+         * @brief getDefence is getter of column of defence (for systems)
+         * @return defence of places 0 to getCount()-1
+         */
+        int *getDefence();
+        /**
+         * @brief getMemory is getter of memory used by stats
+         * @return size in bytes
+         */
+        size_t getMemory() const;
+    private:
+        vector<int> health;
+        vector<int> damage;
+        vector<int> defence;
+};
+/**********************************************************************************************/
+/**
+ * @brief The World class is entity-component store of one map
+ * @detailed    Entity is only Handle, its state is in components, one Components per type.
+ *              Entity without Position isn't on map (killed enemy keeps its stats, so undo can
+ *              return it). Copy of world is deep, every game has its own.
+ */
+class World{
+    public:
+        /**
+         * @brief create makes entity without components
+         * @param archetype is kind of entity
+         * @return handle of entity
+         */
+        Handle create( Archetype archetype );
+        /**
+         * @brief createEnemy makes enemy standing on place
+         * @param index is position on map
+         * @param stats are health, damage and defence of enemy
+         * @param loot is id of loot table, -1 if enemy drops nothing
+         * @param spawner is number of spawner which made enemy, -1 for enemy of map file
+         * @return handle of enemy
+         */
+        Handle createEnemy( int index, const Stats &stats, int loot = -1, int spawner = -1 );
+        /**
+         * @brief revive puts killed entity (without Position) on place again, it keeps other components
+         * @param entity is handle of entity
+         * @param index is position on map
+         * @return false for stale handle or entity which is on map
+         */
+        bool revive( Handle entity, int index );
+        /**
+         * @brief destroy takes all components of entity away, its handles become stale
+         * @param entity is handle of entity
+         * @return false if handle was already stale
+         */
+        bool destroy( Handle entity );
+        /**
+         * @brief isAlive says if handle points at existing entity
+         * @param entity is handle of entity
+         * @return false for empty or stale handle
+         */
+        bool isAlive( Handle entity ) const;
+        /**
+         * @brief getHandle is getter of handle of entity (Components keep only Handle::index)
+         * @param index is index of entity
+         * @return handle of entity
+         */
+        Handle getHandle( uint32_t index ) const;
+        /**
+         * @brief getArchetype is getter of kind of entity
+         * @param entity is handle of living entity
+         * @return archetype
+         */
+        Archetype getArchetype( Handle entity ) const;
+        /**
+         * @brief getCount is getter of count of entities
+         * @return count
+         */
+        int getCount() const;
+        /**
+         * @brief getPosition finds component of entity
+         * @param entity is handle of entity
+         * @return component, NULL for stale handle or entity without it
+         */
+        Position *getPosition( Handle entity );
+        /**
+         * @brief getStats finds component of entity
+         * @param entity is handle of entity
+         * @param stats is output
+         * @return false for stale handle or entity without it
+         */
+        bool getStats( Handle entity, Stats &stats ) const;
+        /**
+         * @brief getGlyph finds component of entity
+         * @param entity is handle of entity
+         * @return component, NULL for stale handle or entity without it
+         */
+        const Glyph *getGlyph( Handle entity ) const;
+        /**
+         * @brief getLoot finds component of entity
+         * @param entity is handle of entity
+         * @return component, NULL for stale handle or entity without it
+         */
+        const Loot *getLoot( Handle entity ) const;
+        /**
+         * @brief getOrigin finds component of entity
+         * @param entity is handle of entity
+         * @return component, NULL for stale handle or entity without it
+         */
+        const Origin *getOrigin( Handle entity ) const;
+        /**
+         * @brief getPositions is getter of all components of type (for systems)
+         * @return components
+         */
+        Components<Position> &getPositions();
+        /**
+         * @brief getStats is getter of all components of type (for systems)
+         * @return components
+         */
+        StatsComponents &getStats();
+        /**
+         * @brief getGlyphs is getter of all components of type (for systems)
+         * @return components
+         */
+        Components<Glyph> &getGlyphs();
+        /**
+         * @brief getMemory is getter of memory used by entities and components
+         * @return size in bytes
+         */
+        size_t getMemory() const;
+    private:
+        HandlePool<Archetype> entities;
+        Components<Position> positions;
+        StatsComponents stats;
+        Components<Glyph> glyphs;
+        Components<Loot> loots;
+        Components<Origin> origins;
+};
+/**********************************************************************************************/
+/**
+ * @brief The CombatResult struct is result of one fight
+ */
+struct CombatResult{
+    int heroHealth;
+    int enemyHealth;
+    int rounds;
+};
+/**
+ * @brief The CombatSystem class
+ * @detailed    Fight works only on Stats components, so hero (Entity) and enemies of World fight
+ *              the same way. Stats aren't changed, caller writes result (with history).
+ */
+class CombatSystem{
+    public:
+        /**
+         * @brief fight takes rounds until hero or enemy has no health, every round enemy hits
+         *          first by damage + random - defence, hit below zero is MIN_DAMAGE
+         * @param hero are stats of hero
+         * @param enemy are stats of enemy
+         * @param random is random generator of game session
+         * @return health of both after fight and count of rounds
+         */
+        static CombatResult fight( const Stats &hero, const Stats &enemy, Random &random );
+        /**
+         * @brief enemyHit is one hit of enemy as in round of fight (real-time mode, enemy attacks)
+         * @param hero are stats of hero
+         * @param enemy are stats of enemy
+         * @param random is random generator of game session
+         * @return damage taken by hero
+         */
+        static int enemyHit( const Stats &hero, const Stats &enemy, Random &random );
+};
+/**********************************************************************************************/
+/**
+ * @brief The CombatBatch class is fights which go at once (real-time mode)
+ * @detailed    Every fight is hero (or ally) against enemy, one tick is one round of all running
+ *              fights with the same rules as CombatSystem::fight. Stats are columns and count of
+ *              places is rounded up to C_COMBAT_LANES, block of lanes is one loop without branches,
+ *              so compiler makes vector instructions of it (4 fights in one instruction with SSE2,
+ *              8 or 16 with NATIVE=1 on AVX2 or AVX-512). Random part of hits is drawn before
+ *              tick by roll, generator of session is sequential.
+ */
+class CombatBatch{
+    public:
+        /**
+         * @brief CombatBatch is implicit constructor
+         */
+        CombatBatch();
+        /**
+         * @brief add starts new fight
+         * @param hero are stats of hero
+         * @param enemy are stats of enemy
+         * @return number of fight
+         */
+        int add( const Stats &hero, const Stats &enemy );
+        /**
+         * @brief roll draws random part of hits of all running fights for next tick
+         * @param random is random generator of game session
+         */
+        void roll( Random &random );
+        /**
+         * @brief tick takes one round of all running fights, vectorized
+         * @return count of fights still running
+         */
+        int tick();
+        /**
+         * @brief tickScalar takes one round of all running fights one by one (reference of tick)
+         * @return count of fights still running
+         */
+        int tickScalar();
+        /**
+         * @brief getCount is getter of count of fights
+         * @return count
+         */
+        int getCount() const;
+        /**
+         * @brief getResult is getter of state of fight
+         * @param i is number of fight
+         * @return health of both and count of rounds
+         */
+        CombatResult getResult( int i ) const;
+        /**
+         * @brief clear removes all fights
+         */
+        void clear();
+        /**
+         * @brief benchmark compares tick with tickScalar on random fights and writes result
+         * @param countFights is count of fights
+         * @param seed is seed of random generator
+         * @return false if tick and tickScalar have different results
+         */
+        static bool benchmark( int countFights, int seed );
+    private:
+        int count;
+        vector<int> heroHealth, heroDamage, heroDefence;
+        vector<int> enemyHealth, enemyDamage, enemyDefence;
+        vector<int> heroRoll, enemyRoll;
+        vector<int> rounds;
+        vector<int> blockRunning;               // running fights of each block, finished blocks are skipped
+};
+/**********************************************************************************************/
+#endif // WORLD_H